@@ -0,0 +1,140 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+// Renders the test scene with 1, 2 and 3 frames in flight and reports the frame times of each configuration.
+// Usage: BaalFrameTimeBenchmark [measuredFrames] [simulatedSceneUpdateMs] [--headless]
+
+#include "Baal.h"
+#include "../src/core/vulkan/tests/TestRenderer.h"
+#include "../src/utility/DebugLog.h"
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Baal;
+
+struct BenchmarkResult
+{
+	uint32_t framesInFlight = 0;
+	double averageFrameTime = 0.0;
+	double p50FrameTime = 0.0;
+	double p99FrameTime = 0.0;
+	double averageFenceWaitTime = 0.0;
+};
+
+// Stand-in for the game's scene update, keeps the CPU busy the same way our simulation does
+static void SimulateSceneUpdate(const double milliseconds)
+{
+	const auto start = std::chrono::steady_clock::now();
+	while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < milliseconds)
+	{
+	}
+}
+
+static BenchmarkResult RunBenchmark(GLFWwindow* window, const uint32_t framesInFlight, const uint32_t warmupFrames, const uint32_t measuredFrames, const double sceneUpdateTime)
+{
+	VK::RendererSettings settings;
+	settings.framesInFlight = framesInFlight;
+	settings.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;	// Do not let v-sync hide the cost of waiting on the GPU
+
+	VK::TestRenderer renderer;
+	if (window == nullptr)
+	{
+		renderer.Startup("Frame Time Benchmark", settings);
+	}
+	else
+	{
+		renderer.Startup("Frame Time Benchmark", window, settings);
+	}
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(measuredFrames);
+	double totalFenceWaitTime = 0.0;
+
+	for (uint32_t i = 0; i < warmupFrames + measuredFrames; ++i)
+	{
+		if (window != nullptr)
+		{
+			glfwPollEvents();
+		}
+
+		const auto frameStart = std::chrono::steady_clock::now();
+
+		SimulateSceneUpdate(sceneUpdateTime);
+		renderer.Render();
+
+		const auto frameEnd = std::chrono::steady_clock::now();
+
+		if (i >= warmupFrames)
+		{
+			frameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+			totalFenceWaitTime += renderer.GetFrameStats().fenceWaitTime;
+		}
+	}
+
+	renderer.Shutdown();
+
+	BenchmarkResult result;
+	result.framesInFlight = framesInFlight;
+
+	if (!frameTimes.empty())
+	{
+		double totalFrameTime = 0.0;
+		for (const double frameTime : frameTimes)
+		{
+			totalFrameTime += frameTime;
+		}
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+		result.averageFrameTime = totalFrameTime / frameTimes.size();
+		result.p50FrameTime = frameTimes[frameTimes.size() / 2];
+		result.p99FrameTime = frameTimes[std::min(frameTimes.size() - 1, (frameTimes.size() * 99) / 100)];
+		result.averageFenceWaitTime = totalFenceWaitTime / frameTimes.size();
+	}
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	DEBUG_INIT();
+
+	const uint32_t warmupFrames = 100;
+	const uint32_t measuredFrames = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1000;
+	const double sceneUpdateTime = argc > 2 ? std::atof(argv[2]) : 2.0;
+	const bool bHeadless = argc > 3 && std::strcmp(argv[3], "--headless") == 0;
+
+	GLFWwindow* window = nullptr;
+	if (!bHeadless)
+	{
+		glfwInit();
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		window = glfwCreateWindow(1280, 720, "Baal Frame Time Benchmark", nullptr, nullptr);
+	}
+
+	std::vector<BenchmarkResult> results;
+	for (uint32_t framesInFlight = 1; framesInFlight <= 3; ++framesInFlight)
+	{
+		results.push_back(RunBenchmark(window, framesInFlight, warmupFrames, measuredFrames, sceneUpdateTime));
+	}
+
+	if (window != nullptr)
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+	}
+
+	std::printf("Frame time benchmark (%s): %u frames, %.2f ms simulated scene update per frame\n", bHeadless ? "headless" : "windowed", measuredFrames, sceneUpdateTime);
+	std::printf("%-16s %-12s %-12s %-12s %-16s %-10s\n", "FramesInFlight", "Avg (ms)", "P50 (ms)", "P99 (ms)", "FenceWait (ms)", "FPS");
+	for (const BenchmarkResult& result : results)
+	{
+		const double fps = result.averageFrameTime > 0.0 ? 1000.0 / result.averageFrameTime : 0.0;
+		std::printf("%-16u %-12.3f %-12.3f %-12.3f %-16.3f %-10.1f\n", result.framesInFlight, result.averageFrameTime, result.p50FrameTime, result.p99FrameTime, result.averageFenceWaitTime, fps);
+	}
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+// Measures the JobSystem's scheduling overhead and how a parallel-for scales with the number of threads.
+// Usage: BaalJobSystemBenchmark [jobCount] [maxThreads]
+
+#include "../src/core/jobs/JobSystem.h"
+#include "../src/utility/DebugLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Baal;
+
+// Enough arithmetic per item that the scaling run measures the scheduler and not memory bandwidth
+static float SimulateWork(const uint32_t item)
+{
+	float value = static_cast<float>(item);
+	for (uint32_t i = 0; i < 64; ++i)
+	{
+		value = std::sqrt(value * 1.0001f + 1.0f);
+	}
+	return value;
+}
+
+static double Milliseconds(const std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Empty jobs submitted from the main thread, the cost of a job is all scheduling
+static double MeasureSubmitOverhead(JobSystem& jobSystem, const uint32_t jobCount)
+{
+	std::atomic<uint32_t> ranJobs{ 0 };
+	JobCounter counter;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < jobCount; ++i)
+	{
+		jobSystem.Submit([&ranJobs]() { ranJobs.fetch_add(1, std::memory_order_relaxed); }, &counter);
+	}
+	jobSystem.Wait(counter);
+	return Milliseconds(start) * 1000000.0 / jobCount;
+}
+
+// Every job spawns the next one from a worker, so it measures the worker's own deque rather than the shared one
+static double MeasureNestedSubmitOverhead(JobSystem& jobSystem, const uint32_t jobCount)
+{
+	JobCounter counter;
+	std::function<void(uint32_t)> spawn = [&](const uint32_t remaining)
+	{
+		if (remaining > 0)
+		{
+			jobSystem.Submit([&spawn, remaining]() { spawn(remaining - 1); }, &counter);
+		}
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	spawn(jobCount);
+	jobSystem.Wait(counter);
+	return Milliseconds(start) * 1000000.0 / jobCount;
+}
+
+// A chain of jobs, each held back by the previous one's counter, measures how quickly a finished dependency releases its dependents
+static double MeasureDependencyLatency(JobSystem& jobSystem, const uint32_t chainLength)
+{
+	std::vector<std::unique_ptr<JobCounter>> counters;
+	counters.reserve(chainLength);
+	for (uint32_t i = 0; i < chainLength; ++i)
+	{
+		counters.push_back(std::make_unique<JobCounter>());
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	jobSystem.Submit([]() {}, counters[0].get());
+	for (uint32_t i = 1; i < chainLength; ++i)
+	{
+		jobSystem.SubmitAfter(*counters[i - 1].get(), []() {}, counters[i].get());
+	}
+	jobSystem.Wait(*counters[chainLength - 1].get());
+	const double latency = Milliseconds(start) * 1000000.0 / chainLength;
+
+	for (std::unique_ptr<JobCounter>& counter : counters)
+	{
+		jobSystem.Wait(*counter.get());
+	}
+	return latency;
+}
+
+static double MeasureParallelFor(JobSystem* jobSystem, const uint32_t itemCount, const uint32_t minBatchSize, const uint32_t repeats)
+{
+	std::vector<float> results(itemCount);
+	const auto work = [&results](const uint32_t begin, const uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			results[i] = SimulateWork(i);
+		}
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < repeats; ++i)
+	{
+		if (jobSystem != nullptr)
+		{
+			jobSystem->ParallelFor(itemCount, minBatchSize, work);
+		}
+		else
+		{
+			work(0, itemCount);
+		}
+	}
+	return Milliseconds(start) / repeats;
+}
+
+int main(int argc, char** argv)
+{
+	DEBUG_INIT();
+
+	const uint32_t jobCount = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 100000;
+	const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+	const uint32_t maxThreads = argc > 2 ? std::max(static_cast<uint32_t>(std::atoi(argv[2])), 2u) : hardwareThreads;
+
+	std::printf("Job system benchmark: %u jobs, up to %u threads\n\n", jobCount, maxThreads);
+
+	{
+		JobSystem jobSystem(maxThreads - 1);
+		std::printf("Scheduling overhead (%u workers)\n", jobSystem.GetWorkerCount());
+		std::printf("%-28s %-12s\n", "Test", "ns / job");
+		std::printf("%-28s %-12.1f\n", "Submit from main thread", MeasureSubmitOverhead(jobSystem, jobCount));
+		std::printf("%-28s %-12.1f\n", "Submit from a job", MeasureNestedSubmitOverhead(jobSystem, jobCount));
+		std::printf("%-28s %-12.1f\n", "Dependency chain", MeasureDependencyLatency(jobSystem, std::min(jobCount, 10000u)));
+	}
+
+	const uint32_t itemCount = 1 << 20;
+	const uint32_t repeats = 10;
+	const double serialTime = MeasureParallelFor(nullptr, itemCount, 0, repeats);
+
+	std::printf("\nParallel-for scaling, %u items\n", itemCount);
+	std::printf("%-10s %-12s %-12s %-12s %-12s\n", "Threads", "Batch", "Time (ms)", "Speedup", "Efficiency");
+	std::printf("%-10u %-12s %-12.3f %-12.2f %-12.2f\n", 1u, "-", serialTime, 1.0, 1.0);
+	for (uint32_t threadCount = 2; threadCount <= maxThreads; ++threadCount)
+	{
+		JobSystem jobSystem(threadCount - 1);
+		for (const uint32_t minBatchSize : { 64u, 4096u })
+		{
+			const double time = MeasureParallelFor(&jobSystem, itemCount, minBatchSize, repeats);
+			const double speedup = time > 0.0 ? serialTime / time : 0.0;
+			std::printf("%-10u %-12u %-12.3f %-12.2f %-12.2f\n", threadCount, minBatchSize, time, speedup, speedup / threadCount);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "Bounds.h"
+
+#include "../src/core/3d/Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Baal
+{
+	namespace VK
+	{
+		static_assert(sizeof(Matrix4f) == sizeof(float) * 16, "Matrix4f is expected to be 16 tightly packed floats");
+
+		void ToColumnMajor(const Matrix4f& matrix, float outMatrix[16])
+		{
+			std::memcpy(outMatrix, &matrix, sizeof(float) * 16);
+		}
+
+		BoundingBox BoundingBox::Transform(const float m[16]) const
+		{
+			// Arvo's method, every axis of the result is the translation plus the extreme contribution of each column
+			const float boxMin[3] = { min.x, min.y, min.z };
+			const float boxMax[3] = { max.x, max.y, max.z };
+			float outMin[3] = { m[12], m[13], m[14] };
+			float outMax[3] = { m[12], m[13], m[14] };
+
+			for (int row = 0; row < 3; ++row)
+			{
+				for (int column = 0; column < 3; ++column)
+				{
+					const float a = m[column * 4 + row] * boxMin[column];
+					const float b = m[column * 4 + row] * boxMax[column];
+					outMin[row] += std::min(a, b);
+					outMax[row] += std::max(a, b);
+				}
+			}
+
+			BoundingBox box;
+			box.min = Vector3f(outMin[0], outMin[1], outMin[2]);
+			box.max = Vector3f(outMax[0], outMax[1], outMax[2]);
+			return box;
+		}
+
+		BoundingSphere BoundingSphere::Transform(const float m[16]) const
+		{
+			BoundingSphere sphere;
+			sphere.center.x = m[0] * center.x + m[4] * center.y + m[8] * center.z + m[12];
+			sphere.center.y = m[1] * center.x + m[5] * center.y + m[9] * center.z + m[13];
+			sphere.center.z = m[2] * center.x + m[6] * center.y + m[10] * center.z + m[14];
+
+			const float scaleX = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+			const float scaleY = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+			const float scaleZ = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+			sphere.radius = radius * std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ)));
+			return sphere;
+		}
+
+		Bounds Bounds::FromVertices(const std::vector<Vertex>& vertices)
+		{
+			Bounds bounds;
+			if (vertices.empty())
+			{
+				return bounds;
+			}
+
+			float min[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+			float max[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+			for (const Vertex& v : vertices)
+			{
+				min[0] = std::min(min[0], v.pos.x); max[0] = std::max(max[0], v.pos.x);
+				min[1] = std::min(min[1], v.pos.y); max[1] = std::max(max[1], v.pos.y);
+				min[2] = std::min(min[2], v.pos.z); max[2] = std::max(max[2], v.pos.z);
+			}
+
+			bounds.box.min = Vector3f(min[0], min[1], min[2]);
+			bounds.box.max = Vector3f(max[0], max[1], max[2]);
+
+			bounds.sphere.center.x = (min[0] + max[0]) * 0.5f;
+			bounds.sphere.center.y = (min[1] + max[1]) * 0.5f;
+			bounds.sphere.center.z = (min[2] + max[2]) * 0.5f;
+
+			float radiusSquared = 0.0f;
+			for (const Vertex& v : vertices)
+			{
+				const float dx = v.pos.x - bounds.sphere.center.x;
+				const float dy = v.pos.y - bounds.sphere.center.y;
+				const float dz = v.pos.z - bounds.sphere.center.z;
+				radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+			}
+			bounds.sphere.radius = std::sqrt(radiusSquared);
+			return bounds;
+		}
+	}
+}
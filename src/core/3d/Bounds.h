@@ -0,0 +1,48 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_BOUNDS_H
+#define BAAL_VK_BOUNDS_H
+
+#include <Mjolnir.h>
+#include <vector>
+
+namespace Baal
+{
+	namespace VK
+	{
+		struct Vertex;
+
+		// Copies a Matrix4f into 16 floats, column-major like the shaders see it
+		void ToColumnMajor(const Matrix4f& matrix, float outMatrix[16]);
+
+		struct BoundingBox
+		{
+			Vector3f min;
+			Vector3f max;
+
+			// World space box enclosing this box transformed by a column-major matrix
+			BoundingBox Transform(const float matrix[16]) const;
+		};
+
+		struct BoundingSphere
+		{
+			Vector3f center;
+			float radius = 0.0f;
+
+			// The radius is scaled by the matrix's largest axis scale, so the sphere stays conservative under non-uniform scale
+			BoundingSphere Transform(const float matrix[16]) const;
+		};
+
+		// Object space bounds of a Sub Mesh, computed once at load
+		// The sphere is the cheap first test, the box is a tighter second test for whatever the sphere cannot reject
+		struct Bounds
+		{
+			BoundingBox box;
+			BoundingSphere sphere;	// Centered on the box, looser than a minimal sphere but cheap and stable
+
+			static Bounds FromVertices(const std::vector<Vertex>& vertices);
+		};
+	}
+}
+
+#endif // !BAAL_VK_BOUNDS_H
@@ -5,6 +5,9 @@
 
 #include <Mjolnir.h>
 #include <memory>
+#include <vector>
+
+#include "../src/core/3d/Frustum.h"
 
 namespace Baal
 {
@@ -51,6 +54,7 @@ namespace Baal
 			Matrix4f GetProjectionMatrix() const { return matrix.proj; }
 			CameraMatrix& GetMatrices() { return matrix; }
 			Transform GetTransform() const { return transform; }
+			Frustum GetFrustum() const { return Frustum::FromViewProjection(matrix.view, matrix.proj); }
 
 			void SetPosition(Vector3f position);
 			void SetRotation(Quatf orientation);
@@ -76,7 +80,7 @@ namespace Baal
 		struct RenderCameraResources
 		{
 			std::shared_ptr<Camera> camera;
-			std::unique_ptr<Buffer> uniformBuffer;
+			std::vector<std::unique_ptr<Buffer>> uniformBuffers;	// One per frame in flight
 		};
 	}
 }
@@ -0,0 +1,138 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "Frustum.h"
+
+#include "../src/core/3d/Bounds.h"
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define BAAL_FRUSTUM_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace Baal
+{
+	namespace VK
+	{
+		namespace
+		{
+			FrustumPlane MakePlane(const float a, const float b, const float c, const float d)
+			{
+				const float length = std::sqrt(a * a + b * b + c * c);
+				FrustumPlane plane;
+				plane.normal[0] = a / length;
+				plane.normal[1] = b / length;
+				plane.normal[2] = c / length;
+				plane.distance = d / length;
+				return plane;
+			}
+		}
+
+		Frustum Frustum::FromViewProjection(const Matrix4f& view, const Matrix4f& projection)
+		{
+			float v[16];
+			float p[16];
+			ToColumnMajor(view, v);
+			ToColumnMajor(projection, p);
+
+			// Column-major, element [column * 4 + row], matches camera.proj * camera.view in the shaders
+			float m[16];
+			for (int column = 0; column < 4; ++column)
+			{
+				for (int row = 0; row < 4; ++row)
+				{
+					m[column * 4 + row] = p[0 * 4 + row] * v[column * 4 + 0] + p[1 * 4 + row] * v[column * 4 + 1] + p[2 * 4 + row] * v[column * 4 + 2] + p[3 * 4 + row] * v[column * 4 + 3];
+				}
+			}
+
+			// Gribb-Hartmann, each plane is the sum or difference of the last row and another row of the view projection
+			auto row = [&m](const int r, const int c) { return m[c * 4 + r]; };
+
+			Frustum frustum;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				// The near plane assumes a -w to w depth range, for a 0 to w projection it is only slightly conservative
+				frustum.planes[axis * 2 + 0] = MakePlane(row(3, 0) + row(axis, 0), row(3, 1) + row(axis, 1), row(3, 2) + row(axis, 2), row(3, 3) + row(axis, 3));
+				frustum.planes[axis * 2 + 1] = MakePlane(row(3, 0) - row(axis, 0), row(3, 1) - row(axis, 1), row(3, 2) - row(axis, 2), row(3, 3) - row(axis, 3));
+			}
+			return frustum;
+		}
+
+		bool Frustum::IsSphereVisible(const float x, const float y, const float z, const float radius) const
+		{
+			for (const FrustumPlane& plane : planes)
+			{
+				if (plane.normal[0] * x + plane.normal[1] * y + plane.normal[2] * z + plane.distance < -radius)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool Frustum::IsBoxVisible(const BoundingBox& box) const
+		{
+			for (const FrustumPlane& plane : planes)
+			{
+				// Only the corner furthest along the plane normal needs testing
+				const float x = plane.normal[0] >= 0.0f ? box.max.x : box.min.x;
+				const float y = plane.normal[1] >= 0.0f ? box.max.y : box.min.y;
+				const float z = plane.normal[2] >= 0.0f ? box.max.z : box.min.z;
+				if (plane.normal[0] * x + plane.normal[1] * y + plane.normal[2] * z + plane.distance < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void Frustum::CullSpheres(const float* x, const float* y, const float* z, const float* radius, const size_t count, uint8_t* outVisible) const
+		{
+			size_t i = 0;
+
+#ifdef BAAL_FRUSTUM_SSE
+			__m128 planeX[6];
+			__m128 planeY[6];
+			__m128 planeZ[6];
+			__m128 planeD[6];
+			for (size_t p = 0; p < planes.size(); ++p)
+			{
+				planeX[p] = _mm_set1_ps(planes[p].normal[0]);
+				planeY[p] = _mm_set1_ps(planes[p].normal[1]);
+				planeZ[p] = _mm_set1_ps(planes[p].normal[2]);
+				planeD[p] = _mm_set1_ps(planes[p].distance);
+			}
+
+			const __m128 zero = _mm_setzero_ps();
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 cx = _mm_loadu_ps(x + i);
+				const __m128 cy = _mm_loadu_ps(y + i);
+				const __m128 cz = _mm_loadu_ps(z + i);
+				const __m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(radius + i));
+
+				__m128 outside = zero;
+				for (size_t p = 0; p < planes.size(); ++p)
+				{
+					__m128 distance = _mm_add_ps(_mm_mul_ps(planeX[p], cx), planeD[p]);
+					distance = _mm_add_ps(distance, _mm_mul_ps(planeY[p], cy));
+					distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[p], cz));
+					outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+				}
+
+				const int outsideMask = _mm_movemask_ps(outside);
+				outVisible[i + 0] = (outsideMask & 0x1) == 0;
+				outVisible[i + 1] = (outsideMask & 0x2) == 0;
+				outVisible[i + 2] = (outsideMask & 0x4) == 0;
+				outVisible[i + 3] = (outsideMask & 0x8) == 0;
+			}
+#endif
+
+			for (; i < count; ++i)
+			{
+				outVisible[i] = IsSphereVisible(x[i], y[i], z[i], radius[i]) ? 1 : 0;
+			}
+		}
+	}
+}
@@ -0,0 +1,45 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_FRUSTUM_H
+#define BAAL_VK_FRUSTUM_H
+
+#include <Mjolnir.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Baal
+{
+	namespace VK
+	{
+		struct BoundingBox;
+
+		// Points with dot(normal, p) + distance >= 0 are inside
+		struct FrustumPlane
+		{
+			float normal[3] = { 0.0f, 0.0f, 0.0f };
+			float distance = 0.0f;
+		};
+
+		// World space view frustum, the same planes Cull.comp extracts on the GPU
+		class Frustum
+		{
+		public:
+			Frustum() = default;
+
+			static Frustum FromViewProjection(const Matrix4f& view, const Matrix4f& projection);
+
+			bool IsSphereVisible(const float x, const float y, const float z, const float radius) const;
+			bool IsBoxVisible(const BoundingBox& box) const;
+
+			// Tests count spheres stored as separate x, y, z and radius arrays, four at a time with SSE when available
+			// Writes 1 to outVisible for every sphere that intersects the frustum, 0 otherwise
+			void CullSpheres(const float* x, const float* y, const float* z, const float* radius, const size_t count, uint8_t* outVisible) const;
+
+		private:
+			std::array<FrustumPlane, 6> planes;
+		};
+	}
+}
+
+#endif // !BAAL_VK_FRUSTUM_H
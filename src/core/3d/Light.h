@@ -4,6 +4,7 @@
 #define BAAL_VK_LIGHT_H
 
 #include <Mjolnir.h>
+#include <array>
 
 #ifndef BAAL_MAX_LIGHTS
 #define BAAL_MAX_LIGHTS 8
@@ -13,8 +14,6 @@ namespace Baal
 {
 	namespace VK
 	{
-		class Buffer;
-		
 		struct DirectionalLight
 		{
 			alignas(16) Color color = Color(255, 255, 255);
@@ -44,14 +43,12 @@ namespace Baal
 		struct LightSource
 		{
 			T light;
-			std::unique_ptr<Buffer> buffer = nullptr;
 		};
 
 		template<typename T>
 		struct LightSourceArray
 		{
 			std::array<T, BAAL_MAX_LIGHTS> lights;
-			std::unique_ptr<Buffer> buffer = nullptr;
 		};
 	}
 }
@@ -2,167 +2,358 @@
 
 #include "Mesh.h"
 
+#include "../src/core/3d/MeshFile.h"
 #include "../src/utility/DebugLog.h"
 #include "../src/core/vulkan/resource/Allocator.h"
 #include "../src/core/vulkan/resource/Buffer.h"
+#include "../src/core/vulkan/resource/Uploader.h"
+#include "../src/core/vulkan/resource/GeometryPool.h"
 #include "../src/core/vulkan/devices/LogicalDevice.h"
 #include "../src/core/vulkan/descriptors/DescriptorSet.h"
 #include "../src/core/vulkan/descriptors/DescriptorPool.h"
 #include "../src/core/vulkan/descriptors/DescriptorSetLayout.h"
+#include "../src/core/jobs/JobSystem.h"
 
 #include <string>
+#include <functional>
+#include <limits>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
 #include <tiny_obj_loader.h>
 
 namespace Baal
 {
 	namespace VK
 	{
-		Mesh::Mesh(const char* parentDirectory, const char* meshFileName)
+		namespace
 		{
-			std::string meshFilePath = std::string(parentDirectory) + std::string(meshFileName);
+			void HashCombine(size_t& seed, const float value)
+			{
+				seed ^= std::hash<float>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+			}
 
-			tinyobj::attrib_t attrib;
-			std::vector<tinyobj::shape_t> shapes;
-			std::vector<tinyobj::material_t> materials;
+			struct VertexHasher
+			{
+				size_t operator()(const Vertex& v) const
+				{
+					size_t seed = 0;
+					HashCombine(seed, v.pos.x);
+					HashCombine(seed, v.pos.y);
+					HashCombine(seed, v.pos.z);
+					HashCombine(seed, v.norm.x);
+					HashCombine(seed, v.norm.y);
+					HashCombine(seed, v.norm.z);
+					HashCombine(seed, v.texCoords.x);
+					HashCombine(seed, v.texCoords.y);
+					HashCombine(seed, v.color.x);
+					HashCombine(seed, v.color.y);
+					HashCombine(seed, v.color.z);
+					return seed;
+				}
+			};
 
-			std::string warn;
-			std::string err;
+			SubMesh ImportShape(const tinyobj::attrib_t& attrib, const tinyobj::shape_t& shape, const std::vector<tinyobj::material_t>& materials)
+			{
+				SubMesh subMesh;
 
-			DEBUG_LOG(LOG::INFO, "Loading Mesh: {}...", meshFileName);
+				// Weld identical vertices so the index buffer can actually share them
+				// The welded count is unknown up front, but never more than the indices or, seams aside, the positions
+				std::unordered_map<Vertex, uint32_t, VertexHasher> uniqueVertices;
+				uniqueVertices.reserve(shape.mesh.indices.size());
+				subMesh.vertices.reserve(std::min(shape.mesh.indices.size(), attrib.vertices.size() / 3));
+				subMesh.indices.reserve(shape.mesh.indices.size());
 
-			const bool bSuccess = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, meshFilePath.c_str(), parentDirectory);
-			if (!bSuccess)
-			{
-				DEBUG_LOG(LOG::ERRORLOG, "Failed to load Mesh: {}, Error: {}", meshFileName, err);
-			}
-			else
-			{
-				for (const auto& shape : shapes)
+				for (const auto& index : shape.mesh.indices)
 				{
-					SubMesh subMesh;
-					for (const auto& index : shape.mesh.indices)
+					Vertex v{};
+					v.pos.x = attrib.vertices[3 * index.vertex_index + 0];
+					v.pos.y = attrib.vertices[3 * index.vertex_index + 1];
+					v.pos.z = attrib.vertices[3 * index.vertex_index + 2];
+
+					if (!attrib.normals.empty())
 					{
-						Vertex v;
-						v.pos.x = attrib.vertices[3 * index.vertex_index + 0];
-						v.pos.y = attrib.vertices[3 * index.vertex_index + 1];
-						v.pos.z = attrib.vertices[3 * index.vertex_index + 2];
-
-						if (!attrib.normals.empty())
-						{
-							v.norm.x = attrib.normals[3 * index.normal_index + 0];
-							v.norm.y = attrib.normals[3 * index.normal_index + 1];
-							v.norm.z = attrib.normals[3 * index.normal_index + 2];
-						}
-
-						if (!attrib.texcoords.empty())
-						{
-							// The OBJ format assumes a coordinate system where a vertical coordinate of 0 means the bottom of the image.
-							// Most textures that will be used will be a top to bottom orientation where 0 means the top of the image
-							// So we flip the y-position, of the incoming text coords
-							v.texCoords.x = attrib.texcoords[2 * index.texcoord_index + 0];
-							v.texCoords.y = 1.0f - attrib.texcoords[2 * index.texcoord_index + 1];
-						}						
-
-						if (!attrib.colors.empty())
-						{
-							v.color.x = attrib.colors[3 * index.vertex_index + 0];
-							v.color.y = attrib.colors[3 * index.vertex_index + 1];
-							v.color.z = attrib.colors[3 * index.vertex_index + 2];
-						}
+						v.norm.x = attrib.normals[3 * index.normal_index + 0];
+						v.norm.y = attrib.normals[3 * index.normal_index + 1];
+						v.norm.z = attrib.normals[3 * index.normal_index + 2];
+					}
 
-						subMesh.vertices.push_back(v);
+					if (!attrib.texcoords.empty())
+					{
+						// The OBJ format assumes a coordinate system where a vertical coordinate of 0 means the bottom of the image.
+						// Most textures that will be used will be a top to bottom orientation where 0 means the top of the image
+						// So we flip the y-position, of the incoming text coords
+						v.texCoords.x = attrib.texcoords[2 * index.texcoord_index + 0];
+						v.texCoords.y = 1.0f - attrib.texcoords[2 * index.texcoord_index + 1];
+					}						
 
-						subMesh.indices.push_back(subMesh.indices.size());
+					if (!attrib.colors.empty())
+					{
+						v.color.x = attrib.colors[3 * index.vertex_index + 0];
+						v.color.y = attrib.colors[3 * index.vertex_index + 1];
+						v.color.z = attrib.colors[3 * index.vertex_index + 2];
 					}
 
-					if(!materials.empty())
+					auto it = uniqueVertices.find(v);
+					if (it == uniqueVertices.end())
 					{
-						// If we ever find ourself with material id entry is -1, we will just use the first index in the material array
-						const bool bMaterialIdsAvailable = !shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] != -1;
-						int index = bMaterialIdsAvailable ? shape.mesh.material_ids[0] : 0;
+						it = uniqueVertices.emplace(v, static_cast<uint32_t>(subMesh.vertices.size())).first;
+						subMesh.vertices.push_back(v);
+					}
 
-						Material mat;
-						mat.ambient.x = materials[index].ambient[0];
-						mat.ambient.y = materials[index].ambient[1];
-						mat.ambient.z = materials[index].ambient[2];
+					subMesh.indices.push_back(it->second);
+				}
 
-						mat.diffuse.x = materials[index].diffuse[0];
-						mat.diffuse.y = materials[index].diffuse[1];
-						mat.diffuse.z = materials[index].diffuse[2];
+				subMesh.indexType = subMesh.vertices.size() <= std::numeric_limits<uint16_t>::max() ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+				subMesh.bounds = Bounds::FromVertices(subMesh.vertices);
 
-						mat.specular.x = materials[index].specular[0];
-						mat.specular.y = materials[index].specular[1];
-						mat.specular.z = materials[index].specular[2];
+				if(!materials.empty())
+				{
+					// If we ever find ourself with material id entry is -1, we will just use the first index in the material array
+					const bool bMaterialIdsAvailable = !shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] != -1;
+					int index = bMaterialIdsAvailable ? shape.mesh.material_ids[0] : 0;
 
-						mat.shininess = materials[index].shininess;
+					Material mat;
+					mat.ambient.x = materials[index].ambient[0];
+					mat.ambient.y = materials[index].ambient[1];
+					mat.ambient.z = materials[index].ambient[2];
 
-						subMesh.material = mat;
-					}
+					mat.diffuse.x = materials[index].diffuse[0];
+					mat.diffuse.y = materials[index].diffuse[1];
+					mat.diffuse.z = materials[index].diffuse[2];
 
-					subMeshes.push_back(subMesh);
-				}
+					mat.specular.x = materials[index].specular[0];
+					mat.specular.y = materials[index].specular[1];
+					mat.specular.z = materials[index].specular[2];
 
-				if (!warn.empty())
-				{
-					DEBUG_LOG(LOG::WARNING, "Succesfully loaded Mesh: {}, Warning: {}", meshFileName, warn);
+					mat.shininess = materials[index].shininess;
+
+					subMesh.material = mat;
 				}
-				else
+
+				return subMesh;
+			}
+
+			Material ToMaterial(const MeshFileMaterial& fileMaterial)
+			{
+				Material mat;
+				mat.ambient.x = fileMaterial.ambient[0];
+				mat.ambient.y = fileMaterial.ambient[1];
+				mat.ambient.z = fileMaterial.ambient[2];
+				mat.ambient.w = fileMaterial.ambient[3];
+				mat.diffuse.x = fileMaterial.diffuse[0];
+				mat.diffuse.y = fileMaterial.diffuse[1];
+				mat.diffuse.z = fileMaterial.diffuse[2];
+				mat.specular.x = fileMaterial.specular[0];
+				mat.specular.y = fileMaterial.specular[1];
+				mat.specular.z = fileMaterial.specular[2];
+				mat.shininess = fileMaterial.shininess;
+				return mat;
+			}
+
+			void UploadFromMeshFile(GeometryPool& geometryPool, const MeshFile& meshFile, std::vector<SubMesh>& outSubMeshes, UploadTicket& outUploadTicket)
+			{
+				outSubMeshes.resize(meshFile.GetSubMeshCount());
+				for (uint32_t i = 0; i < meshFile.GetSubMeshCount(); ++i)
 				{
-					DEBUG_LOG(LOG::INFO, "Succesfully loaded Mesh: {}", meshFileName);
+					const MeshFileSubMesh& fileSubMesh = meshFile.GetSubMesh(i);
+					SubMesh& subMesh = outSubMeshes[i];
+					subMesh.indexType = static_cast<VkIndexType>(fileSubMesh.indexType);
+					subMesh.bounds.box.min = Vector3f(fileSubMesh.boxMin[0], fileSubMesh.boxMin[1], fileSubMesh.boxMin[2]);
+					subMesh.bounds.box.max = Vector3f(fileSubMesh.boxMax[0], fileSubMesh.boxMax[1], fileSubMesh.boxMax[2]);
+					subMesh.bounds.sphere.center = Vector3f(fileSubMesh.sphereCenter[0], fileSubMesh.sphereCenter[1], fileSubMesh.sphereCenter[2]);
+					subMesh.bounds.sphere.radius = fileSubMesh.sphereRadius;
+
+					if (fileSubMesh.indexCount == 0)
+					{
+						continue;
+					}
+
+					subMesh.material = ToMaterial(meshFile.GetMaterial(fileSubMesh.material));
+
+					// Staged straight from the mapping, the only copy the geometry ever makes on the CPU
+					outUploadTicket = geometryPool.Allocate(meshFile.GetVertices(fileSubMesh), fileSubMesh.vertexCount, meshFile.GetIndices(fileSubMesh), fileSubMesh.indexCount, subMesh.indexType, subMesh.geometry);
+					subMesh.vertexBuffer = geometryPool.GetVertexBuffer();
+					subMesh.indexBuffer = geometryPool.GetIndexBuffer(subMesh.indexType);
 				}
 			}
 		}
 
-		Mesh::~Mesh()
+		bool Vertex::operator==(const Vertex& other) const
 		{
-			subMeshes.clear();
+			return pos.x == other.pos.x && pos.y == other.pos.y && pos.z == other.pos.z &&
+				norm.x == other.norm.x && norm.y == other.norm.y && norm.z == other.norm.z &&
+				texCoords.x == other.texCoords.x && texCoords.y == other.texCoords.y &&
+				color.x == other.color.x && color.y == other.color.y && color.z == other.color.z;
 		}
 
+		bool Material::operator==(const Material& other) const
+		{
+			return ambient.x == other.ambient.x && ambient.y == other.ambient.y && ambient.z == other.ambient.z && ambient.w == other.ambient.w &&
+				diffuse.x == other.diffuse.x && diffuse.y == other.diffuse.y && diffuse.z == other.diffuse.z &&
+				specular.x == other.specular.x && specular.y == other.specular.y && specular.z == other.specular.z &&
+				shininess == other.shininess;
+		}
 
-		SubMeshInstance::SubMeshInstance(const uint32_t _id, const uint32_t _parentId)
+		Mesh::Mesh()
 		{
-			id = _id;
-			parentId = _parentId;
-			vertexBuffer = nullptr;
-			indexBuffer = nullptr;
-			indexCount = 0;
 		}
 
-		SubMeshInstance::~SubMeshInstance()
+		bool Mesh::Load(JobSystem& jobSystem, const char* parentDirectory, const char* meshFileName)
 		{
-			vertexBuffer.reset();
-			indexBuffer.reset();
+			const std::string meshFilePath = std::string(parentDirectory) + std::string(meshFileName);
+			const MeshSourceKey key = MeshSourceKey::Create(meshFilePath);
+			const std::string meshCachePath = (std::filesystem::path(BAAL_MESH_CACHE_DIR) / key.GetFileName()).string();
+
+			DEBUG_LOG(LOG::INFO, "Loading Mesh: {}...", meshFileName);
+
+			meshFile = std::make_unique<MeshFile>(meshCachePath, key);
+			if (meshFile->IsValid())
+			{
+				// Fault the mapping in here, so the upload on the render thread never waits on the disk
+				meshFile->Prefetch();
+				DEBUG_LOG(LOG::INFO, "Succesfully loaded Mesh: {} from mesh file: {}", meshFileName, meshCachePath);
+				return true;
+			}
+			meshFile.reset();
+
+			if (!ImportObj(jobSystem, parentDirectory, meshFileName))
+			{
+				return false;
+			}
+
+			MeshFile::Write(meshCachePath, key, subMeshes);
+			return true;
 		}
 
-		MeshInstance::MeshInstance(LogicalDevice& device, Mesh& resource, const uint32_t _id)
+		bool Mesh::ImportObj(JobSystem& jobSystem, const char* parentDirectory, const char* meshFileName)
 		{
-			id = _id;
-			for (size_t i = 0; i < resource.subMeshes.size(); ++i)
+			std::string meshFilePath = std::string(parentDirectory) + std::string(meshFileName);
+
+			tinyobj::attrib_t attrib;
+			std::vector<tinyobj::shape_t> shapes;
+			std::vector<tinyobj::material_t> materials;
+
+			std::string warn;
+			std::string err;
+
+			DEBUG_LOG(LOG::INFO, "Importing Mesh: {}...", meshFileName);
+
+			const bool bSuccess = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, meshFilePath.c_str(), parentDirectory);
+			if (!bSuccess)
 			{
-				std::shared_ptr<SubMeshInstance> subMesh = std::make_shared<SubMeshInstance>(static_cast<uint32_t>(i), id);
+				DEBUG_LOG(LOG::ERRORLOG, "Failed to load Mesh: {}, Error: {}", meshFileName, err);
+				return false;
+			}
 
-				// Staging vertex data from CPU to GPU memory
-				const VkDeviceSize vertexBufferSize = sizeof(resource.subMeshes[i].vertices[0]) * resource.subMeshes[i].vertices.size();
-				Buffer vertexStagingBuffer = Buffer::CreateStagingBuffer(device.GetAllocator(), vertexBufferSize, resource.subMeshes[i].vertices.data());
-				subMesh->vertexBuffer = std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBufferSize);
-				device.CopyBuffer(vertexStagingBuffer, *subMesh->vertexBuffer.get(), vertexBufferSize);
+			// Shapes are welded independently, one job each
+			subMeshes.resize(shapes.size());
+			jobSystem.ParallelFor(static_cast<uint32_t>(shapes.size()), 1, [&](const uint32_t begin, const uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					subMeshes[i] = ImportShape(attrib, shapes[i], materials);
+				}
+			});
 
-				// Staging index data from CPU to GPU memory
-				const VkDeviceSize indexBufferSize = sizeof(resource.subMeshes[i].indices[0]) * resource.subMeshes[i].indices.size();
-				Buffer indexStagingBuffer = Buffer::CreateStagingBuffer(device.GetAllocator(), indexBufferSize, resource.subMeshes[i].indices.data());
-				subMesh->indexBuffer = std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBufferSize);
-				device.CopyBuffer(indexStagingBuffer, *subMesh->indexBuffer.get(), indexBufferSize);
+			size_t objVertexCount = 0;
+			size_t weldedVertexCount = 0;
+			for (const SubMesh& subMesh : subMeshes)
+			{
+				objVertexCount += subMesh.indices.size();
+				weldedVertexCount += subMesh.vertices.size();
+			}
 
-				subMesh->indexCount = static_cast<const uint32_t>(resource.subMeshes[i].indices.size());
-				subMesh->material = resource.subMeshes[i].material;
+			DEBUG_LOG(LOG::INFO, "Welded Mesh: {}, {} vertices down to {} unique vertices", meshFileName, objVertexCount, weldedVertexCount);
 
-				subMeshes.push_back(subMesh);					
+			if (!warn.empty())
+			{
+				DEBUG_LOG(LOG::WARNING, "Succesfully imported Mesh: {}, Warning: {}", meshFileName, warn);
+			}
+			else
+			{
+				DEBUG_LOG(LOG::INFO, "Succesfully imported Mesh: {}", meshFileName);
+			}
+			return true;
+		}
+
+		Mesh::~Mesh()
+		{
+			subMeshes.clear();
+			meshFile.reset();
+		}
+
+		void Mesh::UploadToDevice(GeometryPool& geometryPool)
+		{
+			if (meshFile != nullptr)
+			{
+				UploadFromMeshFile(geometryPool, *meshFile.get(), subMeshes, uploadTicket);
+				meshFile.reset();
+				return;
+			}
+
+			for (size_t i = 0; i < subMeshes.size(); ++i)
+			{
+				if (subMeshes[i].indices.empty())
+				{
+					continue;
+				}
+
+				// Staged into the shared pool buffers, batched with every other pending upload
+				// Indices are narrowed to 16-bit when every index fits
+				uploadTicket = geometryPool.Allocate(subMeshes[i].vertices.data(), static_cast<uint32_t>(subMeshes[i].vertices.size()), subMeshes[i].indices, subMeshes[i].indexType, subMeshes[i].geometry);
+				subMeshes[i].vertexBuffer = geometryPool.GetVertexBuffer();
+				subMeshes[i].indexBuffer = geometryPool.GetIndexBuffer(subMeshes[i].indexType);
+
+				// The staged copy is all the GPU needs, and the mesh file is what later loads read
+				subMeshes[i].vertices = std::vector<Vertex>();
+				subMeshes[i].indices = std::vector<uint32_t>();
 			}
 		}
 
-		MeshInstance::~MeshInstance()
+		void Mesh::CreateBox(const float halfExtent)
 		{
+			// One quad per face, so every face keeps its own flat normal
+			constexpr float faces[6][4][3] = {
+				{ { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 }, { 1, -1, 1 } },
+				{ { -1, -1, 1 }, { -1, 1, 1 }, { -1, 1, -1 }, { -1, -1, -1 } },
+				{ { -1, 1, -1 }, { -1, 1, 1 }, { 1, 1, 1 }, { 1, 1, -1 } },
+				{ { -1, -1, 1 }, { -1, -1, -1 }, { 1, -1, -1 }, { 1, -1, 1 } },
+				{ { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 }, { -1, -1, 1 } },
+				{ { -1, -1, -1 }, { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 } }
+			};
+			constexpr float normals[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+			constexpr float texCoords[4][2] = { { 0, 1 }, { 0, 0 }, { 1, 0 }, { 1, 1 } };
+
+			SubMesh subMesh;
+			subMesh.vertices.reserve(24);
+			subMesh.indices.reserve(36);
+			for (uint32_t face = 0; face < 6; ++face)
+			{
+				const uint32_t first = static_cast<uint32_t>(subMesh.vertices.size());
+				for (uint32_t corner = 0; corner < 4; ++corner)
+				{
+					Vertex v{};
+					v.pos = Vector3f(faces[face][corner][0], faces[face][corner][1], faces[face][corner][2]) * halfExtent;
+					v.norm = Vector3f(normals[face][0], normals[face][1], normals[face][2]);
+					v.texCoords.x = texCoords[corner][0];
+					v.texCoords.y = texCoords[corner][1];
+					v.color = Vector3f(1.0f, 1.0f, 1.0f);
+					subMesh.vertices.push_back(v);
+				}
+
+				const uint32_t quad[6] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+				subMesh.indices.insert(subMesh.indices.end(), quad, quad + 6);
+			}
+
+			subMesh.indexType = VK_INDEX_TYPE_UINT16;
+			subMesh.bounds = Bounds::FromVertices(subMesh.vertices);
+			subMesh.material.ambient = Vector4f(0.2f, 0.2f, 0.2f, 1.0f);
+			subMesh.material.diffuse = Vector3f(0.8f, 0.8f, 0.8f);
+
 			subMeshes.clear();
+			subMeshes.push_back(std::move(subMesh));
+			meshFile.reset();
 		}
 	}
-}
\ No newline at end of file
+}
@@ -6,9 +6,17 @@
 #include <vector>
 #include <memory>
 #include <Mjolnir.h>
+#include <vulkan/vulkan_core.h>
+
+#include "../src/core/vulkan/resource/Uploader.h"
+#include "../src/core/vulkan/resource/GeometryPool.h"
+#include "../src/core/3d/Bounds.h"
+#include "../src/utility/SlotMap.h"
 
 namespace Baal
 {
+	class JobSystem;
+
 	namespace VK
 	{
 		class Buffer;
@@ -16,6 +24,14 @@ namespace Baal
 		class LogicalDevice;
 		class DescriptorPool;
 		class DescriptorSetLayout;
+		class Mesh;
+		class MeshFile;
+		struct MeshInstance;
+		struct SubMeshInstance;
+
+		using MeshHandle = Handle<Mesh>;
+		using MeshInstanceHandle = Handle<MeshInstance>;
+		using SubMeshHandle = Handle<SubMeshInstance>;
 
 		struct Vertex
 		{
@@ -23,6 +39,8 @@ namespace Baal
 			Vector3f norm;
 			Vector2f texCoords;
 			Vector3f color;
+
+			bool operator==(const Vertex& other) const;
 		};
 
 		struct Material
@@ -31,16 +49,27 @@ namespace Baal
 			Vector3f diffuse;
 			alignas(16) Vector3f specular;
 			float shininess = 0.0f;
+
+			bool operator==(const Material& other) const;
 		};
 
 		struct SubMesh
 		{
-			std::vector<Vertex> vertices;
-			std::vector<int> indices;
+			std::vector<Vertex> vertices;	// Unique vertices, welded at import, released once uploaded
+			std::vector<uint32_t> indices;	// Released once uploaded
 			Material material;
+			uint32_t materialIndex = 0;	// Into the BindlessTable's materials, when the renderer has one
+			VkIndexType indexType = VK_INDEX_TYPE_UINT32;	// 16-bit when every index fits, see Mesh::UploadToDevice()
+			Bounds bounds;
+
+			// GPU geometry, uploaded once per Mesh into the shared GeometryPool buffers
+			GeometryAllocation geometry;
+			std::shared_ptr<Buffer> vertexBuffer;
+			std::shared_ptr<Buffer> indexBuffer;
 		};
 
-		struct VertexPushConstants
+		// Per instance vertex data, read through the instance rate binding of an instanced GraphicsPipeline
+		struct InstanceData
 		{
 			Matrix4f model;
 		};
@@ -50,14 +79,30 @@ namespace Baal
 			Material material;
 		};
 
+		enum class MeshState : uint8_t
+		{
+			LOADING = 0,	// Being read or imported, possibly on a worker thread
+			UPLOADING,		// Staged through the Uploader, drawable once its upload ticket completes
+			RESIDENT,
+			FAILED
+		};
+
 		// Mesh is made up of multiple Sub Meshes / Shapes
 		// SubMeshes can be used to assign different materiels, animations, textures, etc.
+		// The Mesh's geometry lives in the GeometryPool, instances only reference it
+		// An OBJ is imported once and cached as a MeshFile, later loads map that file and upload straight from it
 		class Mesh
 		{
-			friend class MeshInstance;
+			friend class MeshHandler;
 			std::vector<SubMesh> subMeshes;
+			std::unique_ptr<MeshFile> meshFile;	// Mapped between Load() and UploadToDevice() when the mesh file was up to date
+			UploadTicket uploadTicket = 0;	// Geometry can be drawn once this ticket completes
+			MeshState state = MeshState::LOADING;	// Only changed on the render thread, see MeshHandler
+
+			bool ImportObj(JobSystem& jobSystem, const char* parentDirectory, const char* meshFileName);
+
 		public:
-			explicit Mesh(const char* parentDirectory, const char* meshFileName);
+			Mesh();
 			Mesh(const Mesh&) = delete;
 			Mesh(Mesh&&) = delete;
 
@@ -65,56 +110,43 @@ namespace Baal
 
 			Mesh& operator=(const Mesh&) = delete;
 			Mesh& operator = (Mesh&&) = delete;
-		};
-
-		class SubMeshInstance
-		{
-			friend class MeshHandler;
-			friend class MeshInstance;
 
-			uint32_t id;
-			uint32_t parentId;
-			std::unique_ptr<Buffer> vertexBuffer;
-			std::unique_ptr<Buffer> indexBuffer;
-			uint32_t indexCount;
-			Material material;
+			// CPU only, safe to call on a worker thread. Maps the cached mesh file, or imports the OBJ and writes the mesh file
+			// Shapes of an imported OBJ are welded as jobs
+			bool Load(JobSystem& jobSystem, const char* parentDirectory, const char* meshFileName);
 
-		public:
-			explicit SubMeshInstance(const uint32_t _id, const uint32_t _parentId);
-			SubMeshInstance(const SubMeshInstance&) = delete;
-			SubMeshInstance(SubMeshInstance&&) noexcept = delete;
+			// Render thread only, stages whatever Load() produced through the Uploader and releases the CPU copy
+			void UploadToDevice(GeometryPool& geometryPool);
 
-			~SubMeshInstance();
+			// Axis aligned box centered on the origin, drawn in place of meshes that are still loading
+			void CreateBox(const float halfExtent);
 
-			SubMeshInstance& operator=(const SubMeshInstance&) = delete;
-			SubMeshInstance& operator = (SubMeshInstance&&) = delete;
-
-			Buffer& GetVertexBuffer() { return *vertexBuffer.get(); }
-			Buffer& GetIndexBuffer() { return *indexBuffer.get(); }
-			uint32_t GetIndexCount() const { return indexCount; }
-			uint32_t GetId() const { return id; }
-			uint32_t GetParentId() const { return parentId; }
-			Material& GetMaterial() { return material; }
+			MeshState GetState() const { return state; }
 		};
 
-		class MeshInstance
+		// One draw, a Sub Mesh of a Mesh Instance as the renderer sees it
+		// Plain data, stored densely in the MeshHandler's render list and written once when its Mesh Instance is created
+		// The geometry lives in the shared GeometryPool buffers, so nothing here needs to keep a buffer alive
+		struct SubMeshInstance
 		{
-			friend class MeshHandler;
-
-			uint32_t id;
-			std::vector<std::shared_ptr<SubMeshInstance>> subMeshes;
-
-		public:
-			explicit MeshInstance(LogicalDevice& device, Mesh& resource, const uint32_t _id);
-			MeshInstance(const MeshInstance&) = delete;
-			MeshInstance(MeshInstance&&) noexcept = delete;
-
-			~MeshInstance();
-
-			MeshInstance& operator=(const MeshInstance&) = delete;
-			MeshInstance& operator = (MeshInstance&&) = delete;
+			MeshInstanceHandle parent;
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+			int32_t vertexOffset = 0;
+			VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+			UploadTicket uploadTicket = 0;
+			Bounds bounds;	// Object space
+			Material material;	// Per instance override, defaults to the resource Sub Mesh material
+			uint32_t materialIndex = 0;	// Into the BindlessTable's materials, when the renderer has one
+		};
 
+		// A placed copy of a Mesh, stored densely in the MeshHandler and referred to by a MeshInstanceHandle
+		struct MeshInstance
+		{
 			Matrix4f model;
+			MeshHandle mesh;
+			std::vector<SubMeshHandle> subMeshes;	// Entries in the MeshHandler's render list
+			bool bPlaceholder = false;	// subMeshes are the placeholder mesh's, until mesh is resident
 		};
 	}	
 }
@@ -0,0 +1,297 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "MeshFile.h"
+
+#include "../src/core/3d/Mesh.h"
+#include "../src/utility/DebugLog.h"
+#include "../src/utility/Hash.h"
+#include "../src/utility/MappedFile.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
+namespace Baal
+{
+	namespace VK
+	{
+		namespace
+		{
+			constexpr uint32_t MESH_FILE_MAGIC = 0x4853454D;	// "MESH"
+			constexpr uint64_t MESH_FILE_SECTION_ALIGNMENT = 16;
+
+			uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+			{
+				return (value + alignment - 1) & ~(alignment - 1);
+			}
+
+			void WritePadding(std::ofstream& file, const uint64_t offset, const uint64_t alignedOffset)
+			{
+				static const char zeros[MESH_FILE_SECTION_ALIGNMENT] = {};
+				file.write(zeros, static_cast<std::streamsize>(alignedOffset - offset));
+			}
+
+			int64_t GetWriteTime(const std::filesystem::path& path)
+			{
+				std::error_code error;
+				const auto time = std::filesystem::last_write_time(path, error);
+				return error ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+			}
+
+			MeshFileMaterial ToMeshFileMaterial(const Material& material)
+			{
+				MeshFileMaterial out{};
+				out.ambient[0] = material.ambient.x;
+				out.ambient[1] = material.ambient.y;
+				out.ambient[2] = material.ambient.z;
+				out.ambient[3] = material.ambient.w;
+				out.diffuse[0] = material.diffuse.x;
+				out.diffuse[1] = material.diffuse.y;
+				out.diffuse[2] = material.diffuse.z;
+				out.specular[0] = material.specular.x;
+				out.specular[1] = material.specular.y;
+				out.specular[2] = material.specular.z;
+				out.shininess = material.shininess;
+				return out;
+			}
+
+			bool IsSameMaterial(const MeshFileMaterial& a, const MeshFileMaterial& b)
+			{
+				return std::equal(std::begin(a.ambient), std::end(a.ambient), std::begin(b.ambient)) &&
+					std::equal(std::begin(a.diffuse), std::end(a.diffuse), std::begin(b.diffuse)) &&
+					std::equal(std::begin(a.specular), std::end(a.specular), std::begin(b.specular)) &&
+					a.shininess == b.shininess;
+			}
+
+			uint64_t GetIndexSize(const SubMesh& subMesh)
+			{
+				return subMesh.indices.size() * (subMesh.indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+			}
+		}
+
+		MeshSourceKey MeshSourceKey::Create(const std::string& sourcePath)
+		{
+			MeshSourceKey key;
+			key.sourcePath = sourcePath;
+
+			std::error_code error;
+			key.sourceSize = std::filesystem::file_size(sourcePath, error);
+			key.sourceTime = GetWriteTime(sourcePath);
+
+			// tinyobj resolves mtllib relative to the OBJ, an edited MTL file must invalidate the mesh file too
+			const std::filesystem::path directory = std::filesystem::path(sourcePath).parent_path();
+			for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+			{
+				if (entry.path().extension() == ".mtl")
+				{
+					key.sourceTime = std::max(key.sourceTime, GetWriteTime(entry.path()));
+				}
+			}
+			return key;
+		}
+
+		std::string MeshSourceKey::GetFileName() const
+		{
+			return std::format("{:016x}.mesh", HashFNV1a(sourcePath));
+		}
+
+		MeshFile::MeshFile(const std::string& filePath, const MeshSourceKey& key)
+		{
+			file = std::make_unique<MappedFile>(filePath);
+			if (!file->IsValid())
+			{
+				return;
+			}
+
+			const uint8_t* data = file->GetData();
+			const uint64_t size = file->GetSize();
+
+			if (size < sizeof(MeshFileHeader))
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring truncated mesh file: {}", filePath);
+				return;
+			}
+
+			const MeshFileHeader* fileHeader = reinterpret_cast<const MeshFileHeader*>(data);
+			if (fileHeader->magic != MESH_FILE_MAGIC || fileHeader->version != BAAL_MESH_FILE_VERSION || fileHeader->vertexStride != sizeof(Vertex))
+			{
+				DEBUG_LOG(LOG::INFO, "Mesh file was written by a different version: {}", filePath);
+				return;
+			}
+
+			if (sizeof(MeshFileHeader) + fileHeader->sourcePathLength > size ||
+				std::string_view(reinterpret_cast<const char*>(data + sizeof(MeshFileHeader)), fileHeader->sourcePathLength) != key.sourcePath)
+			{
+				return;	// Collision on the file name, the file belongs to a different mesh
+			}
+
+			if (fileHeader->sourceSize != key.sourceSize || fileHeader->sourceTime != key.sourceTime)
+			{
+				DEBUG_LOG(LOG::INFO, "Mesh file is out of date: {}", filePath);
+				return;
+			}
+
+			if (fileHeader->subMeshOffset + fileHeader->subMeshCount * sizeof(MeshFileSubMesh) > size ||
+				fileHeader->materialOffset + fileHeader->materialCount * sizeof(MeshFileMaterial) > size ||
+				fileHeader->vertexOffset + fileHeader->vertexCount * fileHeader->vertexStride > size ||
+				fileHeader->indexOffset + fileHeader->indexSize > size)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring truncated mesh file: {}", filePath);
+				return;
+			}
+
+			const MeshFileSubMesh* fileSubMeshes = reinterpret_cast<const MeshFileSubMesh*>(data + fileHeader->subMeshOffset);
+			for (uint32_t i = 0; i < fileHeader->subMeshCount; ++i)
+			{
+				const MeshFileSubMesh& subMesh = fileSubMeshes[i];
+				const uint64_t indexStride = subMesh.indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+				if (subMesh.firstVertex + subMesh.vertexCount > fileHeader->vertexCount ||
+					subMesh.indexOffset + subMesh.indexCount * indexStride > fileHeader->indexSize ||
+					(subMesh.indexCount > 0 && subMesh.material >= fileHeader->materialCount))
+				{
+					DEBUG_LOG(LOG::WARNING, "Ignoring corrupt mesh file: {}", filePath);
+					return;
+				}
+			}
+
+			header = fileHeader;
+			subMeshes = fileSubMeshes;
+			materials = reinterpret_cast<const MeshFileMaterial*>(data + fileHeader->materialOffset);
+			vertices = data + fileHeader->vertexOffset;
+			indices = data + fileHeader->indexOffset;
+		}
+
+		MeshFile::~MeshFile()
+		{
+			file.reset();
+		}
+
+		void MeshFile::Prefetch() const
+		{
+			file->Prefetch();
+		}
+
+		bool MeshFile::Write(const std::string& filePath, const MeshSourceKey& key, const std::vector<SubMesh>& subMeshes)
+		{
+			std::vector<MeshFileSubMesh> fileSubMeshes;
+			std::vector<MeshFileMaterial> fileMaterials;
+			fileSubMeshes.reserve(subMeshes.size());
+
+			uint64_t vertexCount = 0;
+			uint64_t indexSize = 0;
+			for (const SubMesh& subMesh : subMeshes)
+			{
+				const MeshFileMaterial material = ToMeshFileMaterial(subMesh.material);
+				auto it = std::find_if(fileMaterials.begin(), fileMaterials.end(), [&material](const MeshFileMaterial& other) { return IsSameMaterial(material, other); });
+				if (it == fileMaterials.end())
+				{
+					it = fileMaterials.insert(fileMaterials.end(), material);
+				}
+
+				MeshFileSubMesh fileSubMesh{};
+				fileSubMesh.firstVertex = vertexCount;
+				fileSubMesh.indexOffset = indexSize;
+				fileSubMesh.vertexCount = static_cast<uint32_t>(subMesh.vertices.size());
+				fileSubMesh.indexCount = static_cast<uint32_t>(subMesh.indices.size());
+				fileSubMesh.indexType = static_cast<uint32_t>(subMesh.indexType);
+				fileSubMesh.material = static_cast<uint32_t>(it - fileMaterials.begin());
+				fileSubMesh.boxMin[0] = subMesh.bounds.box.min.x;
+				fileSubMesh.boxMin[1] = subMesh.bounds.box.min.y;
+				fileSubMesh.boxMin[2] = subMesh.bounds.box.min.z;
+				fileSubMesh.boxMax[0] = subMesh.bounds.box.max.x;
+				fileSubMesh.boxMax[1] = subMesh.bounds.box.max.y;
+				fileSubMesh.boxMax[2] = subMesh.bounds.box.max.z;
+				fileSubMesh.sphereCenter[0] = subMesh.bounds.sphere.center.x;
+				fileSubMesh.sphereCenter[1] = subMesh.bounds.sphere.center.y;
+				fileSubMesh.sphereCenter[2] = subMesh.bounds.sphere.center.z;
+				fileSubMesh.sphereRadius = subMesh.bounds.sphere.radius;
+				fileSubMeshes.push_back(fileSubMesh);
+
+				vertexCount += subMesh.vertices.size();
+				indexSize = AlignUp(indexSize + GetIndexSize(subMesh), sizeof(uint32_t));
+			}
+
+			MeshFileHeader header{};
+			header.magic = MESH_FILE_MAGIC;
+			header.version = BAAL_MESH_FILE_VERSION;
+			header.sourceSize = key.sourceSize;
+			header.sourceTime = key.sourceTime;
+			header.sourcePathLength = static_cast<uint32_t>(key.sourcePath.size());
+			header.vertexStride = sizeof(Vertex);
+			header.subMeshCount = static_cast<uint32_t>(fileSubMeshes.size());
+			header.materialCount = static_cast<uint32_t>(fileMaterials.size());
+			header.vertexCount = vertexCount;
+			header.subMeshOffset = AlignUp(sizeof(MeshFileHeader) + key.sourcePath.size(), MESH_FILE_SECTION_ALIGNMENT);
+			header.materialOffset = AlignUp(header.subMeshOffset + sizeof(MeshFileSubMesh) * fileSubMeshes.size(), MESH_FILE_SECTION_ALIGNMENT);
+			header.vertexOffset = AlignUp(header.materialOffset + sizeof(MeshFileMaterial) * fileMaterials.size(), MESH_FILE_SECTION_ALIGNMENT);
+			header.indexOffset = AlignUp(header.vertexOffset + sizeof(Vertex) * vertexCount, MESH_FILE_SECTION_ALIGNMENT);
+			header.indexSize = indexSize;
+
+			std::error_code error;
+			std::filesystem::create_directories(std::filesystem::path(filePath).parent_path(), error);
+
+			std::filesystem::path tempPath = filePath;
+			tempPath += ".tmp";
+
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+				{
+					DEBUG_LOG(LOG::WARNING, "Failed to write mesh file: {}", filePath);
+					return false;
+				}
+
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(key.sourcePath.data(), key.sourcePath.size());
+				WritePadding(file, sizeof(header) + key.sourcePath.size(), header.subMeshOffset);
+
+				file.write(reinterpret_cast<const char*>(fileSubMeshes.data()), sizeof(MeshFileSubMesh) * fileSubMeshes.size());
+				WritePadding(file, header.subMeshOffset + sizeof(MeshFileSubMesh) * fileSubMeshes.size(), header.materialOffset);
+
+				file.write(reinterpret_cast<const char*>(fileMaterials.data()), sizeof(MeshFileMaterial) * fileMaterials.size());
+				WritePadding(file, header.materialOffset + sizeof(MeshFileMaterial) * fileMaterials.size(), header.vertexOffset);
+
+				for (const SubMesh& subMesh : subMeshes)
+				{
+					file.write(reinterpret_cast<const char*>(subMesh.vertices.data()), sizeof(Vertex) * subMesh.vertices.size());
+				}
+				WritePadding(file, header.vertexOffset + sizeof(Vertex) * vertexCount, header.indexOffset);
+
+				uint64_t offset = 0;
+				for (const SubMesh& subMesh : subMeshes)
+				{
+					if (subMesh.indexType == VK_INDEX_TYPE_UINT16)
+					{
+						const std::vector<uint16_t> narrowIndices(subMesh.indices.begin(), subMesh.indices.end());
+						file.write(reinterpret_cast<const char*>(narrowIndices.data()), sizeof(uint16_t) * narrowIndices.size());
+					}
+					else
+					{
+						file.write(reinterpret_cast<const char*>(subMesh.indices.data()), sizeof(uint32_t) * subMesh.indices.size());
+					}
+
+					const uint64_t end = offset + GetIndexSize(subMesh);
+					offset = AlignUp(end, sizeof(uint32_t));
+					WritePadding(file, end, offset);
+				}
+
+				if (!file)
+				{
+					DEBUG_LOG(LOG::WARNING, "Failed to write mesh file: {}", filePath);
+					return false;
+				}
+			}
+
+			std::filesystem::rename(tempPath, filePath, error);
+			if (error)
+			{
+				DEBUG_LOG(LOG::WARNING, "Failed to write mesh file: {}, Error: {}", filePath, error.message());
+				return false;
+			}
+			return true;
+		}
+	}
+}
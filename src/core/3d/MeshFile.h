@@ -0,0 +1,123 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_MESH_FILE_H
+#define BAAL_VK_MESH_FILE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Where imported meshes are cached, the build points this at the build directory
+#ifndef BAAL_MESH_CACHE_DIR
+#define BAAL_MESH_CACHE_DIR "cache/meshes/"
+#endif // !BAAL_MESH_CACHE_DIR
+
+// Bump whenever the layout of a mesh file or the importer's output changes, invalidates every cached mesh file
+#ifndef BAAL_MESH_FILE_VERSION
+#define BAAL_MESH_FILE_VERSION 1
+#endif // !BAAL_MESH_FILE_VERSION
+
+namespace Baal
+{
+	class MappedFile;
+
+	namespace VK
+	{
+		struct SubMesh;
+
+		// Identifies the source a mesh file was imported from
+		// Size and write time stand in for a hash of the contents, hashing a large OBJ would cost as much as parsing it
+		struct MeshSourceKey
+		{
+			std::string sourcePath;
+			uint64_t sourceSize = 0;
+			int64_t sourceTime = 0;	// Latest write time of the OBJ and the MTL files next to it
+
+			static MeshSourceKey Create(const std::string& sourcePath);
+
+			std::string GetFileName() const;
+		};
+
+		// Every section starts on a 16 byte boundary, so the mapped data can be read in place
+		struct MeshFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t sourceSize;
+			int64_t sourceTime;
+			uint32_t sourcePathLength;	// The source path follows the header, a file name collision is treated as a miss
+			uint32_t vertexStride;
+			uint32_t subMeshCount;
+			uint32_t materialCount;
+			uint64_t vertexCount;
+			uint64_t subMeshOffset;
+			uint64_t materialOffset;
+			uint64_t vertexOffset;
+			uint64_t indexOffset;
+			uint64_t indexSize;
+		};
+
+		struct MeshFileSubMesh
+		{
+			uint64_t firstVertex;	// Into the vertex section
+			uint64_t indexOffset;	// Bytes into the index section
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t indexType;	// VkIndexType, indices are stored already narrowed
+			uint32_t material;	// Into the material section
+			float boxMin[3];
+			float boxMax[3];
+			float sphereCenter[3];
+			float sphereRadius;
+		};
+
+		struct MeshFileMaterial
+		{
+			float ambient[4];
+			float diffuse[3];
+			float specular[3];
+			float shininess;
+		};
+
+		// Binary mesh, written once after an OBJ is imported and memory mapped on every later load
+		// Interleaved vertices and indices are laid out exactly as the GeometryPool stores them, so they are uploaded straight from the mapping
+		class MeshFile
+		{
+		public:
+			// Maps the file and validates its header against the key, check IsValid() before reading
+			explicit MeshFile(const std::string& filePath, const MeshSourceKey& key);
+			MeshFile(const MeshFile&) = delete;
+			MeshFile(MeshFile&&) = delete;
+
+			~MeshFile();
+
+			MeshFile& operator=(const MeshFile&) = delete;
+			MeshFile& operator = (MeshFile&&) = delete;
+
+			// Written to a temporary file first, so a concurrent reader never maps a partially written mesh file
+			static bool Write(const std::string& filePath, const MeshSourceKey& key, const std::vector<SubMesh>& subMeshes);
+
+			bool IsValid() const { return header != nullptr; }
+
+			// Faults the whole mapping in on the calling thread, see MappedFile::Prefetch()
+			void Prefetch() const;
+
+			uint32_t GetSubMeshCount() const { return header->subMeshCount; }
+			const MeshFileSubMesh& GetSubMesh(const uint32_t index) const { return subMeshes[index]; }
+			const MeshFileMaterial& GetMaterial(const uint32_t index) const { return materials[index]; }
+			const void* GetVertices(const MeshFileSubMesh& subMesh) const { return vertices + subMesh.firstVertex * header->vertexStride; }
+			const void* GetIndices(const MeshFileSubMesh& subMesh) const { return indices + subMesh.indexOffset; }
+
+		private:
+			std::unique_ptr<MappedFile> file;
+			const MeshFileHeader* header{ nullptr };
+			const MeshFileSubMesh* subMeshes{ nullptr };
+			const MeshFileMaterial* materials{ nullptr };
+			const uint8_t* vertices{ nullptr };
+			const uint8_t* indices{ nullptr };
+		};
+	}
+}
+
+#endif // !BAAL_VK_MESH_FILE_H
@@ -3,7 +3,12 @@
 #include "MeshHandler.h"
 
 #include "../src/core/3d/Mesh.h"
+#include "../src/core/3d/Frustum.h"
 #include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/resource/GeometryPool.h"
+#include "../src/core/vulkan/resource/Uploader.h"
+#include "../src/core/vulkan/descriptors/BindlessTable.h"
+#include "../src/core/jobs/JobSystem.h"
 #include "../src/utility/DebugLog.h"
 #include <cassert>
 #include <algorithm>
@@ -12,19 +17,31 @@ namespace Baal
 {
 	namespace VK
 	{
-		MeshHandler::MeshHandler()
+		MeshHandler::MeshHandler(LogicalDevice& device, JobSystem& _jobSystem, BindlessTable* _bindlessTable /*= nullptr*/):
+			jobSystem(_jobSystem),
+			bindlessTable(_bindlessTable)
 		{
+			geometryPool = std::make_unique<GeometryPool>(device, sizeof(Vertex));
+
+			std::unique_ptr<Mesh> placeholder = std::make_unique<Mesh>();
+			placeholder->CreateBox(0.5f);
+			Mesh& mesh = *placeholder.get();
+			placeholderMesh = meshes.Insert(std::move(placeholder));
+			UploadMesh(placeholderMesh, mesh);
 		}
 
 		MeshHandler::~MeshHandler()
 		{
-			garbage.clear();
-			subMeshInstances.clear();
-			meshInstances.clear();
+			visibleSubMeshes.clear();
+			pendingMeshes.clear();
+			subMeshInstances.Clear();
+			meshInstances.Clear();
 			loadedMeshMap.clear();
+			meshes.Clear();
+			geometryPool.reset();
 		}
 
-		std::weak_ptr<Mesh> MeshHandler::LoadMeshResource(const char* parentDirectory, const char* meshFileName)
+		MeshHandle MeshHandler::LoadMeshResource(const char* parentDirectory, const char* meshFileName)
 		{
 			const std::string path = std::string(parentDirectory);
 			const std::string fileName = std::string(meshFileName);
@@ -32,83 +49,326 @@ namespace Baal
 
 			DEBUG_LOG(LOG::INFO, "Looking up existing Mesh Resource for: {}", completeFilePath);
 
-			std::shared_ptr<Mesh> mesh = loadedMeshMap[completeFilePath];
-
-			if (mesh == nullptr)
+			auto it = loadedMeshMap.find(completeFilePath);
+			if (it == loadedMeshMap.end())
 			{
 				DEBUG_LOG(LOG::INFO, "Could not find existing Mesh Resource for {}... Attempting to create new Mesh Resource!", fileName);
-				mesh = std::make_shared<Mesh>(parentDirectory, meshFileName);
-				assert(mesh != nullptr);
-				loadedMeshMap[completeFilePath] = mesh;
-				return mesh;
+				std::unique_ptr<Mesh> resource = std::make_unique<Mesh>();
+				Mesh& mesh = *resource.get();
+				const MeshHandle handle = meshes.Insert(std::move(resource));
+				loadedMeshMap[completeFilePath] = handle;
+
+				if (mesh.Load(jobSystem, parentDirectory, meshFileName))
+				{
+					UploadMesh(handle, mesh);
+				}
+				else
+				{
+					mesh.state = MeshState::FAILED;
+				}
+				return handle;
 			}
 
 			DEBUG_LOG(LOG::INFO, "Found existing Mesh Resource for {}", fileName);
-			return mesh;
+			return it->second;
 		}
 
-		std::weak_ptr<MeshInstance> MeshHandler::CreateMeshInstance(LogicalDevice& device, Mesh& resource)
+		MeshHandle MeshHandler::LoadMeshResourceAsync(const char* parentDirectory, const char* meshFileName, MeshLoadedCallback onLoaded /*= nullptr*/)
 		{
-			const uint32_t id = static_cast<uint32_t>(meshInstances.size());
-			std::shared_ptr<MeshInstance> instance = std::make_shared<MeshInstance>(device, resource, id);
-			assert(instance != nullptr);
-			meshInstances.push_back(instance);
-			subMeshInstances.insert(subMeshInstances.end(), instance->subMeshes.begin(), instance->subMeshes.end());
-			return instance;
+			// Copied, the job outlives the caller's strings
+			const std::string path = std::string(parentDirectory);
+			const std::string fileName = std::string(meshFileName);
+			const std::string completeFilePath = path + fileName;
+
+			auto it = loadedMeshMap.find(completeFilePath);
+			if (it != loadedMeshMap.end())
+			{
+				if (onLoaded != nullptr)
+				{
+					auto pending = std::find_if(pendingMeshes.begin(), pendingMeshes.end(), [&it](const PendingMesh& pendingMesh) { return pendingMesh.mesh == it->second; });
+					if (pending != pendingMeshes.end())
+					{
+						pending->callbacks.push_back(std::move(onLoaded));
+					}
+					else
+					{
+						onLoaded(it->second, GetMesh(it->second)->GetState() == MeshState::RESIDENT);
+					}
+				}
+				return it->second;
+			}
+
+			DEBUG_LOG(LOG::INFO, "Could not find existing Mesh Resource for {}... Loading new Mesh Resource in the background!", fileName);
+
+			// The Mesh is only touched by the job until FinishMeshLoad(), and Mesh resources live until shutdown
+			std::unique_ptr<Mesh> resource = std::make_unique<Mesh>();
+			Mesh* mesh = resource.get();
+			const MeshHandle handle = meshes.Insert(std::move(resource));
+			loadedMeshMap[completeFilePath] = handle;
+
+			PendingMesh pendingMesh;
+			pendingMesh.mesh = handle;
+			if (onLoaded != nullptr)
+			{
+				pendingMesh.callbacks.push_back(std::move(onLoaded));
+			}
+			pendingMeshes.push_back(std::move(pendingMesh));
+
+			jobSystem.SubmitBackground([this, mesh, handle, path, fileName]()
+			{
+				const bool bSuccess = mesh->Load(jobSystem, path.c_str(), fileName.c_str());
+				jobSystem.SubmitToMainThread([this, handle, bSuccess]() { FinishMeshLoad(handle, bSuccess); });
+			});
+			return handle;
 		}
 
-		void MeshHandler::DestroyMeshInstance(std::weak_ptr<MeshInstance> mesh)
+		void MeshHandler::FinishMeshLoad(const MeshHandle handle, const bool bSuccess)
 		{
-			if (mesh.expired())
+			Mesh* mesh = GetMesh(handle);
+			if (!bSuccess)
 			{
-				return; // Exit! A non-valid mesh instance cannot be destroyed!
+				// Instances keep drawing the placeholder, the callbacks are told by UpdatePendingMeshes()
+				mesh->state = MeshState::FAILED;
+				return;
 			}
 
-			std::shared_ptr<MeshInstance> meshToDestroy = mesh.lock();
+			UploadMesh(handle, *mesh);
+		}
 
-			const uint32_t lastIndex = meshInstances.size() - 1;
-			std::shared_ptr<MeshInstance> lastMesh = meshInstances[lastIndex];
+		void MeshHandler::UploadMesh(const MeshHandle handle, Mesh& mesh)
+		{
+			mesh.UploadToDevice(*geometryPool.get());
+			if (bindlessTable != nullptr)
+			{
+				for (SubMesh& subMesh : mesh.subMeshes)
+				{
+					subMesh.materialIndex = bindlessTable->AddMaterial(subMesh.material);
+				}
+			}
+			mesh.state = MeshState::UPLOADING;
 
-			lastMesh->id = meshToDestroy->id;	// Take the index for the mesh that is being removed from the vector
-			for (size_t i = 0; i < lastMesh->subMeshes.size(); ++i)
+			auto pending = std::find_if(pendingMeshes.begin(), pendingMeshes.end(), [&handle](const PendingMesh& pendingMesh) { return pendingMesh.mesh == handle; });
+			if (pending == pendingMeshes.end())
 			{
-				lastMesh->subMeshes[i]->parentId = lastMesh->id;
+				PendingMesh pendingMesh;
+				pendingMesh.mesh = handle;
+				pendingMeshes.push_back(std::move(pendingMesh));
 			}
-			
-			meshInstances[lastMesh->id] = lastMesh;	// Move the last mesh into its new index.
+		}
+
+		void MeshHandler::UpdatePendingMeshes(Uploader& uploader)
+		{
+			const UploadTicket completedTicket = uploader.GetCompletedTicket();
+
+			std::vector<PendingMesh> finishedMeshes;
+			for (size_t i = 0; i < pendingMeshes.size();)
+			{
+				Mesh* mesh = GetMesh(pendingMeshes[i].mesh);
+				const bool bUploaded = mesh->state == MeshState::UPLOADING && mesh->uploadTicket <= completedTicket;
+				if (!bUploaded && mesh->state != MeshState::FAILED)
+				{
+					++i;
+					continue;
+				}
+
+				if (bUploaded)
+				{
+					mesh->state = MeshState::RESIDENT;
+
+					// Instances created while the mesh was loading trade the placeholder for the real sub meshes
+					std::vector<MeshInstance>& instances = meshInstances.GetValues();
+					for (uint32_t instanceIndex = 0; instanceIndex < instances.size(); ++instanceIndex)
+					{
+						if (instances[instanceIndex].mesh == pendingMeshes[i].mesh && instances[instanceIndex].bPlaceholder)
+						{
+							RemoveSubMeshInstances(instances[instanceIndex]);
+							AddSubMeshInstances(meshInstances.GetHandle(instanceIndex), *mesh);
+							instances[instanceIndex].bPlaceholder = false;
+						}
+					}
+				}
+				else
+				{
+					DEBUG_LOG(LOG::ERRORLOG, "Failed to load Mesh Resource! Its instances keep drawing the placeholder mesh");
+				}
 
-			// Clean up
-			meshInstances[lastIndex].reset();
-			meshInstances.pop_back();
+				finishedMeshes.push_back(std::move(pendingMeshes[i]));
+				pendingMeshes[i] = std::move(pendingMeshes.back());
+				pendingMeshes.pop_back();
+			}
 
-			// Destroy the target mesh
-			garbage.push_back(meshToDestroy);
+			// Called last, a callback may load more meshes or create instances
+			for (PendingMesh& finishedMesh : finishedMeshes)
+			{
+				const bool bSuccess = GetMesh(finishedMesh.mesh)->GetState() == MeshState::RESIDENT;
+				for (MeshLoadedCallback& callback : finishedMesh.callbacks)
+				{
+					callback(finishedMesh.mesh, bSuccess);
+				}
+			}
 		}
 
-		void MeshHandler::CollectSubMeshesToRender()
+		Mesh* MeshHandler::GetMesh(const MeshHandle handle)
 		{
-			subMeshInstances.clear();
+			std::unique_ptr<Mesh>* mesh = meshes.Get(handle);
+			return mesh != nullptr ? mesh->get() : nullptr;
+		}
+
+		MeshInstanceHandle MeshHandler::CreateMeshInstance(const MeshHandle resource)
+		{
+			Mesh* mesh = GetMesh(resource);
+			if (mesh == nullptr)
+			{
+				return MeshInstanceHandle();
+			}
+
+			const MeshInstanceHandle handle = meshInstances.Insert(MeshInstance());
+			MeshInstance& instance = *meshInstances.Get(handle);
+			instance.mesh = resource;
+
+			// Geometry that is still uploading is held back by its upload ticket, only a mesh without geometry yet needs the placeholder
+			const bool bHasGeometry = mesh->GetState() == MeshState::UPLOADING || mesh->GetState() == MeshState::RESIDENT;
+			Mesh* placeholder = GetMesh(placeholderMesh);
+			if (!bHasGeometry && placeholder != nullptr)
+			{
+				instance.bPlaceholder = true;
+				AddSubMeshInstances(handle, *placeholder);
+			}
+			else if (bHasGeometry)
+			{
+				AddSubMeshInstances(handle, *mesh);
+			}
 
-			for (size_t i = 0; i < meshInstances.size(); ++i)
+			return handle;
+		}
+
+		void MeshHandler::AddSubMeshInstances(const MeshInstanceHandle handle, const Mesh& mesh)
+		{
+			MeshInstance& instance = *meshInstances.Get(handle);
+			for (size_t i = 0; i < mesh.subMeshes.size(); ++i)
 			{
-				for (size_t n = 0; n < meshInstances[i]->subMeshes.size(); ++n)
+				const SubMesh& subMesh = mesh.subMeshes[i];
+				if (subMesh.vertexBuffer == nullptr)
 				{
-					subMeshInstances.push_back(meshInstances[i]->subMeshes[n]);
+					continue;	// Nothing to draw for an empty Sub Mesh
 				}
+
+				SubMeshInstance subMeshInstance;
+				subMeshInstance.parent = handle;
+				subMeshInstance.firstIndex = subMesh.geometry.firstIndex;
+				subMeshInstance.indexCount = subMesh.geometry.indexCount;
+				subMeshInstance.vertexOffset = subMesh.geometry.vertexOffset;
+				subMeshInstance.indexType = subMesh.indexType;
+				subMeshInstance.uploadTicket = mesh.uploadTicket;
+				subMeshInstance.bounds = subMesh.bounds;
+				subMeshInstance.material = subMesh.material;
+				subMeshInstance.materialIndex = subMesh.materialIndex;
+				instance.subMeshes.push_back(subMeshInstances.Insert(subMeshInstance));
 			}
 		}
 
-		bool MeshHandler::IsGarbageFull() const
+		void MeshHandler::RemoveSubMeshInstances(MeshInstance& instance)
 		{
-			return garbage.size() > 0;
+			for (const SubMeshHandle handle : instance.subMeshes)
+			{
+				subMeshInstances.Remove(handle);
+			}
+			instance.subMeshes.clear();
 		}
 
-		void MeshHandler::TryEmptyGarbage()
+		void MeshHandler::DestroyMeshInstance(const MeshInstanceHandle meshInstance)
 		{
-			if (IsGarbageFull())
+			MeshInstance* instance = meshInstances.Get(meshInstance);
+			if (instance == nullptr)
 			{
-				garbage.clear();
+				return; // Exit! A non-valid mesh instance cannot be destroyed!
 			}
+
+			// Sub meshes refer to their parent by handle, so nothing needs rewriting when the slot maps move values around
+			// The geometry belongs to the Mesh resource and draws copy everything they need at record time, so there is nothing to keep alive for the GPU
+			RemoveSubMeshInstances(*instance);
+			meshInstances.Remove(meshInstance);
+		}
+
+		void MeshHandler::CollectSubMeshesToRender(Uploader& uploader, const Frustum& frustum)
+		{
+			visibleSubMeshes.clear();
+			cullCandidates.clear();
+
+			const UploadTicket completedTicket = uploader.GetCompletedTicket();
+			std::vector<SubMeshInstance>& subMeshes = subMeshInstances.GetValues();
+
+			for (size_t i = 0; i < subMeshes.size(); ++i)
+			{
+				if (subMeshes[i].uploadTicket <= completedTicket)
+				{
+					cullCandidates.push_back(static_cast<uint32_t>(i));
+				}
+			}
+
+			const size_t candidateCount = cullCandidates.size();
+			cullSphereX.resize(candidateCount);
+			cullSphereY.resize(candidateCount);
+			cullSphereZ.resize(candidateCount);
+			cullSphereRadius.resize(candidateCount);
+			cullVisibility.resize(candidateCount);
+
+			// Every batch only writes its own range of the scratch arrays
+			jobSystem.ParallelFor(static_cast<uint32_t>(candidateCount), BAAL_MIN_SUBMESHES_PER_CULLING_JOB, [&](const uint32_t begin, const uint32_t end)
+			{
+				// Sub meshes of an instance are inserted together, so the model matrix rarely changes between neighbours
+				float model[16];
+				MeshInstanceHandle modelParent;
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					const SubMeshInstance& subMesh = subMeshes[cullCandidates[i]];
+					if (subMesh.parent != modelParent)
+					{
+						modelParent = subMesh.parent;
+						ToColumnMajor(meshInstances.Get(modelParent)->model, model);
+					}
+
+					const BoundingSphere sphere = subMesh.bounds.sphere.Transform(model);
+					cullSphereX[i] = sphere.center.x;
+					cullSphereY[i] = sphere.center.y;
+					cullSphereZ[i] = sphere.center.z;
+					cullSphereRadius[i] = sphere.radius;
+				}
+
+				frustum.CullSpheres(cullSphereX.data() + begin, cullSphereY.data() + begin, cullSphereZ.data() + begin, cullSphereRadius.data() + begin, end - begin, cullVisibility.data() + begin);
+
+				// Spheres are loose around long thin shapes, the box rejects most of what they let through
+				modelParent = MeshInstanceHandle();
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					if (!cullVisibility[i])
+					{
+						continue;
+					}
+
+					const SubMeshInstance& subMesh = subMeshes[cullCandidates[i]];
+					if (subMesh.parent != modelParent)
+					{
+						modelParent = subMesh.parent;
+						ToColumnMajor(meshInstances.Get(modelParent)->model, model);
+					}
+
+					if (!frustum.IsBoxVisible(subMesh.bounds.box.Transform(model)))
+					{
+						cullVisibility[i] = 0;
+					}
+				}
+			});
+
+			for (size_t i = 0; i < candidateCount; ++i)
+			{
+				if (cullVisibility[i])
+				{
+					visibleSubMeshes.push_back(cullCandidates[i]);
+				}
+			}
+
+			culledCount = static_cast<uint32_t>(cullCandidates.size() - visibleSubMeshes.size());
 		}
 	}
 }
\ No newline at end of file
@@ -7,25 +7,71 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
+
+#include "../src/utility/SlotMap.h"
+
+#ifndef BAAL_MIN_SUBMESHES_PER_CULLING_JOB
+#define BAAL_MIN_SUBMESHES_PER_CULLING_JOB 512	// Below this a culling job costs more to hand off than it saves
+#endif // !BAAL_MIN_SUBMESHES_PER_CULLING_JOB
 
 namespace Baal
 {
+	class JobSystem;
+
 	namespace VK
 	{
 		class Mesh;
-		class MeshInstance;
-		class SubMeshInstance;
+		struct MeshInstance;
+		struct SubMeshInstance;
+		using MeshHandle = Handle<Mesh>;
+		using MeshInstanceHandle = Handle<MeshInstance>;
+		using SubMeshHandle = Handle<SubMeshInstance>;
 		class LogicalDevice;
+		class Uploader;
+		class GeometryPool;
+		class Frustum;
+		class BindlessTable;
+
+		// Called on the render thread once a mesh is resident, or failed to load
+		using MeshLoadedCallback = std::function<void(const MeshHandle mesh, const bool bSuccess)>;
 
 		class MeshHandler
 		{
-			std::unordered_map<std::string, std::shared_ptr<Mesh>> loadedMeshMap;
-			std::vector<std::shared_ptr<MeshInstance>> meshInstances;
-			std::vector<std::shared_ptr<SubMeshInstance>> subMeshInstances;
-			std::vector<std::shared_ptr<MeshInstance>> garbage;
+			// A mesh that is still loading or uploading, and who to tell once it is done
+			struct PendingMesh
+			{
+				MeshHandle mesh;
+				std::vector<MeshLoadedCallback> callbacks;
+			};
+
+			JobSystem& jobSystem;	// Loads meshes and culls the render list
+			std::unique_ptr<GeometryPool> geometryPool;	// Geometry of every loaded Mesh
+			BindlessTable* bindlessTable;	// Optional, every loaded Sub Mesh material is added to it
+			SlotMap<std::unique_ptr<Mesh>, Mesh> meshes;	// Mesh is not movable, so only the pointers are dense
+			std::unordered_map<std::string, MeshHandle> loadedMeshMap;
+			std::vector<PendingMesh> pendingMeshes;	// See UpdatePendingMeshes()
+			MeshHandle placeholderMesh;	// Drawn for instances of meshes that are not resident yet
+			SlotMap<MeshInstance> meshInstances;
+			SlotMap<SubMeshInstance> subMeshInstances;	// The render list, kept up to date by CreateMeshInstance() and DestroyMeshInstance()
+			std::vector<uint32_t> visibleSubMeshes;	// Indices into the render list that passed the last CollectSubMeshesToRender()
+
+			// Culling scratch, reused every frame. World space spheres are kept as separate arrays so they can be tested four at a time
+			std::vector<uint32_t> cullCandidates;
+			std::vector<float> cullSphereX;
+			std::vector<float> cullSphereY;
+			std::vector<float> cullSphereZ;
+			std::vector<float> cullSphereRadius;
+			std::vector<uint8_t> cullVisibility;
+			uint32_t culledCount = 0;
+
+			void UploadMesh(const MeshHandle handle, Mesh& mesh);
+			void FinishMeshLoad(const MeshHandle handle, const bool bSuccess);
+			void AddSubMeshInstances(const MeshInstanceHandle handle, const Mesh& mesh);
+			void RemoveSubMeshInstances(MeshInstance& instance);
 
 		public:
-			MeshHandler();
+			explicit MeshHandler(LogicalDevice& device, JobSystem& _jobSystem, BindlessTable* _bindlessTable = nullptr);
 			MeshHandler(const MeshHandler&) = delete;
 			MeshHandler(MeshHandler&&) = delete;
 
@@ -34,18 +80,42 @@ namespace Baal
 			MeshHandler& operator=(const MeshHandler&) = delete;
 			MeshHandler& operator = (MeshHandler&&) = delete;
 
-			std::weak_ptr<Mesh> LoadMeshResource(const char* parentDirectory, const char* meshFileName);
+			MeshHandle LoadMeshResource(const char* parentDirectory, const char* meshFileName);
+
+			// Returns at once, the mesh is read or imported on a worker thread and uploaded on the render thread
+			// The handle is valid straight away, instances created before the mesh is resident draw the placeholder mesh until it is
+			// onLoaded is called even when the mesh was already loaded
+			MeshHandle LoadMeshResourceAsync(const char* parentDirectory, const char* meshFileName, MeshLoadedCallback onLoaded = nullptr);
+
+			// Render thread, once per frame. Marks meshes whose upload completed as resident, swaps them in for the placeholder and calls their callbacks
+			void UpdatePendingMeshes(Uploader& uploader);
+
+			// A null handle draws nothing until meshes are resident, defaults to a unit box
+			void SetPlaceholderMesh(const MeshHandle mesh) { placeholderMesh = mesh; }
+			MeshHandle GetPlaceholderMesh() const { return placeholderMesh; }
+
+			// Returns a null handle if the resource handle is stale
+			MeshInstanceHandle CreateMeshInstance(const MeshHandle resource);
+			// The instance and its sub meshes leave the render list immediately, their handles go stale
+			void DestroyMeshInstance(const MeshInstanceHandle meshInstance);
 
-			std::weak_ptr<MeshInstance> CreateMeshInstance(LogicalDevice& device, Mesh& resource);
-			void DestroyMeshInstance(std::weak_ptr<MeshInstance> meshInstance);
+			// Fills GetVisibleSubMeshes() with every sub mesh inside the frustum, sub meshes whose geometry is still being uploaded are skipped until their upload completes
+			// Sub meshes are tested with their bounding sphere first, and the survivors with their bounding box
+			// Batches of the render list are culled as jobs, the visible list keeps render list order
+			void CollectSubMeshesToRender(Uploader& uploader, const Frustum& frustum);
 
-			void CollectSubMeshesToRender();
+			// Lookups return nullptr once the handle is stale
+			Mesh* GetMesh(const MeshHandle handle);
+			MeshInstance* GetMeshInstance(const MeshInstanceHandle handle) { return meshInstances.Get(handle); }
+			SubMeshInstance* GetSubMeshInstance(const SubMeshHandle handle) { return subMeshInstances.Get(handle); }
 
-			std::vector<std::shared_ptr<MeshInstance>>& GetMeshInstances() { return meshInstances; }
-			std::vector<std::shared_ptr<SubMeshInstance>>& GetSubMeshInstances() { return subMeshInstances; }
+			// Dense arrays, for walking every instance or sub mesh without going through handles
+			std::vector<MeshInstance>& GetMeshInstances() { return meshInstances.GetValues(); }
+			std::vector<SubMeshInstance>& GetSubMeshInstances() { return subMeshInstances.GetValues(); }
+			const std::vector<uint32_t>& GetVisibleSubMeshes() const { return visibleSubMeshes; }
 
-			bool IsGarbageFull() const;
-			void TryEmptyGarbage();
+			GeometryPool& GetGeometryPool() { return *geometryPool.get(); }
+			uint32_t GetCulledCount() const { return culledCount; }	// Sub meshes rejected by the last CollectSubMeshesToRender()
 		};
 	}
 }
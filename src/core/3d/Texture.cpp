@@ -2,13 +2,18 @@
 
 #include "Texture.h"
 
+#include "../src/core/3d/TextureFile.h"
 #include "../src/core/vulkan/debugging/Error.h"
 #include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/devices/PhysicalDevice.h"
 #include "../src/core/vulkan/resource/Image.h"
-#include "../src/core/vulkan/resource/Buffer.h"
-#include "../src/core/vulkan/commands/CommandBuffer.h"
+#include "../src/core/vulkan/resource/Uploader.h"
+#include "../src/core/vulkan/resource/DeletionQueue.h"
+#include "../src/core/jobs/JobSystem.h"
 
+#include <filesystem>
 #include <string>
+#include <vector>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "../src/utility/stb/stb_image.h"
@@ -17,18 +22,183 @@ namespace Baal
 {
 	namespace VK
 	{
+		// Everything the decode job needs, owned by the TextureInstance and the job together
+		struct TextureLoad
+		{
+			TextureInstance* texture{ nullptr };	// Cleared on the render thread when the TextureInstance is destroyed first
+			LogicalDevice* device{ nullptr };
+			JobSystem* jobSystem{ nullptr };
+			std::string filePath;
+			std::string fileName;
+			VkImageType type = VK_IMAGE_TYPE_2D;
+			bool bGenerateMipmaps = true;
+			TextureLoadedCallback onLoaded;
+
+			std::unique_ptr<TextureFile> textureFile;	// Pre-compressed, when there is one the GPU can sample
+			stbi_uc* pixels{ nullptr };
+			int width = 0;
+			int height = 0;
+			int channels = 0;
+
+			std::unique_ptr<Image> uploadingImage;	// Swapped in for the placeholder once uploadTicket completes
+			UploadTicket uploadTicket = 0;
+
+			~TextureLoad()
+			{
+				if (pixels != nullptr)
+				{
+					stbi_image_free(pixels);
+				}
+			}
+		};
+
+		namespace
+		{
+			constexpr VkFormat TEXTURE_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
+			// Sampling a minified texture from its full resolution level thrashes the texture cache and aliases
+			constexpr VkFormatFeatureFlags MIP_GENERATION_FEATURES = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+			VkImageSubresourceRange GetColorRange(const uint32_t mipLevels)
+			{
+				VkImageSubresourceRange subresourceRange = {};
+				subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				subresourceRange.baseMipLevel = 0;
+				subresourceRange.levelCount = mipLevels;
+				subresourceRange.baseArrayLayer = 0;
+				subresourceRange.layerCount = 1;
+				return subresourceRange;
+			}
+
+			std::unique_ptr<Image> CreateImage(LogicalDevice& device, const void* pixels, const uint32_t width, const uint32_t height, const VkImageType type, const bool bGenerateMipmaps, UploadTicket& outUploadTicket)
+			{
+				const bool bMipmaps = bGenerateMipmaps && device.GetPhysicalDevice().IsFormatSupported(TEXTURE_FORMAT, MIP_GENERATION_FEATURES);
+				const VkImageSubresourceRange subresourceRange = GetColorRange(bMipmaps ? Image::CalculateMipLevels(width, height) : 1);
+
+				VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+				if (subresourceRange.levelCount > 1)
+				{
+					usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;	// Each level is blitted from the one above it
+				}
+
+				std::unique_ptr<Image> image = std::make_unique<Image>(
+					device, 
+					width, 
+					height, 
+					type, 
+					TEXTURE_FORMAT, 
+					VK_IMAGE_TILING_OPTIMAL, 
+					usage, 
+					VK_SAMPLE_COUNT_1_BIT, 
+					VK_IMAGE_VIEW_TYPE_2D, 
+					subresourceRange);
+
+				// Pixels are copied into the staging ring right away, so they can be freed before the batch is submitted
+				const VkDeviceSize imageSize = static_cast<VkDeviceSize>(width) * height * 4;	// Channels represent the RGBA 4 bytes of data per pixel
+				outUploadTicket = device.GetUploader().UploadImage(*image.get(), pixels, imageSize, width, height, subresourceRange);
+				return image;
+			}
+
+			// Every level is copied from the mapping as it is, the file brings its own mip chain
+			// Unless the file asks for the chain to be generated, which is blitted from the base level like a decoded texture
+			std::unique_ptr<Image> CreateImage(LogicalDevice& device, const TextureFile& textureFile, const VkImageType type, const bool bGenerateMipmaps, UploadTicket& outUploadTicket)
+			{
+				const bool bMipmaps = bGenerateMipmaps && textureFile.ShouldGenerateMipmaps() && device.GetPhysicalDevice().IsFormatSupported(textureFile.GetFormat(), MIP_GENERATION_FEATURES);
+				const VkImageSubresourceRange subresourceRange = GetColorRange(bMipmaps ? Image::CalculateMipLevels(textureFile.GetWidth(), textureFile.GetHeight()) : textureFile.GetMipLevels());
+
+				VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+				if (bMipmaps)
+				{
+					usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+				}
+
+				std::unique_ptr<Image> image = std::make_unique<Image>(
+					device, 
+					textureFile.GetWidth(), 
+					textureFile.GetHeight(), 
+					type, 
+					textureFile.GetFormat(), 
+					VK_IMAGE_TILING_OPTIMAL, 
+					usage, 
+					VK_SAMPLE_COUNT_1_BIT, 
+					VK_IMAGE_VIEW_TYPE_2D, 
+					subresourceRange);
+
+				std::vector<ImageUploadLevel> levels;
+				levels.reserve(textureFile.GetMipLevels());
+				for (uint32_t level = 0; level < textureFile.GetMipLevels(); ++level)
+				{
+					const TextureFileLevel& fileLevel = textureFile.GetLevel(level);
+					levels.push_back({ fileLevel.data, fileLevel.size, fileLevel.width, fileLevel.height });
+				}
+
+				outUploadTicket = device.GetUploader().UploadImageLevels(*image.get(), levels, subresourceRange);
+				return image;
+			}
+
+			// A KTX2 or DDS file is loaded as it is. Any other file is swapped for its BaalTextureCompressor output, when that is at least as new as the file and was compressed from it
+			// Returns nullptr when there is no usable compressed texture, the file is then decoded with stb_image
+			std::unique_ptr<TextureFile> OpenTextureFile(const LogicalDevice& device, const std::string& filePath)
+			{
+				std::string compressedPath = filePath;
+				if (!TextureFile::IsContainer(filePath))
+				{
+					compressedPath = std::string(BAAL_TEXTURE_CACHE_DIR) + TextureFile::GetCacheFileName(filePath);
+
+					std::error_code cacheError;
+					std::error_code sourceError;
+					const auto cacheTime = std::filesystem::last_write_time(compressedPath, cacheError);
+					const auto sourceTime = std::filesystem::last_write_time(filePath, sourceError);
+					if (cacheError || sourceError || cacheTime < sourceTime)
+					{
+						return nullptr;
+					}
+				}
+
+				std::unique_ptr<TextureFile> textureFile = std::make_unique<TextureFile>(compressedPath);
+				if (!textureFile->IsValid())
+				{
+					return nullptr;
+				}
+
+				// A hash collision in the cache file name is treated as a miss
+				if (compressedPath != filePath && textureFile->GetSourcePath() != TextureFile::NormalizeSourcePath(filePath))
+				{
+					DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, It was compressed from {}", compressedPath, textureFile->GetSourcePath());
+					return nullptr;
+				}
+
+				if (!device.GetPhysicalDevice().IsTextureFormatSupported(textureFile->GetFormat()))
+				{
+					DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, The GPU cannot sample {}", compressedPath, string_VkFormat(textureFile->GetFormat()));
+					return nullptr;
+				}
+				return textureFile;
+			}
+		}
+
 		TextureInstance::TextureInstance(LogicalDevice& device, const Texture texture)
 		{
 			std::string filePath = std::string(texture.parentDirectory) + std::string(texture.fileName);
 
 			DEBUG_LOG(LOG::INFO, "Loading Texture: {}", texture.fileName);
 
+			UploadTicket uploadTicket = 0;
+			if (const std::unique_ptr<TextureFile> textureFile = OpenTextureFile(device, filePath))
+			{
+				image = CreateImage(device, *textureFile.get(), texture.type, texture.bGenerateMipmaps, uploadTicket);
+				device.GetUploader().Wait(uploadTicket);
+
+				DEBUG_LOG(LOG::INFO, "Successfully loaded Texture: {} | [{}x{}] {}, {} mip level(s)", texture.fileName, image->GetWidth(), image->GetHeight(), string_VkFormat(image->GetVkFormat()), image->GetMipLevels());
+				bResident = true;
+				return;
+			}
+
 			int width = 0;
 			int height = 0;
 			int channels = 0;
 
 			stbi_uc* pixels = stbi_load(filePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
-			VkDeviceSize imageSize = width * height * 4;	// Channels represent the RGBA 4 bytes of data per pixel
 
 			if (pixels == nullptr) 
 			{
@@ -36,38 +206,147 @@ namespace Baal
 				return;
 			}
 
-			DEBUG_LOG(LOG::INFO, "Successfully loaded Texture: {} | [{}x{}] {} channel(s)", texture.fileName, width, height, channels);
-
-			VkImageSubresourceRange subresourceRange = {};
-			subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			subresourceRange.baseMipLevel = 0;
-			subresourceRange.levelCount = 1;
-			subresourceRange.baseArrayLayer = 0;
-			subresourceRange.layerCount = 1;
-
-			image = std::make_unique<Image>(
-				device, 
-				static_cast<uint32_t>(width), 
-				static_cast<uint32_t>(height), 
-				texture.type, 
-				VK_FORMAT_R8G8B8A8_SRGB, 
-				VK_IMAGE_TILING_OPTIMAL, 
-				VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
-				VK_SAMPLE_COUNT_1_BIT, 
-				VK_IMAGE_VIEW_TYPE_2D, 
-				subresourceRange);
-
-			Buffer stagingBuffer = Buffer::CreateStagingBuffer(device.GetAllocator(), imageSize, pixels);
-			Image::TransitionToLayout(*image.get(), VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT, subresourceRange);
-			device.CopyBufferToImage(stagingBuffer, *image.get(), width, height);
-			Image::TransitionToLayout(*image.get(), VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, subresourceRange);
+			image = CreateImage(device, pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height), texture.type, texture.bGenerateMipmaps, uploadTicket);
+			device.GetUploader().Wait(uploadTicket);
+
+			DEBUG_LOG(LOG::INFO, "Successfully loaded Texture: {} | [{}x{}] {} channel(s), {} mip level(s)", texture.fileName, width, height, channels, image->GetMipLevels());
+			bResident = true;
 
 			stbi_image_free(pixels);
 		}
 
+		TextureInstance::TextureInstance(LogicalDevice& device, JobSystem& jobSystem, const Texture texture, TextureLoadedCallback onLoaded /*= nullptr*/)
+		{
+			const uint32_t placeholderPixel = 0xFFFFFFFF;
+			UploadTicket placeholderTicket = 0;
+			image = CreateImage(device, &placeholderPixel, 1, 1, texture.type, false, placeholderTicket);
+
+			pendingLoad = std::make_shared<TextureLoad>();
+			pendingLoad->texture = this;
+			pendingLoad->device = &device;
+			pendingLoad->jobSystem = &jobSystem;
+			pendingLoad->filePath = std::string(texture.parentDirectory) + std::string(texture.fileName);
+			pendingLoad->fileName = std::string(texture.fileName);
+			pendingLoad->type = texture.type;
+			pendingLoad->bGenerateMipmaps = texture.bGenerateMipmaps;
+			pendingLoad->onLoaded = std::move(onLoaded);
+
+			DEBUG_LOG(LOG::INFO, "Loading Texture in the background: {}", texture.fileName);
+
+			std::shared_ptr<TextureLoad> load = pendingLoad;
+			jobSystem.SubmitBackground([load, &jobSystem]()
+			{
+				load->textureFile = OpenTextureFile(*load->device, load->filePath);
+				if (load->textureFile != nullptr)
+				{
+					load->textureFile->Prefetch();	// The render thread copies the levels out of the mapping, it should not wait on the disk
+				}
+				else
+				{
+					load->pixels = stbi_load(load->filePath.c_str(), &load->width, &load->height, &load->channels, STBI_rgb_alpha);
+				}
+
+				std::weak_ptr<TextureLoad> weakLoad = load;
+				jobSystem.SubmitToMainThread([weakLoad]()
+				{
+					std::shared_ptr<TextureLoad> finishedLoad = weakLoad.lock();
+					if (finishedLoad != nullptr && finishedLoad->texture != nullptr)
+					{
+						finishedLoad->texture->FinishLoad();
+					}
+				});
+			});
+		}
+
 		TextureInstance::~TextureInstance()
 		{
+			if (pendingLoad != nullptr)
+			{
+				pendingLoad->texture = nullptr;
+				if (pendingLoad->uploadingImage != nullptr)
+				{
+					// The transfer may still be writing it
+					pendingLoad->device->GetDeletionQueue().Push(std::move(pendingLoad->uploadingImage));
+				}
+				pendingLoad.reset();
+			}
 			image.reset();
 		}
+
+		uint32_t TextureInstance::GetMipLevels() const
+		{
+			return image != nullptr ? image->GetMipLevels() : 0;
+		}
+
+		void TextureInstance::FinishLoad()
+		{
+			TextureLoad& load = *pendingLoad.get();
+
+			if (load.textureFile == nullptr && load.pixels == nullptr)
+			{
+				DEBUG_LOG(LOG::ERRORLOG, "Failed to load Texture: {}, keeping the placeholder", load.fileName);
+				std::shared_ptr<TextureLoad> failedLoad = std::move(pendingLoad);
+				failedLoad->texture = nullptr;
+				if (failedLoad->onLoaded != nullptr)
+				{
+					failedLoad->onLoaded(*this, false);
+				}
+				return;
+			}
+
+			if (load.textureFile != nullptr)
+			{
+				load.uploadingImage = CreateImage(*load.device, *load.textureFile.get(), load.type, load.bGenerateMipmaps, load.uploadTicket);
+				load.textureFile.reset();	// The levels are in the staging ring now
+			}
+			else
+			{
+				load.uploadingImage = CreateImage(*load.device, load.pixels, static_cast<uint32_t>(load.width), static_cast<uint32_t>(load.height), load.type, load.bGenerateMipmaps, load.uploadTicket);
+				stbi_image_free(load.pixels);
+				load.pixels = nullptr;
+			}
+
+			PollUpload(pendingLoad);
+		}
+
+		void TextureInstance::PollUpload(const std::weak_ptr<TextureLoad>& weakLoad)
+		{
+			// Checked once a frame, like MeshHandler::UpdatePendingMeshes() does for meshes. With a dedicated transfer queue the ticket
+			// only completes after the graphics queue acquired the image and moved it to SHADER_READ_ONLY, until then it must not be sampled
+			std::shared_ptr<TextureLoad> load = weakLoad.lock();
+			load->jobSystem->SubmitToMainThread([weakLoad]()
+			{
+				std::shared_ptr<TextureLoad> uploadingLoad = weakLoad.lock();
+				if (uploadingLoad == nullptr || uploadingLoad->texture == nullptr)
+				{
+					return;
+				}
+
+				if (!uploadingLoad->device->GetUploader().IsComplete(uploadingLoad->uploadTicket))
+				{
+					PollUpload(weakLoad);
+					return;
+				}
+				uploadingLoad->texture->FinishUpload();
+			});
+		}
+
+		void TextureInstance::FinishUpload()
+		{
+			std::shared_ptr<TextureLoad> load = std::move(pendingLoad);
+			load->texture = nullptr;
+
+			// Frames in flight may still sample the placeholder
+			load->device->GetDeletionQueue().Push(std::move(image));
+			image = std::move(load->uploadingImage);
+			bResident = true;
+
+			DEBUG_LOG(LOG::INFO, "Successfully loaded Texture: {} | [{}x{}] {}, {} mip level(s)", load->fileName, image->GetWidth(), image->GetHeight(), string_VkFormat(image->GetVkFormat()), image->GetMipLevels());
+
+			if (load->onLoaded != nullptr)
+			{
+				load->onLoaded(*this, true);
+			}
+		}
 	}
-}
\ No newline at end of file
+}
@@ -5,28 +5,54 @@
 
 #include <vulkan/vulkan_core.h>
 #include <memory>
+#include <cstdint>
+#include <functional>
 
 namespace Baal
 {
+	class JobSystem;
+
 	namespace VK
 	{
 		class LogicalDevice;
 		class Image;
+		class TextureInstance;
+		struct TextureLoad;
 
+		// A .ktx2 or .dds file is uploaded as it is stored, block compressed levels included. Any other file is decoded to RGBA8,
+		// unless BaalTextureCompressor left an up to date copy of it in BAAL_TEXTURE_CACHE_DIR, see TextureFile
 		struct Texture
 		{
 			const char* parentDirectory;
 			const char* fileName;
-			VkImageType type;			
+			VkImageType type;
+			bool bGenerateMipmaps = true;	// Full mip chain, generated on the GPU when the format supports linear blits. Compressed files bring their own, unless a KTX2 file stores a level count of 0
 		};
 
+		// Called on the render thread once the texture replaced its placeholder, or failed to load
+		using TextureLoadedCallback = std::function<void(TextureInstance& texture, const bool bSuccess)>;
+
 		class TextureInstance
 		{
 			friend class TextureHandler;
+			friend class BindlessTable;
 			std::unique_ptr<Image> image;
+			std::shared_ptr<TextureLoad> pendingLoad;	// Shared with the decode job, until FinishLoad()
 			uint32_t id = 0;
+			uint32_t bindlessIndex = UINT32_MAX;	// Slot in the BindlessTable's texture array, while registered
+			bool bResident = false;
+
+			void FinishLoad();
+			static void PollUpload(const std::weak_ptr<TextureLoad>& weakLoad);
+			void FinishUpload();
+
 		public:
+			// Blocks until the texture is decoded and its upload has completed
 			explicit TextureInstance(LogicalDevice& device, const Texture texture);
+
+			// Returns at once with a 1x1 white placeholder image, the file is decoded on a worker thread and uploaded on the render thread
+			// The placeholder stays bound until the upload has completed, it is then replaced and onLoaded is called, owners point their descriptors at the new GetImage()
+			explicit TextureInstance(LogicalDevice& device, JobSystem& jobSystem, const Texture texture, TextureLoadedCallback onLoaded = nullptr);
 			TextureInstance(const TextureInstance&) = delete;
 			TextureInstance(TextureInstance&&) noexcept = delete;
 
@@ -36,8 +62,11 @@ namespace Baal
 			TextureInstance& operator = (TextureInstance&&) = delete;
 
 			Image& GetImage() { return *image.get(); }
+			uint32_t GetMipLevels() const;
+			uint32_t GetBindlessIndex() const { return bindlessIndex; }
+			bool IsResident() const { return bResident; }
 		};
 	}
 }
 
-#endif // !BAAL_VK_Texture_H
\ No newline at end of file
+#endif // !BAAL_VK_Texture_H
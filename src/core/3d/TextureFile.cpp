@@ -0,0 +1,670 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "TextureFile.h"
+
+#include "../src/utility/DebugLog.h"
+#include "../src/utility/Hash.h"
+#include "../src/utility/MappedFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string_view>
+
+namespace Baal
+{
+	namespace VK
+	{
+		namespace
+		{
+			// KTX2, see https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+
+			constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };	// «KTX 20»\r\n\x1A\n
+			constexpr char KTX2_WRITER_KEY[] = "KTXwriter";
+			constexpr char KTX2_SOURCE_PATH_KEY[] = "BaalSourcePath";	// Vendor key, readers skip keys they do not know
+
+			struct KTX2Header
+			{
+				uint8_t identifier[12];
+				uint32_t vkFormat;
+				uint32_t typeSize;
+				uint32_t pixelWidth;
+				uint32_t pixelHeight;
+				uint32_t pixelDepth;
+				uint32_t layerCount;
+				uint32_t faceCount;
+				uint32_t levelCount;
+				uint32_t supercompressionScheme;
+				uint32_t dfdByteOffset;
+				uint32_t dfdByteLength;
+				uint32_t kvdByteOffset;
+				uint32_t kvdByteLength;
+				uint64_t sgdByteOffset;
+				uint64_t sgdByteLength;
+			};
+			static_assert(sizeof(KTX2Header) == 80, "KTX2 header must match the file layout");
+
+			struct KTX2LevelIndex
+			{
+				uint64_t byteOffset;
+				uint64_t byteLength;
+				uint64_t uncompressedByteLength;
+			};
+
+			// Khronos Data Format descriptor values used by the basic descriptor block
+			constexpr uint32_t KHR_DF_MODEL_BC1A = 128;
+			constexpr uint32_t KHR_DF_MODEL_BC3 = 130;
+			constexpr uint32_t KHR_DF_MODEL_BC5 = 132;
+			constexpr uint32_t KHR_DF_MODEL_BC7 = 134;
+			constexpr uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+			constexpr uint32_t KHR_DF_TRANSFER_LINEAR = 1;
+			constexpr uint32_t KHR_DF_TRANSFER_SRGB = 2;
+			constexpr uint32_t KHR_DF_SAMPLE_DATATYPE_LINEAR = 0x10;	// Marks the alpha of an sRGB format as linear
+
+			struct DFDSample
+			{
+				uint32_t bitOffset;
+				uint32_t bitLength;
+				uint32_t channelType;
+			};
+
+			// DDS, see https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dx-graphics-dds-pguide
+
+			constexpr uint32_t DDS_MAGIC = 0x20534444;	// "DDS "
+			constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+			constexpr uint32_t DDPF_FOURCC = 0x4;
+			constexpr uint32_t DDPF_RGB = 0x40;
+			constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200;
+			constexpr uint32_t DDSCAPS2_VOLUME = 0x200000;
+			constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+			constexpr uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+			constexpr uint32_t MakeFourCC(const char a, const char b, const char c, const char d)
+			{
+				return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+			}
+
+			struct DDSPixelFormat
+			{
+				uint32_t size;
+				uint32_t flags;
+				uint32_t fourCC;
+				uint32_t rgbBitCount;
+				uint32_t rBitMask;
+				uint32_t gBitMask;
+				uint32_t bBitMask;
+				uint32_t aBitMask;
+			};
+
+			struct DDSHeader
+			{
+				uint32_t size;
+				uint32_t flags;
+				uint32_t height;
+				uint32_t width;
+				uint32_t pitchOrLinearSize;
+				uint32_t depth;
+				uint32_t mipMapCount;
+				uint32_t reserved1[11];
+				DDSPixelFormat pixelFormat;
+				uint32_t caps;
+				uint32_t caps2;
+				uint32_t caps3;
+				uint32_t caps4;
+				uint32_t reserved2;
+			};
+			static_assert(sizeof(DDSHeader) == 124, "DDS header must match the file layout");
+
+			struct DDSHeaderDX10
+			{
+				uint32_t dxgiFormat;
+				uint32_t resourceDimension;
+				uint32_t miscFlag;
+				uint32_t arraySize;
+				uint32_t miscFlags2;
+			};
+
+			VkFormat FromDXGIFormat(const uint32_t dxgiFormat)
+			{
+				switch (dxgiFormat)
+				{
+				case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+				case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+				case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+				case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+				case 74: return VK_FORMAT_BC2_UNORM_BLOCK;
+				case 75: return VK_FORMAT_BC2_SRGB_BLOCK;
+				case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+				case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+				case 80: return VK_FORMAT_BC4_UNORM_BLOCK;
+				case 81: return VK_FORMAT_BC4_SNORM_BLOCK;
+				case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+				case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+				case 87: return VK_FORMAT_B8G8R8A8_UNORM;
+				case 91: return VK_FORMAT_B8G8R8A8_SRGB;
+				case 95: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+				case 96: return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+				case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+				case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+				default: return VK_FORMAT_UNDEFINED;
+				}
+			}
+
+			// Files without a DX10 header carry no color space, they are read as UNORM like Direct3D does
+			VkFormat FromDDSPixelFormat(const DDSPixelFormat& pixelFormat)
+			{
+				if (pixelFormat.flags & DDPF_FOURCC)
+				{
+					switch (pixelFormat.fourCC)
+					{
+					case MakeFourCC('D', 'X', 'T', '1'): return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+					case MakeFourCC('D', 'X', 'T', '3'): return VK_FORMAT_BC2_UNORM_BLOCK;
+					case MakeFourCC('D', 'X', 'T', '5'): return VK_FORMAT_BC3_UNORM_BLOCK;
+					case MakeFourCC('A', 'T', 'I', '1'):
+					case MakeFourCC('B', 'C', '4', 'U'): return VK_FORMAT_BC4_UNORM_BLOCK;
+					case MakeFourCC('A', 'T', 'I', '2'):
+					case MakeFourCC('B', 'C', '5', 'U'): return VK_FORMAT_BC5_UNORM_BLOCK;
+					default: return VK_FORMAT_UNDEFINED;
+					}
+				}
+
+				if ((pixelFormat.flags & DDPF_RGB) && pixelFormat.rgbBitCount == 32)
+				{
+					if (pixelFormat.rBitMask == 0x000000FF && pixelFormat.gBitMask == 0x0000FF00 && pixelFormat.bBitMask == 0x00FF0000)
+					{
+						return VK_FORMAT_R8G8B8A8_UNORM;
+					}
+					if (pixelFormat.rBitMask == 0x00FF0000 && pixelFormat.gBitMask == 0x0000FF00 && pixelFormat.bBitMask == 0x000000FF)
+					{
+						return VK_FORMAT_B8G8R8A8_UNORM;
+					}
+				}
+				return VK_FORMAT_UNDEFINED;
+			}
+
+			// Bytes per 4x4 block, or per texel for uncompressed formats
+			bool TryGetBlockInfo(const VkFormat format, uint32_t& outBlockSize, uint32_t& outBlockDimension)
+			{
+				switch (format)
+				{
+				case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+				case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+				case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+				case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+				case VK_FORMAT_BC4_UNORM_BLOCK:
+				case VK_FORMAT_BC4_SNORM_BLOCK:
+					outBlockSize = 8;
+					outBlockDimension = 4;
+					return true;
+				case VK_FORMAT_BC2_UNORM_BLOCK:
+				case VK_FORMAT_BC2_SRGB_BLOCK:
+				case VK_FORMAT_BC3_UNORM_BLOCK:
+				case VK_FORMAT_BC3_SRGB_BLOCK:
+				case VK_FORMAT_BC5_UNORM_BLOCK:
+				case VK_FORMAT_BC5_SNORM_BLOCK:
+				case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+				case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+				case VK_FORMAT_BC7_UNORM_BLOCK:
+				case VK_FORMAT_BC7_SRGB_BLOCK:
+					outBlockSize = 16;
+					outBlockDimension = 4;
+					return true;
+				case VK_FORMAT_R8G8B8A8_UNORM:
+				case VK_FORMAT_R8G8B8A8_SRGB:
+				case VK_FORMAT_B8G8R8A8_UNORM:
+				case VK_FORMAT_B8G8R8A8_SRGB:
+					outBlockSize = 4;
+					outBlockDimension = 1;
+					return true;
+				default:
+					return false;
+				}
+			}
+
+			// Basic data format descriptor of the formats BaalTextureCompressor writes, KTX2 readers need it to interpret the data
+			bool TryBuildDataFormatDescriptor(const VkFormat format, std::vector<uint32_t>& outDescriptor)
+			{
+				uint32_t colorModel = 0;
+				bool bSRGB = false;
+				std::vector<DFDSample> samples;
+				switch (format)
+				{
+				case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+					bSRGB = true;
+					[[fallthrough]];
+				case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+					colorModel = KHR_DF_MODEL_BC1A;
+					samples = { { 0, 64, 0 } };
+					break;
+				case VK_FORMAT_BC3_SRGB_BLOCK:
+					bSRGB = true;
+					[[fallthrough]];
+				case VK_FORMAT_BC3_UNORM_BLOCK:
+					colorModel = KHR_DF_MODEL_BC3;
+					samples = { { 0, 64, 15 | (bSRGB ? KHR_DF_SAMPLE_DATATYPE_LINEAR : 0) }, { 64, 64, 0 } };	// Alpha block first
+					break;
+				case VK_FORMAT_BC5_UNORM_BLOCK:
+					colorModel = KHR_DF_MODEL_BC5;
+					samples = { { 0, 64, 0 }, { 64, 64, 1 } };	// Red, then green
+					break;
+				case VK_FORMAT_BC7_SRGB_BLOCK:
+					bSRGB = true;
+					[[fallthrough]];
+				case VK_FORMAT_BC7_UNORM_BLOCK:
+					colorModel = KHR_DF_MODEL_BC7;
+					samples = { { 0, 128, 0 } };
+					break;
+				default:
+					return false;
+				}
+
+				uint32_t blockSize = 0;
+				uint32_t blockDimension = 0;
+				TryGetBlockInfo(format, blockSize, blockDimension);
+
+				const uint32_t descriptorBlockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+				outDescriptor.clear();
+				outDescriptor.push_back(4 + descriptorBlockSize);	// Total size, including this word
+				outDescriptor.push_back(0);	// Khronos vendor, basic descriptor type
+				outDescriptor.push_back(2 | (descriptorBlockSize << 16));	// Version 2
+				outDescriptor.push_back(colorModel | (KHR_DF_PRIMARIES_BT709 << 8) | ((bSRGB ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR) << 16));
+				outDescriptor.push_back((blockDimension - 1) | ((blockDimension - 1) << 8));
+				outDescriptor.push_back(blockSize);
+				outDescriptor.push_back(0);
+				for (const DFDSample& sample : samples)
+				{
+					outDescriptor.push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channelType << 24));
+					outDescriptor.push_back(0);
+					outDescriptor.push_back(0);
+					outDescriptor.push_back(UINT32_MAX);
+				}
+				return true;
+			}
+
+			// Checked before the level count sizes anything, it comes straight from the file. A 1x1 level is reached within 32 levels,
+			// so the check also keeps the size shifts below 32 bits
+			bool IsValidLevelCount(const uint32_t width, const uint32_t height, const uint32_t levelCount)
+			{
+				return width != 0 && height != 0 && levelCount >= 1 && levelCount <= 32 && (std::max(width, height) >> (levelCount - 1)) != 0;
+			}
+
+			uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+			{
+				return (value + alignment - 1) / alignment * alignment;
+			}
+
+			// Entries are a byte length, then the key and the value, both null terminated, padded to 4 bytes
+			void AppendKeyValue(std::vector<char>& keyValueData, const std::string_view key, const std::string& value)
+			{
+				const uint32_t keyAndValueByteLength = static_cast<uint32_t>(key.size() + 1 + value.size() + 1);
+				const size_t entryOffset = keyValueData.size();
+				keyValueData.resize(entryOffset + sizeof(uint32_t));
+				std::memcpy(keyValueData.data() + entryOffset, &keyAndValueByteLength, sizeof(uint32_t));
+				keyValueData.insert(keyValueData.end(), key.begin(), key.end());
+				keyValueData.push_back('\0');
+				keyValueData.insert(keyValueData.end(), value.begin(), value.end());
+				keyValueData.push_back('\0');
+				keyValueData.resize(AlignUp(keyValueData.size(), 4), 0);
+			}
+
+			void WritePadding(std::ofstream& file, const uint64_t offset, const uint64_t alignedOffset)
+			{
+				static const char zeros[16] = {};
+				file.write(zeros, static_cast<std::streamsize>(alignedOffset - offset));
+			}
+		}
+
+		TextureFile::TextureFile(const std::string& filePath)
+		{
+			file = std::make_unique<MappedFile>(filePath);
+			if (!file->IsValid())
+			{
+				return;
+			}
+
+			const bool bParsed = file->GetSize() >= sizeof(KTX2_IDENTIFIER) && std::memcmp(file->GetData(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0 ?
+				ParseKTX2(filePath) :
+				ParseDDS(filePath);
+
+			if (!bParsed)
+			{
+				format = VK_FORMAT_UNDEFINED;
+				levels.clear();
+			}
+		}
+
+		TextureFile::~TextureFile()
+		{
+			file.reset();
+		}
+
+		bool TextureFile::WriteKTX2(const std::string& filePath, const VkFormat format, const uint32_t width, const uint32_t height, const std::vector<std::vector<uint8_t>>& levels, const std::string& sourcePath /*= std::string()*/)
+		{
+			std::vector<uint32_t> dataFormatDescriptor;
+			if (!TryBuildDataFormatDescriptor(format, dataFormatDescriptor) || levels.empty())
+			{
+				DEBUG_LOG(LOG::WARNING, "Failed to write texture file: {}, Unsupported format", filePath);
+				return false;
+			}
+
+			const uint32_t levelCount = static_cast<uint32_t>(levels.size());
+			if (levels.size() > UINT32_MAX || !IsValidLevelCount(width, height, levelCount))
+			{
+				DEBUG_LOG(LOG::WARNING, "Failed to write texture file: {}, Invalid level count {}", filePath, levels.size());
+				return false;
+			}
+
+			for (uint32_t level = 0; level < levelCount; ++level)
+			{
+				if (levels[level].size() != GetLevelSize(format, std::max(width >> level, 1u), std::max(height >> level, 1u)))
+				{
+					DEBUG_LOG(LOG::WARNING, "Failed to write texture file: {}, Level {} has the wrong size", filePath, level);
+					return false;
+				}
+			}
+
+			// Keys are sorted by their bytes, as the KTX2 spec requires
+			std::vector<char> keyValueData;
+			if (!sourcePath.empty())
+			{
+				AppendKeyValue(keyValueData, KTX2_SOURCE_PATH_KEY, NormalizeSourcePath(sourcePath));
+			}
+			AppendKeyValue(keyValueData, KTX2_WRITER_KEY, "Baal");
+
+			KTX2Header header{};
+			std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+			header.vkFormat = static_cast<uint32_t>(format);
+			header.typeSize = 1;
+			header.pixelWidth = width;
+			header.pixelHeight = height;
+			header.faceCount = 1;
+			header.levelCount = levelCount;
+			header.dfdByteOffset = static_cast<uint32_t>(sizeof(KTX2Header) + sizeof(KTX2LevelIndex) * levelCount);
+			header.dfdByteLength = static_cast<uint32_t>(dataFormatDescriptor.size() * sizeof(uint32_t));
+			header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+			header.kvdByteLength = static_cast<uint32_t>(keyValueData.size());
+
+			// Levels are stored smallest first, each one aligned to the texel block size
+			uint32_t blockSize = 0;
+			uint32_t blockDimension = 0;
+			TryGetBlockInfo(format, blockSize, blockDimension);
+			const uint64_t levelAlignment = std::max(blockSize, 4u);
+
+			std::vector<KTX2LevelIndex> levelIndex(levelCount);
+			uint64_t offset = header.kvdByteOffset + header.kvdByteLength;
+			for (uint32_t level = levelCount; level-- > 0;)
+			{
+				offset = AlignUp(offset, levelAlignment);
+				levelIndex[level].byteOffset = offset;
+				levelIndex[level].byteLength = levels[level].size();
+				levelIndex[level].uncompressedByteLength = levels[level].size();
+				offset += levels[level].size();
+			}
+
+			std::error_code error;
+			std::filesystem::create_directories(std::filesystem::path(filePath).parent_path(), error);
+
+			std::filesystem::path tempPath = filePath;
+			tempPath += ".tmp";
+
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+				{
+					DEBUG_LOG(LOG::WARNING, "Failed to write texture file: {}", filePath);
+					return false;
+				}
+
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(reinterpret_cast<const char*>(levelIndex.data()), sizeof(KTX2LevelIndex) * levelIndex.size());
+				file.write(reinterpret_cast<const char*>(dataFormatDescriptor.data()), header.dfdByteLength);
+				file.write(keyValueData.data(), header.kvdByteLength);
+
+				uint64_t written = header.kvdByteOffset + header.kvdByteLength;
+				for (uint32_t level = levelCount; level-- > 0;)
+				{
+					WritePadding(file, written, levelIndex[level].byteOffset);
+					file.write(reinterpret_cast<const char*>(levels[level].data()), static_cast<std::streamsize>(levels[level].size()));
+					written = levelIndex[level].byteOffset + levels[level].size();
+				}
+
+				if (!file)
+				{
+					DEBUG_LOG(LOG::WARNING, "Failed to write texture file: {}", filePath);
+					return false;
+				}
+			}
+
+			std::filesystem::rename(tempPath, filePath, error);
+			if (error)
+			{
+				DEBUG_LOG(LOG::WARNING, "Failed to write texture file: {}, Error: {}", filePath, error.message());
+				return false;
+			}
+			return true;
+		}
+
+		bool TextureFile::IsContainer(const std::string& filePath)
+		{
+			std::string extension = std::filesystem::path(filePath).extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return extension == ".ktx2" || extension == ".dds";
+		}
+
+		std::string TextureFile::NormalizeSourcePath(const std::string& sourcePath)
+		{
+			std::error_code error;
+			const std::filesystem::path path = std::filesystem::weakly_canonical(std::filesystem::absolute(sourcePath, error), error);
+			return error ? std::filesystem::path(sourcePath).lexically_normal().generic_string() : path.generic_string();
+		}
+
+		std::string TextureFile::GetCacheFileName(const std::string& sourcePath)
+		{
+			return std::format("{:016x}.ktx2", HashFNV1a(NormalizeSourcePath(sourcePath)));
+		}
+
+		uint64_t TextureFile::GetLevelSize(const VkFormat format, const uint32_t width, const uint32_t height)
+		{
+			uint32_t blockSize = 0;
+			uint32_t blockDimension = 0;
+			if (!TryGetBlockInfo(format, blockSize, blockDimension))
+			{
+				return 0;
+			}
+
+			const uint64_t blocksX = (static_cast<uint64_t>(width) + blockDimension - 1) / blockDimension;
+			const uint64_t blocksY = (static_cast<uint64_t>(height) + blockDimension - 1) / blockDimension;
+			return blocksX * blocksY * blockSize;
+		}
+
+		void TextureFile::Prefetch() const
+		{
+			file->Prefetch();
+		}
+
+		bool TextureFile::ParseKTX2(const std::string& filePath)
+		{
+			const uint8_t* data = file->GetData();
+			const uint64_t size = file->GetSize();
+
+			if (size < sizeof(KTX2Header))
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring truncated texture file: {}", filePath);
+				return false;
+			}
+
+			const KTX2Header* header = reinterpret_cast<const KTX2Header*>(data);
+			if (header->supercompressionScheme != 0)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, Supercompressed KTX2 files are not supported", filePath);
+				return false;
+			}
+
+			if (header->pixelHeight == 0 || header->pixelDepth != 0 || header->layerCount > 1 || header->faceCount != 1)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, Only 2D textures are supported", filePath);
+				return false;
+			}
+
+			const VkFormat fileFormat = static_cast<VkFormat>(header->vkFormat);
+			if (GetLevelSize(fileFormat, 1, 1) == 0)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, Unsupported format {}", filePath, header->vkFormat);
+				return false;
+			}
+
+			// A level count of 0 asks the loader to generate the mips, the file holds only the base level
+			bGenerateMipmaps = header->levelCount == 0;
+			const uint32_t levelCount = std::max(header->levelCount, 1u);
+			if (!IsValidLevelCount(header->pixelWidth, header->pixelHeight, levelCount))
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring corrupt texture file: {}", filePath);
+				return false;
+			}
+
+			if (sizeof(KTX2Header) + sizeof(KTX2LevelIndex) * static_cast<uint64_t>(levelCount) > size)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring truncated texture file: {}", filePath);
+				return false;
+			}
+
+			const KTX2LevelIndex* levelIndex = reinterpret_cast<const KTX2LevelIndex*>(data + sizeof(KTX2Header));
+			std::vector<uint64_t> offsets(levelCount);
+			for (uint32_t level = 0; level < levelCount; ++level)
+			{
+				if (levelIndex[level].byteLength != GetLevelSize(fileFormat, std::max(header->pixelWidth >> level, 1u), std::max(header->pixelHeight >> level, 1u)))
+				{
+					DEBUG_LOG(LOG::WARNING, "Ignoring corrupt texture file: {}", filePath);
+					return false;
+				}
+				offsets[level] = levelIndex[level].byteOffset;
+			}
+
+			ParseKeyValueData(header->kvdByteOffset, header->kvdByteLength);
+
+			format = fileFormat;
+			return AddLevels(filePath, header->pixelWidth, header->pixelHeight, levelCount, offsets.data());
+		}
+
+		void TextureFile::ParseKeyValueData(const uint64_t offset, const uint64_t length)
+		{
+			if (offset > file->GetSize() || length > file->GetSize() - offset)
+			{
+				return;
+			}
+
+			const char* keyValueData = reinterpret_cast<const char*>(file->GetData() + offset);
+			uint64_t entryOffset = 0;
+			while (entryOffset + sizeof(uint32_t) <= length)
+			{
+				uint32_t keyAndValueByteLength = 0;
+				std::memcpy(&keyAndValueByteLength, keyValueData + entryOffset, sizeof(uint32_t));
+				entryOffset += sizeof(uint32_t);
+				if (keyAndValueByteLength > length - entryOffset)
+				{
+					return;
+				}
+
+				// Both the key and the value are null terminated, the value's terminator is dropped from the string
+				const std::string_view entry(keyValueData + entryOffset, keyAndValueByteLength);
+				const size_t keyEnd = entry.find('\0');
+				if (keyEnd != std::string_view::npos && entry.substr(0, keyEnd) == KTX2_SOURCE_PATH_KEY)
+				{
+					const std::string_view value = entry.substr(keyEnd + 1);
+					sourcePath = std::string(value.substr(0, value.find('\0')));
+				}
+				entryOffset = AlignUp(entryOffset + keyAndValueByteLength, 4);
+			}
+		}
+
+		bool TextureFile::ParseDDS(const std::string& filePath)
+		{
+			const uint8_t* data = file->GetData();
+			const uint64_t size = file->GetSize();
+
+			if (size < sizeof(uint32_t) + sizeof(DDSHeader) || *reinterpret_cast<const uint32_t*>(data) != DDS_MAGIC)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, Not a KTX2 or DDS file", filePath);
+				return false;
+			}
+
+			const DDSHeader* header = reinterpret_cast<const DDSHeader*>(data + sizeof(uint32_t));
+			if ((header->caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) != 0)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, Only 2D textures are supported", filePath);
+				return false;
+			}
+
+			uint64_t dataOffset = sizeof(uint32_t) + sizeof(DDSHeader);
+			VkFormat fileFormat = VK_FORMAT_UNDEFINED;
+			if ((header->pixelFormat.flags & DDPF_FOURCC) && header->pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0'))
+			{
+				if (size < dataOffset + sizeof(DDSHeaderDX10))
+				{
+					DEBUG_LOG(LOG::WARNING, "Ignoring truncated texture file: {}", filePath);
+					return false;
+				}
+
+				const DDSHeaderDX10* headerDX10 = reinterpret_cast<const DDSHeaderDX10*>(data + dataOffset);
+				if (headerDX10->resourceDimension != DDS_DIMENSION_TEXTURE2D || headerDX10->arraySize > 1 || (headerDX10->miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) != 0)
+				{
+					DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, Only 2D textures are supported", filePath);
+					return false;
+				}
+
+				fileFormat = FromDXGIFormat(headerDX10->dxgiFormat);
+				dataOffset += sizeof(DDSHeaderDX10);
+			}
+			else
+			{
+				fileFormat = FromDDSPixelFormat(header->pixelFormat);
+			}
+
+			if (fileFormat == VK_FORMAT_UNDEFINED)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring texture file: {}, Unsupported format", filePath);
+				return false;
+			}
+
+			// Levels follow the headers back to back, largest first
+			const uint32_t levelCount = (header->flags & DDSD_MIPMAPCOUNT) ? std::max(header->mipMapCount, 1u) : 1;
+			if (!IsValidLevelCount(header->width, header->height, levelCount))
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring corrupt texture file: {}", filePath);
+				return false;
+			}
+
+			std::vector<uint64_t> offsets(levelCount);
+			for (uint32_t level = 0; level < levelCount; ++level)
+			{
+				offsets[level] = dataOffset;
+				dataOffset += GetLevelSize(fileFormat, std::max(header->width >> level, 1u), std::max(header->height >> level, 1u));
+			}
+
+			format = fileFormat;
+			return AddLevels(filePath, header->width, header->height, levelCount, offsets.data());
+		}
+
+		bool TextureFile::AddLevels(const std::string& filePath, const uint32_t width, const uint32_t height, const uint32_t levelCount, const uint64_t* offsets)
+		{
+			levels.resize(levelCount);
+			for (uint32_t level = 0; level < levelCount; ++level)
+			{
+				TextureFileLevel& fileLevel = levels[level];
+				fileLevel.width = std::max(width >> level, 1u);
+				fileLevel.height = std::max(height >> level, 1u);
+				fileLevel.size = GetLevelSize(format, fileLevel.width, fileLevel.height);
+				if (offsets[level] > file->GetSize() || fileLevel.size > file->GetSize() - offsets[level])
+				{
+					DEBUG_LOG(LOG::WARNING, "Ignoring truncated texture file: {}", filePath);
+					return false;
+				}
+				fileLevel.data = file->GetData() + offsets[level];
+			}
+			return true;
+		}
+	}
+}
@@ -0,0 +1,95 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_TEXTURE_FILE_H
+#define BAAL_VK_TEXTURE_FILE_H
+
+#include <vulkan/vulkan_core.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Where BaalTextureCompressor writes compressed copies of the source textures, the build points this at the build directory
+#ifndef BAAL_TEXTURE_CACHE_DIR
+#define BAAL_TEXTURE_CACHE_DIR "cache/textures/"
+#endif // !BAAL_TEXTURE_CACHE_DIR
+
+namespace Baal
+{
+	class MappedFile;
+
+	namespace VK
+	{
+		struct TextureFileLevel
+		{
+			const uint8_t* data{ nullptr };	// Into the mapping
+			uint64_t size = 0;
+			uint32_t width = 0;
+			uint32_t height = 0;
+		};
+
+		// Pre-compressed 2D texture in a KTX2 or DDS container, memory mapped so every mip level is uploaded straight from the file
+		// Only formats the level sizes can be validated for are accepted: BC1 to BC7 and 8 bit RGBA. KTX2 supercompression is not supported
+		class TextureFile
+		{
+		public:
+			// Maps the file and parses its header, check IsValid() before reading
+			explicit TextureFile(const std::string& filePath);
+			TextureFile(const TextureFile&) = delete;
+			TextureFile(TextureFile&&) = delete;
+
+			~TextureFile();
+
+			TextureFile& operator=(const TextureFile&) = delete;
+			TextureFile& operator = (TextureFile&&) = delete;
+
+			// Levels are ordered largest first. Written to a temporary file first, so a concurrent reader never maps a partially written file
+			// A source path is normalized and stored in the key/value data, so a cache file can be checked against the texture it was made from
+			static bool WriteKTX2(const std::string& filePath, const VkFormat format, const uint32_t width, const uint32_t height, const std::vector<std::vector<uint8_t>>& levels, const std::string& sourcePath = std::string());
+
+			// By extension, .ktx2 or .dds
+			static bool IsContainer(const std::string& filePath);
+
+			// Absolute path with . and .. resolved, the tool and the renderer spell the same texture differently relative to their working directories
+			static std::string NormalizeSourcePath(const std::string& sourcePath);
+
+			// Name BaalTextureCompressor gives the compressed copy of a source texture in the cache, a hash of the normalized source path
+			// Textures with the same name in different directories, or with different extensions, get their own cache files
+			static std::string GetCacheFileName(const std::string& sourcePath);
+
+			// Size of one level in bytes, 0 for formats a TextureFile does not accept
+			static uint64_t GetLevelSize(const VkFormat format, const uint32_t width, const uint32_t height);
+
+			bool IsValid() const { return format != VK_FORMAT_UNDEFINED; }
+
+			// Faults the whole mapping in on the calling thread, see MappedFile::Prefetch()
+			void Prefetch() const;
+
+			VkFormat GetFormat() const { return format; }
+			uint32_t GetWidth() const { return levels[0].width; }
+			uint32_t GetHeight() const { return levels[0].height; }
+			uint32_t GetMipLevels() const { return static_cast<uint32_t>(levels.size()); }
+			const TextureFileLevel& GetLevel(const uint32_t level) const { return levels[level]; }
+
+			// A KTX2 level count of 0, the file holds only the base level and leaves the rest of the chain to the loader
+			bool ShouldGenerateMipmaps() const { return bGenerateMipmaps; }
+
+			// Normalized path of the texture the file was compressed from, empty when the file does not record one
+			const std::string& GetSourcePath() const { return sourcePath; }
+
+		private:
+			std::unique_ptr<MappedFile> file;
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			std::vector<TextureFileLevel> levels;
+			std::string sourcePath;
+			bool bGenerateMipmaps = false;
+
+			bool ParseKTX2(const std::string& filePath);
+			void ParseKeyValueData(const uint64_t offset, const uint64_t length);
+			bool ParseDDS(const std::string& filePath);
+			bool AddLevels(const std::string& filePath, const uint32_t width, const uint32_t height, const uint32_t levelCount, const uint64_t* offsets);
+		};
+	}
+}
+
+#endif // !BAAL_VK_TEXTURE_FILE_H
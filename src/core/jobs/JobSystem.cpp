@@ -0,0 +1,336 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "JobSystem.h"
+
+#include "../src/utility/DebugLog.h"
+
+#include <algorithm>
+
+namespace Baal
+{
+	namespace
+	{
+		// Which queue the current thread owns, only set on worker threads
+		thread_local const JobSystem* currentJobSystem = nullptr;
+		thread_local uint32_t currentQueueIndex = 0;
+	}
+
+	JobSystem::JobSystem(const uint32_t workerCount /*= 0*/)
+	{
+		const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+		const uint32_t threadCount = workerCount > 0 ? workerCount : hardwareThreads - 1;
+
+		queues.reserve(threadCount + 1);
+		for (uint32_t i = 0; i < threadCount + 1; ++i)
+		{
+			queues.push_back(std::make_unique<WorkQueue>());
+		}
+
+		workers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i)
+		{
+			workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+		}
+
+		DEBUG_LOG(LOG::INFO, "Created job system with {} worker thread(s)", threadCount);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			bStopping = true;
+		}
+		wakeCondition.notify_all();
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+
+		for (std::unique_ptr<WorkQueue>& queue : queues)
+		{
+			queue->jobs.clear();
+		}
+		backgroundQueue.jobs.clear();
+
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		mainThreadJobs.clear();
+	}
+
+	void JobSystem::Submit(Job job, JobCounter* counter /*= nullptr*/)
+	{
+		if (counter != nullptr)
+		{
+			counter->count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		QueuedJob queuedJob;
+		queuedJob.job = std::move(job);
+		queuedJob.counter = counter;
+		Push(std::move(queuedJob));
+	}
+
+	void JobSystem::SubmitAfter(JobCounter& dependency, Job job, JobCounter* counter /*= nullptr*/)
+	{
+		if (counter != nullptr)
+		{
+			counter->count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		QueuedJob queuedJob;
+		queuedJob.job = std::move(job);
+		queuedJob.counter = counter;
+
+		{
+			// FinishJob() takes the same lock before the count reaches zero, so the job is either deferred or the dependency is already done
+			std::lock_guard<std::mutex> lock(dependency.mutex);
+			if (dependency.count.load(std::memory_order_acquire) > 0)
+			{
+				dependency.deferredJobs.push_back({ std::move(queuedJob.job), queuedJob.counter });
+				return;
+			}
+		}
+
+		Push(std::move(queuedJob));
+	}
+
+	void JobSystem::SubmitBackground(Job job, JobCounter* counter /*= nullptr*/)
+	{
+		if (counter != nullptr)
+		{
+			counter->count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		unfinishedJobCount.fetch_add(1, std::memory_order_relaxed);
+		queuedJobCount.fetch_add(1, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(backgroundQueue.mutex);
+			backgroundQueue.jobs.push_back({ std::move(job), counter });
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeCondition.notify_one();
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		const uint32_t queueIndex = GetQueueIndex();
+		while (counter.count.load(std::memory_order_acquire) > 0)
+		{
+			if (!TryRunJob(queueIndex, false))
+			{
+				// The remaining jobs are running on other threads
+				std::this_thread::yield();
+			}
+		}
+
+		// The thread that finished the last job may still hold the lock, the counter must not be destroyed before it lets go
+		std::lock_guard<std::mutex> lock(counter.mutex);
+	}
+
+	void JobSystem::ParallelFor(const uint32_t itemCount, const uint32_t minBatchSize, const ParallelForFunction& function)
+	{
+		if (itemCount == 0)
+		{
+			return;
+		}
+
+		const uint32_t batchSize = std::max(minBatchSize, 1u);
+		const uint32_t maxBatches = GetThreadCount() * BAAL_PARALLEL_FOR_BATCHES_PER_THREAD;
+		const uint32_t batchCount = std::min((itemCount + batchSize - 1) / batchSize, maxBatches);
+		const uint32_t itemsPerBatch = (itemCount + batchCount - 1) / batchCount;
+
+		// The calling thread runs the first batch itself instead of idling while it waits
+		JobCounter counter;
+		for (uint32_t batch = 1; batch < batchCount; ++batch)
+		{
+			const uint32_t begin = batch * itemsPerBatch;
+			const uint32_t end = std::min(begin + itemsPerBatch, itemCount);
+			if (begin < end)
+			{
+				Submit([&function, begin, end]() { function(begin, end); }, &counter);
+			}
+		}
+
+		function(0, std::min(itemsPerBatch, itemCount));
+		Wait(counter);
+	}
+
+	void JobSystem::SubmitToMainThread(Job job)
+	{
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		mainThreadJobs.push_back(std::move(job));
+	}
+
+	void JobSystem::RunMainThreadJobs()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mainThreadMutex);
+			std::swap(mainThreadJobs, runningMainThreadJobs);
+		}
+
+		for (Job& job : runningMainThreadJobs)
+		{
+			job();
+		}
+		runningMainThreadJobs.clear();
+	}
+
+	void JobSystem::WaitIdle()
+	{
+		const uint32_t queueIndex = GetQueueIndex();
+		while (unfinishedJobCount.load(std::memory_order_acquire) > 0)
+		{
+			if (!TryRunJob(queueIndex, true))
+			{
+				// The remaining jobs are running on other threads
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	bool JobSystem::HasUnfinishedJobs()
+	{
+		if (unfinishedJobCount.load(std::memory_order_acquire) > 0)
+		{
+			return true;
+		}
+
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		return !mainThreadJobs.empty();
+	}
+
+	void JobSystem::WorkerLoop(const uint32_t queueIndex)
+	{
+		currentJobSystem = this;
+		currentQueueIndex = queueIndex;
+
+		while (true)
+		{
+			if (TryRunJob(queueIndex, true))
+			{
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wakeCondition.wait(lock, [this]() { return bStopping || queuedJobCount.load(std::memory_order_acquire) > 0; });
+			if (bStopping)
+			{
+				return;
+			}
+		}
+	}
+
+	void JobSystem::Push(QueuedJob queuedJob)
+	{
+		// Counted before it is visible, so a thief can never take the count below zero
+		unfinishedJobCount.fetch_add(1, std::memory_order_relaxed);
+		queuedJobCount.fetch_add(1, std::memory_order_release);
+
+		WorkQueue& queue = *queues[GetQueueIndex()].get();
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(std::move(queuedJob));
+		}
+
+		// Taking the lock orders the wake up after a sleeping worker checked queuedJobCount, so it cannot be missed
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeCondition.notify_one();
+	}
+
+	bool JobSystem::TryRunJob(const uint32_t queueIndex, const bool bAllowBackground)
+	{
+		QueuedJob queuedJob;
+		bool bFound = false;
+
+		// Newest first from the own queue, its data is most likely still in cache
+		{
+			WorkQueue& queue = *queues[queueIndex].get();
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty())
+			{
+				queuedJob = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+				bFound = true;
+			}
+		}
+
+		// Oldest first from everyone else, older jobs tend to be the larger ones that split further
+		const uint32_t queueCount = static_cast<uint32_t>(queues.size());
+		for (uint32_t offset = 1; !bFound && offset < queueCount; ++offset)
+		{
+			WorkQueue& queue = *queues[(queueIndex + offset) % queueCount].get();
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty())
+			{
+				queuedJob = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				bFound = true;
+			}
+		}
+
+		if (!bFound && bAllowBackground)
+		{
+			std::lock_guard<std::mutex> lock(backgroundQueue.mutex);
+			if (!backgroundQueue.jobs.empty())
+			{
+				queuedJob = std::move(backgroundQueue.jobs.front());
+				backgroundQueue.jobs.pop_front();
+				bFound = true;
+			}
+		}
+
+		if (!bFound)
+		{
+			return false;
+		}
+
+		RunJob(queuedJob);
+		return true;
+	}
+
+	void JobSystem::RunJob(QueuedJob& queuedJob)
+	{
+		queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+		queuedJob.job();
+
+		if (queuedJob.counter != nullptr)
+		{
+			FinishJob(*queuedJob.counter);
+		}
+
+		// After FinishJob(), which counts the jobs it releases before this one stops counting
+		unfinishedJobCount.fetch_sub(1, std::memory_order_release);
+	}
+
+	void JobSystem::FinishJob(JobCounter& counter)
+	{
+		std::vector<JobCounter::DeferredJob> deferredJobs;
+		{
+			std::lock_guard<std::mutex> lock(counter.mutex);
+			if (counter.count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				std::swap(deferredJobs, counter.deferredJobs);
+			}
+		}
+
+		// The counter may already be gone, only the jobs moved out of it are touched
+		for (JobCounter::DeferredJob& deferredJob : deferredJobs)
+		{
+			QueuedJob queuedJob;
+			queuedJob.job = std::move(deferredJob.job);
+			queuedJob.counter = deferredJob.counter;
+			Push(std::move(queuedJob));
+		}
+	}
+
+	uint32_t JobSystem::GetQueueIndex() const
+	{
+		return currentJobSystem == this ? currentQueueIndex : 0;
+	}
+}
@@ -0,0 +1,141 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_JOB_SYSTEM_H
+#define BAAL_JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef BAAL_PARALLEL_FOR_BATCHES_PER_THREAD
+#define BAAL_PARALLEL_FOR_BATCHES_PER_THREAD 4	// More batches than threads, so stealing can even out uneven batches
+#endif // !BAAL_PARALLEL_FOR_BATCHES_PER_THREAD
+
+namespace Baal
+{
+	using Job = std::function<void()>;
+
+	// Runs [begin, end) of a ParallelFor()
+	using ParallelForFunction = std::function<void(const uint32_t begin, const uint32_t end)>;
+
+	// Counts the unfinished jobs submitted with it, see JobSystem::Wait() and JobSystem::SubmitAfter()
+	// Must outlive its jobs, Wait() on it before it goes out of scope
+	class JobCounter
+	{
+		friend class JobSystem;
+
+		struct DeferredJob
+		{
+			Job job;
+			JobCounter* counter;
+		};
+
+		std::atomic<uint32_t> count{ 0 };
+		std::mutex mutex;	// Guards deferredJobs, and is held while the last job finishes so Wait() cannot return early
+		std::vector<DeferredJob> deferredJobs;	// Submitted once count reaches zero
+
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter(JobCounter&&) = delete;
+
+		JobCounter& operator=(const JobCounter&) = delete;
+		JobCounter& operator = (JobCounter&&) = delete;
+
+		bool IsDone() const { return count.load(std::memory_order_acquire) == 0; }
+	};
+
+	// Work stealing scheduler, the renderer's stages and background work such as asset loading run on it
+	// Every worker owns a deque, it pushes and pops its own jobs at the back and steals from the front of the others when it runs dry.
+	// Threads that are not workers submit into a shared deque the workers steal from, and help run jobs while they Wait()
+	//
+	// Vulkan calls that touch queues, pools or the Uploader belong to the thread that calls Renderer::Render(),
+	// jobs hand that part back with SubmitToMainThread() and it runs at the start of the next frame
+	class JobSystem
+	{
+	public:
+		// 0 uses every hardware thread but the main thread's
+		explicit JobSystem(const uint32_t workerCount = 0);
+		JobSystem(const JobSystem&) = delete;
+		JobSystem(JobSystem&&) = delete;
+
+		// Queued jobs are finished before the workers join, main thread jobs that have not run are dropped
+		~JobSystem();
+
+		JobSystem& operator=(const JobSystem&) = delete;
+		JobSystem& operator = (JobSystem&&) = delete;
+
+		// Thread safe. The counter, if any, is incremented before this returns and decremented once the job has run
+		void Submit(Job job, JobCounter* counter = nullptr);
+
+		// Thread safe. Holds the job back until every job of the dependency has finished
+		void SubmitAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+
+		// Thread safe. For long running work such as file I/O and decoding, only picked up by idle workers and never by Wait(),
+		// so the render thread never ends up running a load while it waits on its own jobs
+		void SubmitBackground(Job job, JobCounter* counter = nullptr);
+
+		// Runs other jobs on the calling thread until the counter reaches zero, never runs main thread jobs
+		void Wait(JobCounter& counter);
+
+		// Splits [0, itemCount) into batches of at least minBatchSize items, runs them across the workers and the calling thread, and waits for them
+		void ParallelFor(const uint32_t itemCount, const uint32_t minBatchSize, const ParallelForFunction& function);
+
+		// Thread safe
+		void SubmitToMainThread(Job job);
+
+		// Main thread only, runs every main thread job submitted so far. Jobs they submit run on the next call
+		void RunMainThreadJobs();
+
+		// Runs jobs on the calling thread, background jobs included, until every job has finished. Main thread jobs are left queued
+		void WaitIdle();
+
+		// Thread safe. Whether a job or main thread job has not finished yet
+		bool HasUnfinishedJobs();
+
+		uint32_t GetWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+		uint32_t GetThreadCount() const { return GetWorkerCount() + 1; }	// Workers and the main thread
+
+	private:
+		struct QueuedJob
+		{
+			Job job;
+			JobCounter* counter{ nullptr };
+		};
+
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<QueuedJob> jobs;
+		};
+
+		void WorkerLoop(const uint32_t queueIndex);
+		void Push(QueuedJob queuedJob);
+		bool TryRunJob(const uint32_t queueIndex, const bool bAllowBackground);
+		void RunJob(QueuedJob& queuedJob);
+		void FinishJob(JobCounter& counter);
+		uint32_t GetQueueIndex() const;
+
+		std::vector<std::thread> workers;
+		std::vector<std::unique_ptr<WorkQueue>> queues;	// 0 is shared by every thread that is not a worker, worker i owns i + 1
+		WorkQueue backgroundQueue;
+
+		std::atomic<uint32_t> queuedJobCount{ 0 };
+		std::atomic<uint32_t> unfinishedJobCount{ 0 };	// Queued or running, see WaitIdle()
+		std::mutex sleepMutex;
+		std::condition_variable wakeCondition;
+		bool bStopping = false;
+
+		std::mutex mainThreadMutex;
+		std::vector<Job> mainThreadJobs;
+		std::vector<Job> runningMainThreadJobs;	// Swapped with mainThreadJobs, so jobs run without holding the lock
+	};
+}
+
+#endif // !BAAL_JOB_SYSTEM_H
@@ -10,24 +10,69 @@
 #include "../src/core/vulkan/presentation/SwapChain.h"
 #include "../src/core/vulkan/commands/CommandPool.h"
 #include "../src/core/vulkan/commands/CommandBuffer.h"
+#include "../src/core/vulkan/commands/ParallelCommandRecorder.h"
 #include "../src/core/vulkan/pipeline/RenderPass.h"
 #include "../src/core/vulkan/pipeline/Framebuffer.h"
+#include "../src/core/vulkan/descriptors/BindlessTable.h"
+#include "../src/core/vulkan/resource/FrameAllocator.h"
 #include "../src/core/vulkan/resource/Buffer.h"
 #include "../src/core/vulkan/resource/Allocator.h"
 #include "../src/core/vulkan/resource/Image.h"
+#include "../src/core/vulkan/resource/Uploader.h"
 #include "../src/core/3d/MeshHandler.h"
 #include "../src/core/3d/Mesh.h"
 #include "../src/core/3d/Camera.h"
 #include "../src/core/3d/Light.h"
+#include "../src/core/jobs/JobSystem.h"
 
 #include <vulkan/vulkan_core.h>
 #include <stdexcept>
+#include <algorithm>
+#include <chrono>
 #include <GLFW/glfw3.h>
 
 namespace Baal
 {
 	namespace VK
 	{
+		namespace
+		{
+			// Size of one texel of an uncompressed color format, 0 for formats a frame cannot be read back as
+			VkDeviceSize GetTexelSize(const VkFormat format)
+			{
+				switch (format)
+				{
+				case VK_FORMAT_R8_UNORM:
+				case VK_FORMAT_R8_SRGB:
+					return 1;
+				case VK_FORMAT_R8G8_UNORM:
+				case VK_FORMAT_R8G8_SRGB:
+				case VK_FORMAT_R16_UNORM:
+				case VK_FORMAT_R16_SFLOAT:
+					return 2;
+				case VK_FORMAT_R8G8B8A8_UNORM:
+				case VK_FORMAT_R8G8B8A8_SRGB:
+				case VK_FORMAT_B8G8R8A8_UNORM:
+				case VK_FORMAT_B8G8R8A8_SRGB:
+				case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+				case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+				case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+				case VK_FORMAT_R16G16_UNORM:
+				case VK_FORMAT_R16G16_SFLOAT:
+				case VK_FORMAT_R32_SFLOAT:
+					return 4;
+				case VK_FORMAT_R16G16B16A16_UNORM:
+				case VK_FORMAT_R16G16B16A16_SFLOAT:
+				case VK_FORMAT_R32G32_SFLOAT:
+					return 8;
+				case VK_FORMAT_R32G32B32A32_SFLOAT:
+					return 16;
+				default:
+					return 0;
+				}
+			}
+		}
+
 		Renderer::Renderer()
 		{
 		}
@@ -61,6 +106,11 @@ namespace Baal
 			return device->GetCommandPool();
 		}
 
+		ParallelCommandRecorder& Renderer::GetCommandRecorder()
+		{
+			return *commandRecorder.get();
+		}
+
 		RenderPass& Renderer::GetRenderPass()
 		{
 			return *renderPass.get();
@@ -80,7 +130,7 @@ namespace Baal
 		{
 			cameraResources = std::make_unique<RenderCameraResources>();
 
-			cameraResources->camera = std::make_shared<Camera>(45.0f, AspectRatio::CUSTOM_UNLOCKED, GetSwapChain().GetExtent().width, GetSwapChain().GetExtent().height);
+			cameraResources->camera = std::make_shared<Camera>(45.0f, AspectRatio::CUSTOM_UNLOCKED, GetRenderExtent().width, GetRenderExtent().height);
 
 			cameraResources->camera->SetPosition(Vector3f(0.0f, 25.0f, -25.0f));
 
@@ -88,12 +138,15 @@ namespace Baal
 			Quatf xRotation(Vector3f(1.0f, 0.0f, 0.0f), 45.0f);
 			cameraResources->camera->SetRotation(orientation * xRotation);
 
-			cameraResources->uniformBuffer = std::make_unique<Buffer>(GetAllocator(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(CameraMatrix));
+			for (uint32_t i = 0; i < GetFramesInFlight(); ++i)
+			{
+				cameraResources->uniformBuffers.push_back(std::make_unique<Buffer>(GetAllocator(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(CameraMatrix)));
+			}
 		}
 
 		void Renderer::DestroyCamera()
 		{
-			cameraResources->uniformBuffer.reset();
+			cameraResources->uniformBuffers.clear();
 			cameraResources->camera.reset();
 			cameraResources.reset();
 		}
@@ -106,49 +159,27 @@ namespace Baal
 		void Renderer::SetCamera(std::shared_ptr<Camera> camera)
 		{
 			cameraResources->camera = camera;
-			UpdateCamera();
 		}
 
 		void Renderer::UpdateMeshHandler()
 		{
-			meshHandler->CollectSubMeshesToRender();
-		}
-
-		void Renderer::CleanUpMeshHandler()
-		{
-			if (meshHandler->IsGarbageFull())
-			{
-				vkDeviceWaitIdle(GetDevice().GetVkDevice());
-				meshHandler->TryEmptyGarbage();
-			}
+			meshHandler->UpdatePendingMeshes(GetDevice().GetUploader());
+			meshHandler->CollectSubMeshesToRender(GetDevice().GetUploader(), GetCamera().GetFrustum());
 		}
 
 		void Renderer::CreateLightSources()
 		{
+			// Lights only live on the CPU, a frame copies the ones it uses into the FrameAllocator so frames in flight never share them
 			directionalLight = std::make_unique<DirectionalLightSource>();
-			const VkDeviceSize direcBufferSize = sizeof(directionalLight->light);
-			Buffer direcStagingBuffer = Buffer::CreateStagingBuffer(GetAllocator(), direcBufferSize, &directionalLight->light);
-			directionalLight->buffer = std::make_unique<Buffer>(GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, direcBufferSize);
-			GetDevice().CopyBuffer(direcStagingBuffer, *directionalLight->buffer.get(), direcBufferSize);
-
 			pointLights = std::make_unique<PointLightSourceArray>();
-			const VkDeviceSize pointBufferSize = sizeof(pointLights->lights[0]) * pointLights->lights.size();
-			Buffer pointStagingBuffer = Buffer::CreateStagingBuffer(GetAllocator(), pointBufferSize, pointLights->lights.data());
-			pointLights->buffer = std::make_unique<Buffer>(GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pointBufferSize);
-			GetDevice().CopyBuffer(pointStagingBuffer, *pointLights->buffer.get(), pointBufferSize);
-
 			spotLights = std::make_unique<SpotLightSourceArray>();
-			const VkDeviceSize spotBufferSize = sizeof(spotLights->lights[0]) * spotLights->lights.size();
-			Buffer spotStagingBuffer = Buffer::CreateStagingBuffer(GetAllocator(), spotBufferSize, spotLights->lights.data());
-			spotLights->buffer = std::make_unique<Buffer>(GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, spotBufferSize);
-			GetDevice().CopyBuffer(spotStagingBuffer, *spotLights->buffer.get(), spotBufferSize);
 		}
 
 		void Renderer::DestroyLightSources()
 		{
-			directionalLight->buffer.reset();
-			pointLights->buffer.reset();
-			spotLights->buffer.reset();
+			directionalLight.reset();
+			pointLights.reset();
+			spotLights.reset();
 		}
 
 		Camera& Renderer::GetCamera()
@@ -158,17 +189,18 @@ namespace Baal
 
 		Buffer& Renderer::GetCameraUniformBuffer()
 		{
-			return *cameraResources->uniformBuffer.get();
+			return GetCameraUniformBuffer(currentFrame);
 		}
 
-		DirectionalLight& Renderer::GetDirectionalLight()
+		Buffer& Renderer::GetCameraUniformBuffer(uint32_t frameIndex)
 		{
-			return directionalLight->light;
+			assert(frameIndex < cameraResources->uniformBuffers.size());
+			return *cameraResources->uniformBuffers[frameIndex].get();
 		}
 
-		Buffer& Renderer::GetDirectionalLightUniformBuffer()
+		DirectionalLight& Renderer::GetDirectionalLight()
 		{
-			return *directionalLight->buffer.get();
+			return directionalLight->light;
 		}
 
 		PointLight& Renderer::GetPointLight(uint32_t index)
@@ -177,22 +209,12 @@ namespace Baal
 			return pointLights->lights[index];
 		}
 
-		Buffer& Renderer::GetPointLightsUniformBuffer()
-		{
-			return *pointLights->buffer.get();
-		}
-
 		SpotLight& Renderer::GetSpotLight(uint32_t index)
 		{
 			assert(index <= BAAL_MAX_LIGHTS);
 			return spotLights->lights[index];
 		}
 
-		Buffer& Renderer::GetSpotLightsUniformBuffer()
-		{
-			return *spotLights->buffer.get();
-		}
-
 		size_t Renderer::GetUniformBufferOffsetAlignment(size_t size)
 		{
 			size_t minUniformBufferOffsetAlignment = static_cast<size_t>(GetInstance().GetGPU().GetProperties().limits.minUniformBufferOffsetAlignment);
@@ -204,100 +226,231 @@ namespace Baal
 			return dynamicAlignment;
 		}
 
-		void Renderer::Startup(const std::string& appName, GLFWwindow* _window)
+		VkExtent2D Renderer::GetRenderExtent() const
 		{
-			Setup(appName, _window);
-			CreateSwapChainImageViews();
+			if (IsHeadless())
+			{
+				return VkExtent2D(settings.headlessWidth, settings.headlessHeight);
+			}
+			return swapChain->GetExtent();
+		}
+
+		VkFormat Renderer::GetColorFormat() const
+		{
+			if (IsHeadless())
+			{
+				return settings.headlessColorFormat;
+			}
+			return swapChain->GetSurfaceFormat().format;
+		}
+
+		void Renderer::Startup(const std::string& appName, GLFWwindow* _window, const RendererSettings& _settings /*= RendererSettings()*/)
+		{
+			Setup(appName, _window, _settings);
+			if (IsHeadless())
+			{
+				CreateOffscreenTargets();
+			}
+			else
+			{
+				CreateSwapChainImageViews();
+			}
 			CreateRenderPass();
 			CreateFramebuffers();
 			CreateDrawCommandBuffers();
+			CreateReadbackResources();
 			CreateSyncObjects();
 			CreateDefaultCamera();
 			CreateLightSources();
 			Initialize();
+
+			// Everything the scene loaded went into as few upload batches as possible, wait once for all of them
+			// so CPU writes made while rendering can never be overwritten by a late staging copy
+			GetDevice().GetUploader().WaitIdle();
+		}
+
+		void Renderer::Startup(const std::string& appName, const RendererSettings& _settings)
+		{
+			Startup(appName, nullptr, _settings);
 		}
 
 		void Renderer::Render()
 		{
-			UpdateCamera();
+			const auto frameStart = std::chrono::steady_clock::now();
 
-			UpdateMeshHandler();
+			FrameSyncObjects& frameSync = frameSyncObjects[currentFrame];
 
-			PreRender();
+			// Only wait on the frame that last used this frame's resources, the other frames in flight keep the GPU busy in the meantime
+			QueueTimeline& graphicsTimeline = device->GetGraphicsTimeline();
+			graphicsTimeline.Wait(frameSync.submittedValue);
 
-			vkWaitForFences(device->GetVkDevice(), 1, &waitFence, VK_TRUE, UINT64_MAX);
+			const auto fenceWaitEnd = std::chrono::steady_clock::now();
 
-			VkResult result = vkAcquireNextImageKHR(device->GetVkDevice(), swapChain->GetVkSwapChain(), UINT64_MAX, acquiredImageReady, VK_NULL_HANDLE, &currentBuffer);
-			if (result == VK_ERROR_OUT_OF_DATE_KHR)
+			// Acquire before the frame begins, if the swap chain is out of date nothing is submitted and this frame's resources are used again next time
+			VkResult result = VK_SUCCESS;
+			if (IsHeadless())
 			{
-				RecreateSwapChain();
-				return;
+				// Every frame in flight owns its offscreen target, nothing to acquire
+				currentBuffer = currentFrame;
+			}
+			else
+			{
+				result = vkAcquireNextImageKHR(device->GetVkDevice(), swapChain->GetVkSwapChain(), UINT64_MAX, frameSync.acquiredImageReady, VK_NULL_HANDLE, &currentBuffer);
+				if (result == VK_ERROR_OUT_OF_DATE_KHR)
+				{
+					RecreateSwapChain();
+					FinishFrame(frameStart, fenceWaitEnd);
+					return;
+				}
+
+				if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+				{
+					std::string output = std::string(string_VkResult(result));
+					DEBUG_LOG(LOG::ERRORLOG, "Failed to acquire next image to present! Error: {}", output);
+					assert(false);
+				}
+
+				// The swap chain can hand back an image that an older frame in flight is still rendering to
+				graphicsTimeline.Wait(imagesInFlight[currentBuffer]);
 			}
 
-			vkResetFences(device->GetVkDevice(), 1, &waitFence);
-
-			if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+			// The timeline can be read without waiting, so newer frames in flight that already finished are retired as well
+			FrameNumber completedFrame = frameSync.submittedFrame;
+			for (const FrameSyncObjects& otherFrameSync : frameSyncObjects)
 			{
-				std::string output = std::string(string_VkResult(result));
-				DEBUG_LOG(LOG::ERRORLOG, "Failed to acquire next image to present! Error: {}", output);
-				assert(false);
+				if (otherFrameSync.submittedFrame > completedFrame && graphicsTimeline.IsComplete(otherFrameSync.submittedValue))
+				{
+					completedFrame = otherFrameSync.submittedFrame;
+				}
 			}
+			device->GetDeletionQueue().Retire(completedFrame);
+			device->GetDeletionQueue().BeginFrame(++frameNumber);
+			frameAllocator->BeginFrame(currentFrame);
 
-			RecordDrawCommandBuffer(drawCommands[currentBuffer], framebuffers[currentBuffer]);
+			// Background work handing results back, e.g. meshes and textures decoded on a worker and waiting to be uploaded
+			jobSystem->RunMainThreadJobs();
 
-			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
-			submitInfo.commandBufferCount = 1;
-			submitInfo.pCommandBuffers = &drawCommands[currentBuffer].GetVkCommandBuffer();
+			UpdateCamera();
 
-			std::vector<VkSemaphore> waitSemaphores = { acquiredImageReady };
-			std::vector<VkPipelineStageFlags> waitStages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-			submitInfo.waitSemaphoreCount = waitSemaphores.size();
-			submitInfo.pWaitSemaphores = waitSemaphores.data();
-			submitInfo.pWaitDstStageMask = waitStages.data();
+			PreRender();
 
-			std::vector<VkSemaphore> signalSemaphores = { renderComplete };
-			submitInfo.signalSemaphoreCount = signalSemaphores.size();
-			submitInfo.pSignalSemaphores = signalSemaphores.data();
+			// After PreRender, so culling sees this frame's transforms
+			UpdateMeshHandler();
 
-			VK_CHECK(vkQueueSubmit(device->GetGraphicsQueue(), 1, &submitInfo, waitFence), "submitting graphics queue");
+			RecordDrawCommandBuffer(drawCommands[currentFrame], framebuffers[currentBuffer]);
 
-			VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
-			presentInfo.swapchainCount = 1;
-			presentInfo.pSwapchains = &swapChain->GetVkSwapChain();
-			presentInfo.waitSemaphoreCount = signalSemaphores.size();
-			presentInfo.pWaitSemaphores = signalSemaphores.data();
-			presentInfo.pImageIndices = &currentBuffer;
+			// Kick off uploads recorded since the last frame, and hand finished transfers over to the graphics queue
+			// Nothing drawn this frame depends on them, meshes are only collected for rendering once their upload completed
+			GetDevice().GetUploader().Submit();
 
-			result = vkQueuePresentKHR(device->GetPresentQueue(), &presentInfo);
-			if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+			std::vector<VkCommandBuffer> commandBuffers = { drawCommands[currentFrame].GetVkCommandBuffer() };
+			if (!readbackCommands.empty())
 			{
-				RecreateSwapChain();
-				return;
+				commandBuffers.push_back(readbackCommands[currentFrame].GetVkCommandBuffer());
 			}
 
-			if (result != VK_SUCCESS)
+			// Presentation only works with binary semaphores, the frame's completion is tracked on the graphics timeline
+			std::vector<SemaphoreWait> waits;
+			std::vector<VkSemaphore> signalSemaphores;
+			if (!IsHeadless())
 			{
-				std::string output = std::string(string_VkResult(result));
-				DEBUG_LOG(LOG::ERRORLOG, "Failed to present to present queue! Error: {}", output);
-				assert(false);
+				SemaphoreWait acquiredImageWait;
+				acquiredImageWait.semaphore = frameSync.acquiredImageReady;
+				acquiredImageWait.stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				waits.push_back(acquiredImageWait);
+				signalSemaphores.push_back(frameSync.renderComplete);
 			}
 
+			frameSync.submittedValue = graphicsTimeline.Submit(commandBuffers, waits, signalSemaphores);
+			frameSync.submittedFrame = frameNumber;
+			if (!IsHeadless())
+			{
+				imagesInFlight[currentBuffer] = frameSync.submittedValue;
+			}
+			bHasRenderedFrame = true;
+
+			// The frame was submitted, the next frame uses the next frame in flight's resources whether or not presenting succeeds
+			currentFrame = (currentFrame + 1) % GetFramesInFlight();
+
+			if (!IsHeadless())
+			{
+				VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+				presentInfo.swapchainCount = 1;
+				presentInfo.pSwapchains = &swapChain->GetVkSwapChain();
+				presentInfo.waitSemaphoreCount = signalSemaphores.size();
+				presentInfo.pWaitSemaphores = signalSemaphores.data();
+				presentInfo.pImageIndices = &currentBuffer;
+
+				result = vkQueuePresentKHR(device->GetPresentQueue(), &presentInfo);
+				if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+				{
+					RecreateSwapChain();
+				}
+				else if (result != VK_SUCCESS)
+				{
+					std::string output = std::string(string_VkResult(result));
+					DEBUG_LOG(LOG::ERRORLOG, "Failed to present to present queue! Error: {}", output);
+					assert(false);
+				}
+			}
+
+			FinishFrame(frameStart, fenceWaitEnd);
+		}
+
+		void Renderer::FinishFrame(const std::chrono::steady_clock::time_point& frameStart, const std::chrono::steady_clock::time_point& fenceWaitEnd)
+		{
 			PostRender();
 
-			CleanUpMeshHandler();
+			const auto frameEnd = std::chrono::steady_clock::now();
+			frameStats.cpuFrameTime = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+			frameStats.fenceWaitTime = std::chrono::duration<double, std::milli>(fenceWaitEnd - frameStart).count();
+			++frameStats.frameCount;
+		}
+
+		bool Renderer::ReadbackFrame(std::vector<uint8_t>& outPixels)
+		{
+			if (readbackBuffers.empty() || !bHasRenderedFrame)
+			{
+				DEBUG_LOG(LOG::WARNING, "Failed to readback frame! Readback is only available for headless renderers with RendererSettings::bEnableReadback set, after a frame was rendered.");
+				return false;
+			}
+
+			const uint32_t lastFrame = (currentFrame + GetFramesInFlight() - 1) % GetFramesInFlight();
+			device->GetGraphicsTimeline().Wait(frameSyncObjects[lastFrame].submittedValue);
+
+			Buffer& readbackBuffer = *readbackBuffers[lastFrame].get();
+			outPixels.resize(readbackBuffer.GetSize());
+			readbackBuffer.Read(outPixels.data(), outPixels.size());
+			return true;
 		}
 
 		void Renderer::Shutdown()
 		{
+			// Loads still in progress hold on to the job system, meshes and textures. Their background jobs hand uploads back to the main thread,
+			// and textures poll their upload with main thread jobs, so keep running both until every load has finished
+			do
+			{
+				jobSystem->WaitIdle();
+				device->GetUploader().WaitIdle();
+				jobSystem->RunMainThreadJobs();
+			} while (jobSystem->HasUnfinishedJobs());
+
+			device->GetUploader().WaitIdle();
 			vkDeviceWaitIdle(device->GetVkDevice());
+			device->GetDeletionQueue().Flush();
 			Destroy();
 			DestroyLightSources();
 			DestroyCamera();
+			DestroyReadbackResources();
 			DestroyDrawCommandBuffers();
 			DestroyFramebuffers();
 			DestroyRenderPass();
 			meshHandler.reset();
+			bindlessTable.reset();
+			frameAllocator.reset();
+			jobSystem.reset();	// After everything that holds a JobSystem&
 			DestroySwapChainImageViews();
+			DestroyOffscreenTargets();
 			DestroySwapChain();
 			DestroySyncObjects();
 			device.reset();
@@ -305,25 +458,30 @@ namespace Baal
 			instance.reset();
 		}
 
-		std::weak_ptr<Mesh> Renderer::LoadMeshResource(const char* parentDirectory, const char* meshFileName)
+		MeshHandle Renderer::LoadMeshResource(const char* parentDirectory, const char* meshFileName)
 		{
 			return meshHandler->LoadMeshResource(parentDirectory, meshFileName);
 		}
 
-		std::weak_ptr<MeshInstance> Renderer::AddMeshInstanceToScene(std::weak_ptr<Mesh> resource)
+		MeshHandle Renderer::LoadMeshResourceAsync(const char* parentDirectory, const char* meshFileName, MeshLoadedCallback onLoaded /*= nullptr*/)
 		{
-			if (resource.expired()) 
+			return meshHandler->LoadMeshResourceAsync(parentDirectory, meshFileName, std::move(onLoaded));
+		}
+
+		MeshInstanceHandle Renderer::AddMeshInstanceToScene(const MeshHandle resource)
+		{
+			if (meshHandler->GetMesh(resource) == nullptr) 
 			{
-				DEBUG_LOG(LOG::ERRORLOG, "Failed to add Mesh Instance to scene! Resource Mesh is nullptr, please provide a valid Mesh.");
-				return std::weak_ptr<MeshInstance>();
+				DEBUG_LOG(LOG::ERRORLOG, "Failed to add Mesh Instance to scene! Resource Mesh handle is stale, please provide a valid Mesh.");
+				return MeshInstanceHandle();
 			}
 
-			return meshHandler->CreateMeshInstance(GetDevice(), *resource.lock());
+			return meshHandler->CreateMeshInstance(resource);
 		}
 
 		std::vector<const char*> Renderer::GetRequiredInstanceExtenstions() const
 		{
-			const std::vector<const char*> glfwExtensions = GetRequiredGLFWExtenstions();
+			const std::vector<const char*> glfwExtensions = IsHeadless() ? std::vector<const char*>() : GetRequiredGLFWExtenstions();
 			const std::vector<const char*> miscExtensions = {};
 
 			std::vector<const char*> requiredExtensions;
@@ -346,26 +504,59 @@ namespace Baal
 
 		std::vector<const char*> Renderer::GetRequiredDeviceExtenstions() const
 		{
-			const std::vector<const char*> miscExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+			std::vector<const char*> miscExtensions;
+			if (!IsHeadless())
+			{
+				miscExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+			}
 			return miscExtensions;
 		}
 
-		void Renderer::Setup(const std::string& appName, GLFWwindow* _window)
+		void Renderer::Setup(const std::string& appName, GLFWwindow* _window, const RendererSettings& _settings)
 		{
 			window = _window;
 
+			settings = _settings;
+			settings.framesInFlight = std::clamp(settings.framesInFlight, 1u, static_cast<uint32_t>(BAAL_MAX_FRAMES_IN_FLIGHT));
+			currentFrame = 0;
+			frameStats = FrameStats();
+
+			if (IsHeadless() && settings.bEnableReadback && GetTexelSize(settings.headlessColorFormat) == 0)
+			{
+				std::string output = std::string(string_VkFormat(settings.headlessColorFormat));
+				DEBUG_LOG(LOG::WARNING, "Readback does not support the headless color format {}, disabling readback", output);
+				settings.bEnableReadback = false;
+			}
+
 			const std::vector<const char*> instanceExtensions = GetRequiredInstanceExtenstions();
 			const std::vector<const char*> deviceExtensions = GetRequiredDeviceExtenstions();
 
 			instance = std::make_unique<Instance>(appName, true, instanceExtensions);
 
-			surface = std::make_unique<Surface>(*instance.get(), window);
-
-			device = std::make_unique<LogicalDevice>(*instance.get(), *surface.get(), deviceExtensions);
+			if (IsHeadless())
+			{
+				DEBUG_LOG(LOG::INFO, "Starting headless renderer... [{}x{}]", settings.headlessWidth, settings.headlessHeight);
+				device = std::make_unique<LogicalDevice>(*instance.get(), nullptr, deviceExtensions);
+			}
+			else
+			{
+				surface = std::make_unique<Surface>(*instance.get(), window);
+				device = std::make_unique<LogicalDevice>(*instance.get(), surface.get(), deviceExtensions);
+				CreateSwapChain();
+			}
 
-			CreateSwapChain();
+			if (settings.bBindlessResources && BindlessTable::IsSupported(*device.get()))
+			{
+				bindlessTable = std::make_unique<BindlessTable>(*device.get());
+			}
+			else if (settings.bBindlessResources)
+			{
+				DEBUG_LOG(LOG::WARNING, "Bindless resources are not supported by this GPU, binding textures and pushing materials per draw instead");
+			}
 
-			meshHandler = std::make_unique<MeshHandler>();
+			jobSystem = std::make_unique<JobSystem>(settings.workerThreadCount);
+			meshHandler = std::make_unique<MeshHandler>(*device.get(), *jobSystem.get(), bindlessTable.get());
+			frameAllocator = std::make_unique<FrameAllocator>(*device.get(), instance->GetGPU(), GetFramesInFlight());
 		}
 
 		void Renderer::CreateSwapChainImageViews()
@@ -410,6 +601,98 @@ namespace Baal
 			swapChainImageViews.clear();
 		}
 
+		void Renderer::CreateOffscreenTargets()
+		{
+			DestroyOffscreenTargets();
+
+			VkImageSubresourceRange subresourceRange = {};
+			subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			subresourceRange.baseMipLevel = 0;
+			subresourceRange.levelCount = 1;
+			subresourceRange.baseArrayLayer = 0;
+			subresourceRange.layerCount = 1;
+
+			for (uint32_t i = 0; i < GetFramesInFlight(); ++i)
+			{
+				offscreenColorImages.push_back(std::make_unique<Image>(
+					GetDevice(),
+					settings.headlessWidth,
+					settings.headlessHeight,
+					VK_IMAGE_TYPE_2D,
+					settings.headlessColorFormat,
+					VK_IMAGE_TILING_OPTIMAL,
+					VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+					VK_SAMPLE_COUNT_1_BIT,
+					VK_IMAGE_VIEW_TYPE_2D,
+					subresourceRange));
+			}
+		}
+
+		void Renderer::DestroyOffscreenTargets()
+		{
+			offscreenColorImages.clear();
+		}
+
+		void Renderer::CreateReadbackResources()
+		{
+			if (!IsHeadless() || !settings.bEnableReadback)
+			{
+				return;
+			}
+
+			const VkDeviceSize readbackSize = static_cast<VkDeviceSize>(settings.headlessWidth) * settings.headlessHeight * GetTexelSize(settings.headlessColorFormat);
+
+			readbackCommands.reserve(GetFramesInFlight());
+			VK_CHECK(GetCommandPool().CreateCommandBuffers(GetFramesInFlight(), VK_COMMAND_BUFFER_LEVEL_PRIMARY, readbackCommands), "creating readback commands");
+
+			for (uint32_t i = 0; i < GetFramesInFlight(); ++i)
+			{
+				readbackBuffers.push_back(std::make_unique<Buffer>(GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, readbackSize, BufferHostAccess::Readback));
+
+				// The copy never changes, so it is recorded once and resubmitted after every draw of this frame in flight
+				CommandBuffer& commandBuffer = readbackCommands[i];
+				commandBuffer.BeginRecording(0);
+
+				VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+				barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.image = offscreenColorImages[i]->GetVkImage();
+				barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+				barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				vkCmdPipelineBarrier(commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+				VkBufferImageCopy copyRegion{};
+				copyRegion.bufferOffset = 0;
+				copyRegion.bufferRowLength = 0;
+				copyRegion.bufferImageHeight = 0;
+				copyRegion.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+				copyRegion.imageOffset = { 0, 0, 0 };
+				copyRegion.imageExtent = { settings.headlessWidth, settings.headlessHeight, 1 };
+				vkCmdCopyImageToBuffer(commandBuffer.GetVkCommandBuffer(), offscreenColorImages[i]->GetVkImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffers[i]->GetVkBuffer(), 1, &copyRegion);
+
+				VkBufferMemoryBarrier hostBarrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+				hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+				hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				hostBarrier.buffer = readbackBuffers[i]->GetVkBuffer();
+				hostBarrier.offset = 0;
+				hostBarrier.size = VK_WHOLE_SIZE;
+				vkCmdPipelineBarrier(commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+				commandBuffer.EndRecording();
+			}
+		}
+
+		void Renderer::DestroyReadbackResources()
+		{
+			readbackCommands.clear();
+			readbackBuffers.clear();
+		}
+
 		void Renderer::CreateRenderPass()
 		{
 			CreateDepthResources();
@@ -417,14 +700,14 @@ namespace Baal
 			Attachment colorAttachment;
 			colorAttachment.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 			colorAttachment.description.flags = 0;
-			colorAttachment.description.format = swapChain->GetSurfaceFormat().format;
+			colorAttachment.description.format = GetColorFormat();
 			colorAttachment.description.samples = VK_SAMPLE_COUNT_1_BIT;
 			colorAttachment.description.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 			colorAttachment.description.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 			colorAttachment.description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			colorAttachment.description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 			colorAttachment.description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			colorAttachment.description.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			colorAttachment.description.finalLayout = IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 			Attachment depthAttachment;
 			depthAttachment.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
@@ -464,8 +747,8 @@ namespace Baal
 
 			depthImage = std::make_unique<Image>(
 				GetDevice(),
-				GetSwapChain().GetExtent().width,
-				GetSwapChain().GetExtent().height,
+				GetRenderExtent().width,
+				GetRenderExtent().height,
 				VK_IMAGE_TYPE_2D,
 				depthFormat,
 				VK_IMAGE_TILING_OPTIMAL,
@@ -474,7 +757,6 @@ namespace Baal
 				VK_IMAGE_VIEW_TYPE_2D,
 				subresourceRange);
 
-			CommandBuffer commandBuffer(GetDevice().CreateCommandBuffer());
 			Image::TransitionToLayout(
 				*depthImage.get(),
 				depthFormat,
@@ -485,7 +767,6 @@ namespace Baal
 				0,
 				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
 				subresourceRange);
-			GetDevice().FlushCommandBuffer(commandBuffer, GetDevice().GetGraphicsQueue());
 		}
 
 		void Renderer::DestroyDepthResources()
@@ -499,23 +780,34 @@ namespace Baal
 			{
 				framebuffers.push_back(Framebuffer(*device.get(), *renderPass.get(), { swapChainImageViews[i], depthImage->GetVkImageView() }, swapChain->GetExtent().width, swapChain->GetExtent().height));
 			}
+
+			for (size_t i = 0; i < offscreenColorImages.size(); ++i)
+			{
+				framebuffers.push_back(Framebuffer(*device.get(), *renderPass.get(), { offscreenColorImages[i]->GetVkImageView(), depthImage->GetVkImageView() }, settings.headlessWidth, settings.headlessHeight));
+			}
+
+			imagesInFlight.assign(framebuffers.size(), 0);
 		}
 
 		void Renderer::DestroyFramebuffers()
 		{
 			framebuffers.clear();
+			imagesInFlight.clear();
 		}
 
 		void Renderer::CreateDrawCommandBuffers()
 		{
-			const uint32_t framebufferCount = framebuffers.size();
-			drawCommands.reserve(framebufferCount);
-			VK_CHECK(GetCommandPool().CreateCommandBuffers(framebufferCount, VK_COMMAND_BUFFER_LEVEL_PRIMARY, drawCommands), "creating draw commands");
+			drawCommands.reserve(GetFramesInFlight());
+			VK_CHECK(GetCommandPool().CreateCommandBuffers(GetFramesInFlight(), VK_COMMAND_BUFFER_LEVEL_PRIMARY, drawCommands), "creating draw commands");
 			currentBuffer = 0;
+
+			const uint32_t recordingChunkCount = settings.recordingChunkCount > 0 ? settings.recordingChunkCount : jobSystem->GetThreadCount();
+			commandRecorder = std::make_unique<ParallelCommandRecorder>(GetDevice(), *jobSystem.get(), recordingChunkCount, GetFramesInFlight());
 		}
 
 		void Renderer::DestroyDrawCommandBuffers()
 		{
+			commandRecorder.reset();
 			drawCommands.clear();
 		}
 
@@ -523,19 +815,24 @@ namespace Baal
 		{
 			VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
 			semaphoreInfo.flags = 0;
-			VK_CHECK(vkCreateSemaphore(device->GetVkDevice(), &semaphoreInfo, nullptr, &acquiredImageReady), "creating semaphore for acquired image ready");
-			VK_CHECK(vkCreateSemaphore(device->GetVkDevice(), &semaphoreInfo, nullptr, &renderComplete), "creating semaphore for render complete");
 
-			VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
-			fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-			VK_CHECK(vkCreateFence(device->GetVkDevice(), &fenceInfo, nullptr, &waitFence), "creating wait fence");
+			frameSyncObjects.resize(GetFramesInFlight());
+			for (FrameSyncObjects& frameSync : frameSyncObjects)
+			{
+				VK_CHECK(vkCreateSemaphore(device->GetVkDevice(), &semaphoreInfo, nullptr, &frameSync.acquiredImageReady), "creating semaphore for acquired image ready");
+				VK_CHECK(vkCreateSemaphore(device->GetVkDevice(), &semaphoreInfo, nullptr, &frameSync.renderComplete), "creating semaphore for render complete");
+			}
 		}
 
 		void Renderer::DestroySyncObjects()
 		{
-			vkDestroySemaphore(device->GetVkDevice(), acquiredImageReady, nullptr);
-			vkDestroySemaphore(device->GetVkDevice(), renderComplete, nullptr);
-			vkDestroyFence(device->GetVkDevice(), waitFence, nullptr);
+			for (FrameSyncObjects& frameSync : frameSyncObjects)
+			{
+				vkDestroySemaphore(device->GetVkDevice(), frameSync.acquiredImageReady, nullptr);
+				vkDestroySemaphore(device->GetVkDevice(), frameSync.renderComplete, nullptr);
+			}
+
+			frameSyncObjects.clear();
 		}
 
 		void Renderer::RecreateSwapChain()
@@ -579,7 +876,7 @@ namespace Baal
 
 			vkDeviceWaitIdle(device->GetVkDevice());
 
-			swapChain = std::make_unique<SwapChain>(instance->GetGPU(), *device.get(), *surface.get(), VK_PRESENT_MODE_FIFO_KHR, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+			swapChain = std::make_unique<SwapChain>(instance->GetGPU(), *device.get(), *surface.get(), settings.presentMode, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
 		}
 
 		void Renderer::DestroySwapChain()
@@ -8,13 +8,29 @@
 #include <vector>
 #include <unordered_map>
 #include <array>
+#include <chrono>
 
 #include <vulkan/vulkan_core.h>
 
+#include "../src/utility/SlotMap.h"
+#include "../src/core/3d/MeshHandler.h"
+#include "../src/core/vulkan/resource/DeletionQueue.h"
+#include "../src/core/vulkan/commands/QueueTimeline.h"
+
+#ifndef BAAL_MAX_FRAMES_IN_FLIGHT
+#define BAAL_MAX_FRAMES_IN_FLIGHT 3
+#endif // !BAAL_MAX_FRAMES_IN_FLIGHT
+
+#ifndef BAAL_DEFAULT_FRAMES_IN_FLIGHT
+#define BAAL_DEFAULT_FRAMES_IN_FLIGHT 2
+#endif // !BAAL_DEFAULT_FRAMES_IN_FLIGHT
+
 class GLFWwindow;
 
 namespace Baal
 {
+	class JobSystem;
+
 	namespace VK
 	{
 		class Instance;
@@ -23,14 +39,19 @@ namespace Baal
 		class SwapChain;
 		class CommandPool;
 		class CommandBuffer;
+		class ParallelCommandRecorder;
 		class Framebuffer;
 		class Image;
 		class RenderPass;
 		class Allocator;
 		class Buffer;
 		class MeshHandler;
+		class BindlessTable;
+		class FrameAllocator;
 		class Mesh;
-		class MeshInstance;
+		struct MeshInstance;
+		using MeshHandle = Handle<Mesh>;
+		using MeshInstanceHandle = Handle<MeshInstance>;
 		class Camera;
 		class RenderCameraResources;
 		template<typename T>
@@ -44,6 +65,48 @@ namespace Baal
 		using PointLightSourceArray = LightSourceArray<PointLight>;
 		using SpotLightSourceArray = LightSourceArray<SpotLight>;;
 
+		struct RendererSettings
+		{
+			// Number of frames the CPU is allowed to record ahead of the GPU, clamped to [1, BAAL_MAX_FRAMES_IN_FLIGHT]
+			uint32_t framesInFlight = BAAL_DEFAULT_FRAMES_IN_FLIGHT;
+			VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+			// Used when the renderer is started without a window, frames are rendered into offscreen images instead of a swap chain
+			uint32_t headlessWidth = 1280;
+			uint32_t headlessHeight = 720;
+			VkFormat headlessColorFormat = VK_FORMAT_R8G8B8A8_SRGB;
+			bool bEnableReadback = false;	// Copies every headless frame into host memory, see Renderer::ReadbackFrame(). Ignored for compressed and depth formats
+
+			// Chunks draw commands are split into and recorded as jobs, 0 uses one per JobSystem thread, clamped to BAAL_MAX_RECORDING_CHUNKS
+			uint32_t recordingChunkCount = 0;
+
+			// Worker threads of the JobSystem, which culls, records and loads assets. 0 uses every hardware thread but the render thread's
+			uint32_t workerThreadCount = 0;
+
+			// Culls and draws on the GPU with indirect draws, see IndirectDrawPass. Ignored when the GPU lacks drawIndirectFirstInstance
+			bool bGPUDrivenRendering = true;
+
+			// Textures and materials live in one descriptor set indexed from the shaders, see BindlessTable. Ignored when the GPU lacks descriptor indexing
+			bool bBindlessResources = true;
+		};
+
+		// Timings of the last rendered frame, in milliseconds
+		struct FrameStats
+		{
+			double cpuFrameTime = 0.0;
+			double fenceWaitTime = 0.0;
+			uint64_t frameCount = 0;
+		};
+
+		// Synchronization objects owned by a single frame in flight
+		struct FrameSyncObjects
+		{
+			VkSemaphore acquiredImageReady{ VK_NULL_HANDLE };
+			VkSemaphore renderComplete{ VK_NULL_HANDLE };
+			TimelineValue submittedValue = 0;	// Graphics timeline value of the frame's last submission
+			FrameNumber submittedFrame = 0;	// Last frame submitted, complete once the graphics timeline reaches submittedValue
+		};
+
 		class Renderer
 		{
 		public:
@@ -62,11 +125,17 @@ namespace Baal
 
 			std::vector<const char*> GetRequiredDeviceExtenstions() const;
 
-			void Setup(const std::string& appName, GLFWwindow* _window);
+			void Setup(const std::string& appName, GLFWwindow* _window, const RendererSettings& _settings);
 
 			void CreateSwapChainImageViews();
 			void DestroySwapChainImageViews();
 
+			void CreateOffscreenTargets();
+			void DestroyOffscreenTargets();
+
+			void CreateReadbackResources();
+			void DestroyReadbackResources();
+
 			void CreateRenderPass();
 			void DestroyRenderPass();
 
@@ -86,12 +155,13 @@ namespace Baal
 			void CreateSwapChain();
 			void DestroySwapChain();
 
+			void FinishFrame(const std::chrono::steady_clock::time_point& frameStart, const std::chrono::steady_clock::time_point& fenceWaitEnd);
+
 			void CreateDefaultCamera();
 			void DestroyCamera();
 			void UpdateCamera();
 
 			void UpdateMeshHandler();
-			void CleanUpMeshHandler();
 
 			void CreateLightSources();
 			void DestroyLightSources();
@@ -104,17 +174,30 @@ namespace Baal
 			std::unique_ptr<SwapChain> swapChain;
 			std::vector<VkImageView> swapChainImageViews;
 
-			std::vector<CommandBuffer> drawCommands;
+			std::vector<std::unique_ptr<Image>> offscreenColorImages;	// One per frame in flight, replaces the swap chain when headless
+			std::vector<std::unique_ptr<Buffer>> readbackBuffers;
+			std::vector<CommandBuffer> readbackCommands;
+			bool bHasRenderedFrame = false;
+
+			RendererSettings settings;
+
+			std::vector<CommandBuffer> drawCommands;	// One per frame in flight
+			std::unique_ptr<ParallelCommandRecorder> commandRecorder;
 			
 			std::unique_ptr<Image> depthImage;
 			std::unique_ptr<RenderPass> renderPass;
 			std::vector<Framebuffer> framebuffers;
 
-			VkSemaphore acquiredImageReady{ VK_NULL_HANDLE };
-			VkSemaphore renderComplete{ VK_NULL_HANDLE };
-			VkFence waitFence{ VK_NULL_HANDLE };
+			std::vector<FrameSyncObjects> frameSyncObjects;
+			std::vector<TimelineValue> imagesInFlight;	// Graphics timeline value of the frame currently using each swap chain image
+			uint32_t currentFrame = 0;
 			uint32_t currentBuffer = 0;
+			FrameNumber frameNumber = 0;	// Frames begun so far, numbers the DeletionQueue
+			FrameStats frameStats;
 			
+			std::unique_ptr<JobSystem> jobSystem;
+			std::unique_ptr<BindlessTable> bindlessTable;	// nullptr when unsupported or disabled
+			std::unique_ptr<FrameAllocator> frameAllocator;
 			std::unique_ptr<MeshHandler> meshHandler;
 			std::unique_ptr<RenderCameraResources> cameraResources;
 
@@ -134,33 +217,54 @@ namespace Baal
 			Surface& GetSurface();
 			SwapChain& GetSwapChain();
 			CommandPool& GetCommandPool();
+			ParallelCommandRecorder& GetCommandRecorder();
 			RenderPass& GetRenderPass();
 			Allocator& GetAllocator();
 
 			MeshHandler& GetMeshHandler();
+			JobSystem& GetJobSystem() { return *jobSystem.get(); }
+			BindlessTable* GetBindlessTable() { return bindlessTable.get(); }	// nullptr when unsupported or disabled
+			FrameAllocator& GetFrameAllocator() { return *frameAllocator.get(); }	// Reset every frame, for data that only lives one frame
 
 			void SetCamera(std::shared_ptr<Camera> camera);
 			Camera& GetCamera();
 			Buffer& GetCameraUniformBuffer();
+			Buffer& GetCameraUniformBuffer(uint32_t frameIndex);
 
+			// Lights are CPU side only, copy the ones a frame uses into GetFrameAllocator() and bind them from there
 			DirectionalLight& GetDirectionalLight();
-			Buffer& GetDirectionalLightUniformBuffer();
-
 			PointLight& GetPointLight(uint32_t index);
-			Buffer& GetPointLightsUniformBuffer();
-
 			SpotLight& GetSpotLight(uint32_t index);
-			Buffer& GetSpotLightsUniformBuffer();
+
+			// Index of the frame in flight currently being recorded, per-frame resources should be indexed with it
+			uint32_t GetFrameIndex() const { return currentFrame; }
+			uint32_t GetFramesInFlight() const { return settings.framesInFlight; }
+			const RendererSettings& GetSettings() const { return settings; }
 
 			size_t GetUniformBufferOffsetAlignment(size_t size);
 
+			VkExtent2D GetRenderExtent() const;
+			VkFormat GetColorFormat() const;
+
 		public:
-			void Startup(const std::string& appName, GLFWwindow* _window);
+			void Startup(const std::string& appName, GLFWwindow* _window, const RendererSettings& _settings = RendererSettings());
+			void Startup(const std::string& appName, const RendererSettings& _settings);	// Headless, no window or swap chain
 			void Render();
 			void Shutdown();
 
-			std::weak_ptr<Mesh> LoadMeshResource(const char* parentDirectory, const char* meshFileName);
-			std::weak_ptr<MeshInstance> AddMeshInstanceToScene(std::weak_ptr<Mesh> resource);
+			bool IsHeadless() const { return window == nullptr; }
+
+			// Copies the last rendered headless frame into outPixels as tightly packed texels of RendererSettings::headlessColorFormat, requires RendererSettings::bEnableReadback
+			bool ReadbackFrame(std::vector<uint8_t>& outPixels);
+
+			const FrameStats& GetFrameStats() const { return frameStats; }
+
+			MeshHandle LoadMeshResource(const char* parentDirectory, const char* meshFileName);
+
+			// Returns at once and never stalls the frame loop, see MeshHandler::LoadMeshResourceAsync()
+			// Instances can be added to the scene straight away, they draw a placeholder until the mesh is resident
+			MeshHandle LoadMeshResourceAsync(const char* parentDirectory, const char* meshFileName, MeshLoadedCallback onLoaded = nullptr);
+			MeshInstanceHandle AddMeshInstanceToScene(const MeshHandle resource);
 		};
 	}
 }
@@ -46,10 +46,11 @@ namespace Baal
 			}
 		}
 
-		void CommandBuffer::BeginRecording(VkCommandBufferUsageFlags flags)
+		void CommandBuffer::BeginRecording(VkCommandBufferUsageFlags flags, const VkCommandBufferInheritanceInfo* inheritanceInfo /*= nullptr*/)
 		{
 			VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
 			beginInfo.flags = flags;
+			beginInfo.pInheritanceInfo = inheritanceInfo;
 
 			VK_CHECK(vkBeginCommandBuffer(vkCommandBuffer, &beginInfo), "beginning command buffer recording");
 		}
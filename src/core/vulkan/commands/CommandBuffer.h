@@ -27,7 +27,8 @@ namespace Baal
 			CommandBuffer& operator=(const CommandBuffer&) = delete;
 			CommandBuffer& operator=(CommandBuffer&&) = delete;
 
-			void BeginRecording(VkCommandBufferUsageFlags flags);
+			// Secondary command buffers must provide inheritanceInfo
+			void BeginRecording(VkCommandBufferUsageFlags flags, const VkCommandBufferInheritanceInfo* inheritanceInfo = nullptr);
 			void EndRecording();
 			void Reset();
 
@@ -48,5 +48,10 @@ namespace Baal
 			}
 			return result;
 		}
+
+		void CommandPool::Reset()
+		{
+			VK_CHECK(vkResetCommandPool(device.GetVkDevice(), vkCommandPool, 0), "resetting command pool");
+		}
 	}
 }
\ No newline at end of file
@@ -32,6 +32,9 @@ namespace Baal
 
 			VkResult CreateCommandBuffers(uint32_t count, VkCommandBufferLevel level, std::vector<CommandBuffer>& outCommandBuffers);
 
+			// Resets every command buffer allocated from the pool at once, none of them may still be pending execution
+			void Reset();
+
 		private:
 			VkCommandPool vkCommandPool{ VK_NULL_HANDLE };
 			LogicalDevice& device;
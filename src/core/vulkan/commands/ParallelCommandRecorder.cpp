@@ -0,0 +1,101 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "ParallelCommandRecorder.h"
+
+#include "../src/core/vulkan/debugging/Error.h"
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/commands/CommandPool.h"
+#include "../src/core/vulkan/commands/CommandBuffer.h"
+#include "../src/core/jobs/JobSystem.h"
+
+#include <algorithm>
+
+namespace Baal
+{
+	namespace VK
+	{
+		ParallelCommandRecorder::ParallelCommandRecorder(LogicalDevice& _device, JobSystem& _jobSystem, const uint32_t _maxChunkCount, const uint32_t framesInFlight):
+			device(_device),
+			jobSystem(_jobSystem),
+			maxChunkCount(std::clamp(_maxChunkCount, 1u, static_cast<uint32_t>(BAAL_MAX_RECORDING_CHUNKS)))
+		{
+			frameChunkCommands.resize(framesInFlight);
+			for (std::vector<ChunkCommands>& chunkCommands : frameChunkCommands)
+			{
+				chunkCommands.resize(maxChunkCount);
+				for (ChunkCommands& commands : chunkCommands)
+				{
+					commands.commandPool = std::make_unique<CommandPool>(device, device.GetGraphicsQueueFamilyIndex());
+					commands.secondaryCommandBuffer = std::make_unique<CommandBuffer>(*commands.commandPool.get(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+				}
+			}
+
+			DEBUG_LOG(LOG::INFO, "Created parallel command recorder with up to {} chunk(s) per frame", maxChunkCount);
+		}
+
+		ParallelCommandRecorder::~ParallelCommandRecorder()
+		{
+			for (std::vector<ChunkCommands>& chunkCommands : frameChunkCommands)
+			{
+				for (ChunkCommands& commands : chunkCommands)
+				{
+					commands.secondaryCommandBuffer.reset();
+					commands.commandPool.reset();
+				}
+			}
+			frameChunkCommands.clear();
+		}
+
+		void ParallelCommandRecorder::Record(
+			CommandBuffer& primaryCommandBuffer,
+			const uint32_t frameIndex,
+			const VkCommandBufferInheritanceInfo& inheritanceInfo,
+			const uint32_t itemCount,
+			const RecordChunkFunction& recordChunk)
+		{
+			if (itemCount == 0)
+			{
+				return;
+			}
+
+			std::vector<ChunkCommands>& chunkCommands = frameChunkCommands[frameIndex];
+
+			const uint32_t maxChunks = (itemCount + BAAL_MIN_DRAWS_PER_RECORDING_CHUNK - 1) / BAAL_MIN_DRAWS_PER_RECORDING_CHUNK;
+			const uint32_t chunkCount = std::min(maxChunkCount, maxChunks);
+			const uint32_t chunkSize = (itemCount + chunkCount - 1) / chunkCount;
+
+			auto recordSecondary = [&](const uint32_t chunk)
+			{
+				ChunkCommands& commands = chunkCommands[chunk];
+				commands.commandPool->Reset();
+
+				commands.secondaryCommandBuffer->BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &inheritanceInfo);
+
+				const uint32_t begin = chunk * chunkSize;
+				const uint32_t end = std::min(begin + chunkSize, itemCount);
+				recordChunk(*commands.secondaryCommandBuffer.get(), begin, end);
+
+				commands.secondaryCommandBuffer->EndRecording();
+			};
+
+			// One chunk per batch, the calling thread records the first one itself and helps with the rest while it waits
+			jobSystem.ParallelFor(chunkCount, 1, [&recordSecondary](const uint32_t begin, const uint32_t end)
+			{
+				for (uint32_t chunk = begin; chunk < end; ++chunk)
+				{
+					recordSecondary(chunk);
+				}
+			});
+
+			// Executed in chunk order, so the draw order matches a single threaded recording
+			std::vector<VkCommandBuffer> secondaryCommandBuffers;
+			secondaryCommandBuffers.reserve(chunkCount);
+			for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				secondaryCommandBuffers.push_back(chunkCommands[chunk].secondaryCommandBuffer->GetVkCommandBuffer());
+			}
+
+			vkCmdExecuteCommands(primaryCommandBuffer.GetVkCommandBuffer(), static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+		}
+	}
+}
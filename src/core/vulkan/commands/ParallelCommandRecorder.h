@@ -0,0 +1,75 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_PARALLEL_COMMAND_RECORDER_H
+#define BAAL_VK_PARALLEL_COMMAND_RECORDER_H
+
+#include <vulkan/vulkan_core.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifndef BAAL_MAX_RECORDING_CHUNKS
+#define BAAL_MAX_RECORDING_CHUNKS 16
+#endif // !BAAL_MAX_RECORDING_CHUNKS
+
+#ifndef BAAL_MIN_DRAWS_PER_RECORDING_CHUNK
+#define BAAL_MIN_DRAWS_PER_RECORDING_CHUNK 128	// Smaller chunks cost more in job hand off than they save in recording
+#endif // !BAAL_MIN_DRAWS_PER_RECORDING_CHUNK
+
+namespace Baal
+{
+	class JobSystem;
+
+	namespace VK
+	{
+		class LogicalDevice;
+		class CommandPool;
+		class CommandBuffer;
+
+		// Records a draw list as jobs on the JobSystem workers into secondary command buffers, and executes them from a primary command buffer
+		// The workers live as long as the JobSystem, recording a frame never creates a thread
+		// Every chunk owns a CommandPool per frame in flight, a chunk is only ever recorded by one job at a time, so recording never needs to lock and pools are reset as a whole
+		class ParallelCommandRecorder
+		{
+		public:
+			// Records items [begin, end) into a secondary command buffer, nothing is inherited apart from the render pass,
+			// so pipelines, descriptor sets and dynamic state must be bound by every chunk
+			using RecordChunkFunction = std::function<void(CommandBuffer& commandBuffer, const uint32_t begin, const uint32_t end)>;
+
+			// maxChunkCount caps the number of chunks a draw list is split into
+			explicit ParallelCommandRecorder(LogicalDevice& _device, JobSystem& _jobSystem, const uint32_t _maxChunkCount, const uint32_t framesInFlight);
+			ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+			ParallelCommandRecorder(ParallelCommandRecorder&&) = delete;
+
+			~ParallelCommandRecorder();
+
+			ParallelCommandRecorder& operator=(const ParallelCommandRecorder&) = delete;
+			ParallelCommandRecorder& operator = (ParallelCommandRecorder&&) = delete;
+
+			// The primary command buffer must be inside a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+			// The frame's previous submission must have completed, its command pools are reset here
+			void Record(
+				CommandBuffer& primaryCommandBuffer,
+				const uint32_t frameIndex,
+				const VkCommandBufferInheritanceInfo& inheritanceInfo,
+				const uint32_t itemCount,
+				const RecordChunkFunction& recordChunk);
+
+			uint32_t GetMaxChunkCount() const { return maxChunkCount; }
+
+		private:
+			struct ChunkCommands
+			{
+				std::unique_ptr<CommandPool> commandPool;
+				std::unique_ptr<CommandBuffer> secondaryCommandBuffer;
+			};
+
+			LogicalDevice& device;
+			JobSystem& jobSystem;
+			uint32_t maxChunkCount;
+			std::vector<std::vector<ChunkCommands>> frameChunkCommands;	// [frameIndex][chunk]
+		};
+	}
+}
+
+#endif // !BAAL_VK_PARALLEL_COMMAND_RECORDER_H
@@ -0,0 +1,105 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "QueueTimeline.h"
+
+#include "../src/core/vulkan/debugging/Error.h"
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+
+#include <cstdint>
+
+namespace Baal
+{
+	namespace VK
+	{
+		QueueTimeline::QueueTimeline(LogicalDevice& _device, VkQueue _queue):
+			device(_device),
+			queue(_queue)
+		{
+			VkSemaphoreTypeCreateInfo typeInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+			typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+			typeInfo.initialValue = 0;
+
+			VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+			semaphoreInfo.pNext = &typeInfo;
+			VK_CHECK(vkCreateSemaphore(device.GetVkDevice(), &semaphoreInfo, nullptr, &semaphore), "creating timeline semaphore");
+		}
+
+		QueueTimeline::~QueueTimeline()
+		{
+			vkDestroySemaphore(device.GetVkDevice(), semaphore, nullptr);
+		}
+
+		TimelineValue QueueTimeline::Submit(const std::vector<VkCommandBuffer>& commandBuffers, const std::vector<SemaphoreWait>& waits /*= {}*/, const std::vector<VkSemaphore>& binarySignals /*= {}*/)
+		{
+			const TimelineValue signalValue = lastSubmittedValue + 1;
+
+			std::vector<VkSemaphore> waitSemaphores;
+			std::vector<TimelineValue> waitValues;
+			std::vector<VkPipelineStageFlags> waitStages;
+			for (const SemaphoreWait& wait : waits)
+			{
+				waitSemaphores.push_back(wait.semaphore);
+				waitValues.push_back(wait.value);
+				waitStages.push_back(wait.stage);
+			}
+
+			// The timeline semaphore goes first, binary semaphores take a signal value that is ignored
+			std::vector<VkSemaphore> signalSemaphores = { semaphore };
+			std::vector<TimelineValue> signalValues = { signalValue };
+			for (const VkSemaphore binarySignal : binarySignals)
+			{
+				signalSemaphores.push_back(binarySignal);
+				signalValues.push_back(0);
+			}
+
+			VkTimelineSemaphoreSubmitInfo timelineInfo = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+			timelineInfo.waitSemaphoreValueCount = waitValues.size();
+			timelineInfo.pWaitSemaphoreValues = waitValues.data();
+			timelineInfo.signalSemaphoreValueCount = signalValues.size();
+			timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+			submitInfo.pNext = &timelineInfo;
+			submitInfo.waitSemaphoreCount = waitSemaphores.size();
+			submitInfo.pWaitSemaphores = waitSemaphores.data();
+			submitInfo.pWaitDstStageMask = waitStages.data();
+			submitInfo.commandBufferCount = commandBuffers.size();
+			submitInfo.pCommandBuffers = commandBuffers.data();
+			submitInfo.signalSemaphoreCount = signalSemaphores.size();
+			submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+			VK_CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE), "submitting to queue timeline");
+			lastSubmittedValue = signalValue;
+			return signalValue;
+		}
+
+		bool QueueTimeline::IsComplete(const TimelineValue value)
+		{
+			return value <= completedValue || value <= GetCompletedValue();
+		}
+
+		TimelineValue QueueTimeline::GetCompletedValue()
+		{
+			if (completedValue < lastSubmittedValue)
+			{
+				VK_CHECK(vkGetSemaphoreCounterValue(device.GetVkDevice(), semaphore, &completedValue), "reading timeline semaphore value");
+			}
+			return completedValue;
+		}
+
+		void QueueTimeline::Wait(const TimelineValue value)
+		{
+			if (IsComplete(value))
+			{
+				return;
+			}
+
+			VkSemaphoreWaitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+			waitInfo.semaphoreCount = 1;
+			waitInfo.pSemaphores = &semaphore;
+			waitInfo.pValues = &value;
+			VK_CHECK(vkWaitSemaphores(device.GetVkDevice(), &waitInfo, UINT64_MAX), "waiting on timeline semaphore");
+			completedValue = value;
+		}
+	}
+}
@@ -0,0 +1,65 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_QUEUE_TIMELINE_H
+#define BAAL_VK_QUEUE_TIMELINE_H
+
+#include <vulkan/vulkan_core.h>
+#include <vector>
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+
+		// Value a QueueTimeline reaches once a submission has finished, 0 is never handed out and is always complete
+		using TimelineValue = uint64_t;
+
+		// A semaphore for a submission to wait on, value is ignored for binary semaphores such as the swap chain's
+		struct SemaphoreWait
+		{
+			VkSemaphore semaphore{ VK_NULL_HANDLE };
+			TimelineValue value = 0;
+			VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		};
+
+		// Every submission to a queue goes through its timeline, and signals the next value of a Vulkan 1.2 timeline semaphore
+		// Values only ever increase and a queue finishes its submissions in order, so one value says everything before it finished too.
+		// Work that used a resource is tracked by the value of its submission, waiting on that value replaces a fence or a queue idle wait
+		class QueueTimeline
+		{
+		public:
+			explicit QueueTimeline(LogicalDevice& _device, VkQueue _queue);
+			QueueTimeline(const QueueTimeline&) = delete;
+			QueueTimeline(QueueTimeline&&) = delete;
+
+			~QueueTimeline();
+
+			QueueTimeline& operator=(const QueueTimeline&) = delete;
+			QueueTimeline& operator = (QueueTimeline&&) = delete;
+
+			// Returns the value the timeline reaches once the command buffers have finished
+			// Binary semaphores can be signaled alongside, presentation only accepts binary semaphores
+			TimelineValue Submit(const std::vector<VkCommandBuffer>& commandBuffers, const std::vector<SemaphoreWait>& waits = {}, const std::vector<VkSemaphore>& binarySignals = {});
+
+			// Non-blocking, only queries the semaphore when the last known value is behind
+			bool IsComplete(const TimelineValue value);
+			TimelineValue GetCompletedValue();
+			void Wait(const TimelineValue value);
+			void WaitIdle() { Wait(lastSubmittedValue); }
+
+			VkSemaphore& GetVkSemaphore() { return semaphore; }
+			VkQueue& GetVkQueue() { return queue; }
+			TimelineValue GetLastSubmittedValue() const { return lastSubmittedValue; }
+
+		private:
+			LogicalDevice& device;
+			VkQueue queue{ VK_NULL_HANDLE };
+			VkSemaphore semaphore{ VK_NULL_HANDLE };
+			TimelineValue lastSubmittedValue = 0;
+			TimelineValue completedValue = 0;	// Last value read back from the semaphore
+		};
+	}
+}
+
+#endif // !BAAL_VK_QUEUE_TIMELINE_H
@@ -0,0 +1,226 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "BindlessTable.h"
+
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/resource/Buffer.h"
+#include "../src/core/vulkan/resource/Image.h"
+#include "../src/core/vulkan/resource/Sampler.h"
+#include "../src/core/vulkan/resource/Uploader.h"
+#include "../src/core/vulkan/resource/DeletionQueue.h"
+#include "../src/core/vulkan/descriptors/DescriptorPool.h"
+#include "../src/core/vulkan/descriptors/DescriptorSetLayout.h"
+#include "../src/core/vulkan/descriptors/DescriptorSet.h"
+#include "../src/core/3d/Texture.h"
+#include "../src/utility/DebugLog.h"
+
+#include <stdexcept>
+
+namespace Baal
+{
+	namespace VK
+	{
+		static_assert(sizeof(GPUMaterial) == 64, "GPUMaterial must match the std430 layout of Material in the bindless shaders");
+
+		namespace
+		{
+			constexpr uint32_t TEXTURE_BINDING = 0;
+			constexpr uint32_t MATERIAL_BINDING = 1;
+			constexpr VkShaderStageFlags MATERIAL_SHADER_STAGES = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+			constexpr VkPipelineStageFlags MATERIAL_STAGES = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		}
+
+		BindlessTable::BindlessTable(LogicalDevice& _device, const uint32_t _maxTextures /*= BAAL_BINDLESS_MAX_TEXTURES*/, const uint32_t _maxMaterials /*= BAAL_BINDLESS_MAX_MATERIALS*/):
+			device(_device),
+			textureSlots(std::make_shared<SlotAllocator>(_maxTextures)),
+			materialSlots(std::make_shared<SlotAllocator>(_maxMaterials))
+		{
+			materialBuffer = std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(GPUMaterial) * _maxMaterials);
+
+			std::vector<DescriptorPoolSize> poolSizes;
+			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _maxTextures));
+			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1));
+			descriptorPool = std::make_unique<DescriptorPool>(device, poolSizes, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+
+			// Unused texture slots are never written, partially bound lets them stay empty as long as no shader reads them
+			const VkDescriptorBindingFlags textureFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+
+			std::vector<DescriptorSetBinding> bindings;
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, TEXTURE_BINDING, _maxTextures, textureFlags));
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MATERIAL_SHADER_STAGES, MATERIAL_BINDING, 1));
+			descriptorSetLayout = std::make_unique<DescriptorSetLayout>(device, bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT);
+
+			descriptorSet = std::make_unique<DescriptorSet>(device, *descriptorPool.get(), *descriptorSetLayout.get());
+
+			VkDescriptorBufferInfo materialInfo{};
+			materialInfo.buffer = materialBuffer->GetVkBuffer();
+			materialInfo.offset = 0;
+			materialInfo.range = materialBuffer->GetSize();
+
+			VkWriteDescriptorSet materialWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			materialWrite.dstSet = descriptorSet->GetVkDescriptorSet();
+			materialWrite.dstBinding = MATERIAL_BINDING;
+			materialWrite.dstArrayElement = 0;
+			materialWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			materialWrite.descriptorCount = 1;
+			materialWrite.pBufferInfo = &materialInfo;
+			vkUpdateDescriptorSets(device.GetVkDevice(), 1, &materialWrite, 0, nullptr);
+
+			DEBUG_LOG(LOG::INFO, "Created bindless table, {} textures, {} materials", _maxTextures, _maxMaterials);
+		}
+
+		BindlessTable::~BindlessTable()
+		{
+			descriptorSet.reset();
+			descriptorSetLayout.reset();
+			descriptorPool.reset();
+			materialBuffer.reset();
+		}
+
+		bool BindlessTable::IsSupported(const LogicalDevice& device)
+		{
+			const VkPhysicalDeviceVulkan12Features& features = device.GetEnabledVulkan12Features();
+			return features.runtimeDescriptorArray == VK_TRUE &&
+				features.descriptorBindingPartiallyBound == VK_TRUE &&
+				features.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+				features.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
+		}
+
+		uint32_t BindlessTable::AddTexture(TextureInstance& texture, Sampler& sampler)
+		{
+			if (texture.bindlessIndex != SlotAllocator::INVALID_SLOT)
+			{
+				return texture.bindlessIndex;
+			}
+
+			const uint32_t slot = textureSlots->Allocate();
+			if (slot == SlotAllocator::INVALID_SLOT)
+			{
+				DEBUG_LOG(LOG::ERRORLOG, "Failed to add texture to bindless table! All {} slots are in use, increase BAAL_BINDLESS_MAX_TEXTURES", textureSlots->GetCapacity());
+				throw std::runtime_error("Failed to add texture to bindless table! All slots are in use");
+			}
+
+			WriteTexture(slot, texture, sampler);
+			if (defaultTextureIndex == SlotAllocator::INVALID_SLOT)
+			{
+				defaultTextureIndex = slot;
+			}
+
+			texture.bindlessIndex = slot;
+			return slot;
+		}
+
+		void BindlessTable::RemoveTexture(TextureInstance& texture)
+		{
+			if (texture.bindlessIndex == SlotAllocator::INVALID_SLOT)
+			{
+				return;
+			}
+
+			// Frames in flight may still sample the slot, it is only rewritten once they have finished
+			std::shared_ptr<SlotAllocator> slots = textureSlots;
+			const uint32_t slot = texture.bindlessIndex;
+			device.GetDeletionQueue().Push([slots, slot]() { slots->Free(slot); });
+			texture.bindlessIndex = SlotAllocator::INVALID_SLOT;
+
+			if (defaultTextureIndex == slot)
+			{
+				defaultTextureIndex = SlotAllocator::INVALID_SLOT;
+			}
+		}
+
+		uint32_t BindlessTable::UpdateTexture(TextureInstance& texture, Sampler& sampler)
+		{
+			const uint32_t oldSlot = texture.bindlessIndex;
+			if (oldSlot == SlotAllocator::INVALID_SLOT)
+			{
+				return AddTexture(texture, sampler);
+			}
+
+			// Rewriting the slot in place would change what frames in flight sample, which update after bind does not allow for in use descriptors
+			texture.bindlessIndex = SlotAllocator::INVALID_SLOT;
+			const uint32_t newSlot = AddTexture(texture, sampler);
+
+			std::shared_ptr<SlotAllocator> slots = textureSlots;
+			device.GetDeletionQueue().Push([slots, oldSlot]() { slots->Free(oldSlot); });
+
+			if (defaultTextureIndex == oldSlot)
+			{
+				defaultTextureIndex = newSlot;
+			}
+
+			for (uint32_t materialIndex = 0; materialIndex < static_cast<uint32_t>(materials.size()); ++materialIndex)
+			{
+				if (materials[materialIndex].textureIndex == oldSlot)
+				{
+					UpdateMaterial(materialIndex, materials[materialIndex].material, newSlot);
+				}
+			}
+
+			return newSlot;
+		}
+
+		void BindlessTable::WriteTexture(const uint32_t slot, TextureInstance& texture, Sampler& sampler)
+		{
+			VkDescriptorImageInfo imageInfo{};
+			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			imageInfo.imageView = texture.GetImage().GetVkImageView();
+			imageInfo.sampler = sampler.GetVkSampler();
+
+			VkWriteDescriptorSet imageWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			imageWrite.dstSet = descriptorSet->GetVkDescriptorSet();
+			imageWrite.dstBinding = TEXTURE_BINDING;
+			imageWrite.dstArrayElement = slot;
+			imageWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			imageWrite.descriptorCount = 1;
+			imageWrite.pImageInfo = &imageInfo;
+			vkUpdateDescriptorSets(device.GetVkDevice(), 1, &imageWrite, 0, nullptr);
+		}
+
+		uint32_t BindlessTable::AddMaterial(const Material& material, const uint32_t textureIndex /*= SlotAllocator::INVALID_SLOT*/)
+		{
+			const uint32_t slot = materialSlots->Allocate();
+			if (slot == SlotAllocator::INVALID_SLOT)
+			{
+				DEBUG_LOG(LOG::ERRORLOG, "Failed to add material to bindless table! All {} slots are in use, increase BAAL_BINDLESS_MAX_MATERIALS", materialSlots->GetCapacity());
+				throw std::runtime_error("Failed to add material to bindless table! All slots are in use");
+			}
+
+			UpdateMaterial(slot, material, textureIndex);
+			return slot;
+		}
+
+		void BindlessTable::UpdateMaterial(const uint32_t materialIndex, const Material& material, const uint32_t textureIndex /*= SlotAllocator::INVALID_SLOT*/)
+		{
+			GPUMaterial gpuMaterial;
+			gpuMaterial.material = material;
+			gpuMaterial.textureIndex = textureIndex != SlotAllocator::INVALID_SLOT ? textureIndex : defaultTextureIndex;
+			if (gpuMaterial.textureIndex == SlotAllocator::INVALID_SLOT)
+			{
+				// No texture added yet, slot 0 is the first one to be written
+				gpuMaterial.textureIndex = 0;
+			}
+
+			if (materialIndex >= materials.size())
+			{
+				materials.resize(materialIndex + 1);
+			}
+			materials[materialIndex] = gpuMaterial;
+
+			// The slot may be read by frames in flight, e.g. when UpdateTexture() moves a material, so the write is ordered against them on the GPU
+			device.GetUploader().UploadBufferInUse(*materialBuffer.get(), &gpuMaterial, sizeof(GPUMaterial), sizeof(GPUMaterial) * materialIndex, MATERIAL_STAGES, VK_ACCESS_SHADER_READ_BIT);
+		}
+
+		void BindlessTable::RemoveMaterial(const uint32_t materialIndex)
+		{
+			// Keeps UpdateTexture() from moving a removed material
+			if (materialIndex < materials.size())
+			{
+				materials[materialIndex].textureIndex = SlotAllocator::INVALID_SLOT;
+			}
+
+			std::shared_ptr<SlotAllocator> slots = materialSlots;
+			device.GetDeletionQueue().Push([slots, materialIndex]() { slots->Free(materialIndex); });
+		}
+	}
+}
@@ -0,0 +1,99 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_BINDLESS_TABLE_H
+#define BAAL_VK_BINDLESS_TABLE_H
+
+#include <vulkan/vulkan_core.h>
+#include <memory>
+#include <vector>
+
+#include "../src/core/3d/Mesh.h"
+#include "../src/utility/SlotAllocator.h"
+
+#ifndef BAAL_BINDLESS_MAX_TEXTURES
+#define BAAL_BINDLESS_MAX_TEXTURES 4096		// Size of the texture array, must match the shaders
+#endif // !BAAL_BINDLESS_MAX_TEXTURES
+
+#ifndef BAAL_BINDLESS_MAX_MATERIALS
+#define BAAL_BINDLESS_MAX_MATERIALS 16384
+#endif // !BAAL_BINDLESS_MAX_MATERIALS
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+		class Buffer;
+		class Sampler;
+		class TextureInstance;
+		class DescriptorPool;
+		class DescriptorSetLayout;
+		class DescriptorSet;
+
+		// A material as the shaders read it from the material table, laid out to match std430
+		struct GPUMaterial
+		{
+			Material material;
+			uint32_t textureIndex = 0;	// Into the texture array
+			uint32_t padding[3] = { 0, 0, 0 };
+		};
+
+		// Every texture and material in one descriptor set, bound once and indexed from the shaders
+		// Binding 0 is a partially bound array of combined image samplers, binding 1 a storage buffer of GPUMaterials.
+		// Draws only push the index of their material, the material holds the index of its texture.
+		//
+		// The set is allocated from an update after bind pool, so slots can be written while frames in flight use the set.
+		// Freed slots are only handed out again once those frames have finished, see DeletionQueue
+		class BindlessTable
+		{
+		public:
+			explicit BindlessTable(LogicalDevice& _device, const uint32_t _maxTextures = BAAL_BINDLESS_MAX_TEXTURES, const uint32_t _maxMaterials = BAAL_BINDLESS_MAX_MATERIALS);
+			BindlessTable(const BindlessTable&) = delete;
+			BindlessTable(BindlessTable&&) = delete;
+
+			~BindlessTable();
+
+			BindlessTable& operator=(const BindlessTable&) = delete;
+			BindlessTable& operator = (BindlessTable&&) = delete;
+
+			// Requires the descriptor indexing features enabled by LogicalDevice
+			static bool IsSupported(const LogicalDevice& device);
+
+			// Writes the texture into a free slot of the texture array, see TextureInstance::GetBindlessIndex()
+			// Throws when the array is full
+			uint32_t AddTexture(TextureInstance& texture, Sampler& sampler);
+			void RemoveTexture(TextureInstance& texture);
+
+			// Moves the texture to a new slot after its image was replaced, e.g. once an asynchronously loaded texture is resident
+			// The old slot is left untouched for frames in flight, materials pointing at it are moved along with the texture
+			uint32_t UpdateTexture(TextureInstance& texture, Sampler& sampler);
+
+			// Throws when the table is full
+			// Without a texture index materials use the default texture, the first texture added
+			uint32_t AddMaterial(const Material& material, const uint32_t textureIndex = SlotAllocator::INVALID_SLOT);
+			// Rewrites the slot in place, the write is ordered after the reads of frames in flight on the graphics queue, see Uploader::UploadBufferInUse()
+			void UpdateMaterial(const uint32_t materialIndex, const Material& material, const uint32_t textureIndex = SlotAllocator::INVALID_SLOT);
+			void RemoveMaterial(const uint32_t materialIndex);
+
+			DescriptorSetLayout& GetDescriptorSetLayout() { return *descriptorSetLayout.get(); }
+			DescriptorSet& GetDescriptorSet() { return *descriptorSet.get(); }
+
+		private:
+			void WriteTexture(const uint32_t slot, TextureInstance& texture, Sampler& sampler);
+
+			LogicalDevice& device;
+			std::shared_ptr<SlotAllocator> textureSlots;	// Shared with the DeletionQueue callbacks that free slots, which may outlive the table
+			std::shared_ptr<SlotAllocator> materialSlots;
+
+			uint32_t defaultTextureIndex = SlotAllocator::INVALID_SLOT;
+			std::vector<GPUMaterial> materials;	// Copy of the material table, for remapping texture indices without reading back the buffer
+
+			std::unique_ptr<Buffer> materialBuffer;
+			std::unique_ptr<DescriptorPool> descriptorPool;
+			std::unique_ptr<DescriptorSetLayout> descriptorSetLayout;
+			std::unique_ptr<DescriptorSet> descriptorSet;
+		};
+	}
+}
+
+#endif // !BAAL_VK_BINDLESS_TABLE_H
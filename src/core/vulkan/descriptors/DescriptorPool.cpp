@@ -8,7 +8,7 @@ namespace Baal
 {
 	namespace VK
 	{
-		DescriptorPool::DescriptorPool(LogicalDevice& _device, const std::vector<DescriptorPoolSize>& poolSizes):
+		DescriptorPool::DescriptorPool(LogicalDevice& _device, const std::vector<DescriptorPoolSize>& poolSizes, const VkDescriptorPoolCreateFlags flags /*= 0*/):
 			device(_device)
 		{
 			VkDescriptorPoolCreateInfo poolInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
@@ -26,6 +26,7 @@ namespace Baal
 			poolInfo.poolSizeCount = descriptorPoolSizes.size();
 			poolInfo.pPoolSizes = descriptorPoolSizes.data();
 			poolInfo.maxSets = 10;
+			poolInfo.flags = flags;
 			
 			VK_CHECK(vkCreateDescriptorPool(device.GetVkDevice(), &poolInfo, nullptr, &vkDescriptorPool), "creating descriptor pool");
 		}
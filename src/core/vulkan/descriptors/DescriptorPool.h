@@ -22,7 +22,7 @@ namespace Baal
 		class DescriptorPool
 		{
 		public:
-			explicit DescriptorPool(LogicalDevice& _device, const std::vector<DescriptorPoolSize>& poolSizes);
+			explicit DescriptorPool(LogicalDevice& _device, const std::vector<DescriptorPoolSize>& poolSizes, const VkDescriptorPoolCreateFlags flags = 0);
 
 			DescriptorPool(const DescriptorPool&) = delete;
 			DescriptorPool(DescriptorPool&&) = delete;
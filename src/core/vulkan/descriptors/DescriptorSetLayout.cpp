@@ -9,10 +9,12 @@ namespace Baal
 {
 	namespace VK
 	{
-		DescriptorSetLayout::DescriptorSetLayout(LogicalDevice& _device, std::vector<DescriptorSetBinding> bindings): 
+		DescriptorSetLayout::DescriptorSetLayout(LogicalDevice& _device, std::vector<DescriptorSetBinding> bindings, const VkDescriptorSetLayoutCreateFlags flags /*= 0*/): 
 			device(_device)
 		{
 			std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+			std::vector<VkDescriptorBindingFlags> bindingFlags;
+			bool bHasBindingFlags = false;
 
 			for (size_t i = 0; i < bindings.size(); ++i)
 			{
@@ -24,11 +26,23 @@ namespace Baal
 				layoutBinding.pImmutableSamplers = nullptr;
 
 				layoutBindings.push_back(layoutBinding);
+				bindingFlags.push_back(bindings[i].flags);
+				bHasBindingFlags |= bindings[i].flags != 0;
 			}
 
 			VkDescriptorSetLayoutCreateInfo descritptorSetLayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
 			descritptorSetLayoutInfo.bindingCount = layoutBindings.size();
 			descritptorSetLayoutInfo.pBindings = layoutBindings.data();
+			descritptorSetLayoutInfo.flags = flags;
+
+			// Only chained when used, so layouts without descriptor indexing work on devices without it
+			VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+			if (bHasBindingFlags)
+			{
+				bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+				bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+				descritptorSetLayoutInfo.pNext = &bindingFlagsInfo;
+			}
 
 			VK_CHECK(vkCreateDescriptorSetLayout(device.GetVkDevice(), &descritptorSetLayoutInfo, nullptr, &vkDescriptorSetLayout), "creating descriptor set layout");
 		}
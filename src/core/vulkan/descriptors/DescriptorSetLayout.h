@@ -18,12 +18,13 @@ namespace Baal
 			VkShaderStageFlags stage;
 			uint32_t binding;
 			uint32_t count;
+			VkDescriptorBindingFlags flags = 0;	// Descriptor indexing flags, e.g. partially bound or update after bind
 		};
 
 		class DescriptorSetLayout
 		{
 		public:
-			explicit DescriptorSetLayout(LogicalDevice& _device, std::vector<DescriptorSetBinding> bindings);
+			explicit DescriptorSetLayout(LogicalDevice& _device, std::vector<DescriptorSetBinding> bindings, const VkDescriptorSetLayoutCreateFlags flags = 0);
 
 			DescriptorSetLayout(const DescriptorSetLayout&) = delete;
 			DescriptorSetLayout(DescriptorSetLayout&&) = delete;
@@ -9,14 +9,16 @@
 #include "../src/core/vulkan/commands/CommandPool.h"
 #include "../src/core/vulkan/commands/CommandBuffer.h"
 #include "../src/core/vulkan/resource/Allocator.h"
-#include "../src/core/vulkan/resource/Buffer.h"
-#include "../src/core/vulkan/resource/Image.h"
+#include "../src/core/vulkan/resource/Uploader.h"
+#include "../src/core/vulkan/pipeline/PipelineCache.h"
+#include "../src/core/vulkan/resource/DeletionQueue.h"
+#include "../src/core/vulkan/commands/QueueTimeline.h"
 
 namespace Baal
 {
 	namespace VK
 	{
-		LogicalDevice::LogicalDevice(Instance& instance, Surface& surface, const std::vector<const char*>& requiredExtensions):
+		LogicalDevice::LogicalDevice(Instance& instance, Surface* surface, const std::vector<const char*>& requiredExtensions):
 			physicalDevice(instance.GetGPU())
 		{
 			std::vector<VkDeviceQueueCreateInfo> deviceQueueInfos;
@@ -69,14 +71,46 @@ namespace Baal
 			deviceInfo.enabledExtensionCount = enabledExts.size();
 			deviceInfo.ppEnabledExtensionNames = enabledExts.data();
 
+			EnableSupportedFeatures();
+
+			// Vulkan 1.2 features can only be chained in through VkPhysicalDeviceFeatures2
+			VkPhysicalDeviceFeatures2 features2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+			if (physicalDevice.GetProperties().apiVersion >= VK_API_VERSION_1_2)
+			{
+				features2.features = enabledFeatures;
+				features2.pNext = &enabledVulkan12Features;
+				deviceInfo.pNext = &features2;
+			}
+			else
+			{
+				deviceInfo.pEnabledFeatures = &enabledFeatures;
+			}
+
 			VK_CHECK(vkCreateDevice(physicalDevice.GetVkPhysicalDevice(), &deviceInfo, nullptr, &device), "creating device");
+			enabledVulkan12Features.pNext = nullptr;
+
+			graphicsQueueFamilyIndex = physicalDevice.GetQueueFamilyIndex(VK_QUEUE_GRAPHICS_BIT);
+			vkGetDeviceQueue(device, graphicsQueueFamilyIndex, 0, &graphicsQueue);
 
-			vkGetDeviceQueue(device, physicalDevice.GetQueueFamilyIndex(VK_QUEUE_GRAPHICS_BIT), 0, &graphicsQueue);
+			// Prefer a transfer only family (usually a DMA engine), then any non graphics family that can transfer
+			// Without either, uploads share the graphics queue
+			if (physicalDevice.TryGetDedicatedQueueFamilyIndex(VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, transferQueueFamilyIndex) ||
+				physicalDevice.TryGetDedicatedQueueFamilyIndex(VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT, transferQueueFamilyIndex))
+			{
+				vkGetDeviceQueue(device, transferQueueFamilyIndex, 0, &transferQueue);
+				DEBUG_LOG(LOG::INFO, "Using dedicated transfer queue family: {}", transferQueueFamilyIndex);
+			}
+			else
+			{
+				transferQueueFamilyIndex = graphicsQueueFamilyIndex;
+				transferQueue = graphicsQueue;
+				DEBUG_LOG(LOG::INFO, "No dedicated transfer queue family, uploads will use the graphics queue");
+			}
 			
-			for (uint32_t i = 0; i < queueFamilyCount; ++i) 
+			for (uint32_t i = 0; surface != nullptr && i < queueFamilyCount; ++i) 
 			{
 				VkBool32 presentSupport = false;
-				vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice.GetVkPhysicalDevice(), i, surface.GetVkSurface(), &presentSupport);
+				vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice.GetVkPhysicalDevice(), i, surface->GetVkSurface(), &presentSupport);
 
 				if (presentSupport) {
 					vkGetDeviceQueue(device, i, 0, &presentQueue);
@@ -84,12 +118,31 @@ namespace Baal
 				}
 			}
 
-			commandPool = std::make_unique<CommandPool>(*this, physicalDevice.GetQueueFamilyIndex(VK_QUEUE_GRAPHICS_BIT));
+			graphicsTimeline = std::make_unique<QueueTimeline>(*this, graphicsQueue);
+			if (HasDedicatedTransferQueue())
+			{
+				transferTimeline = std::make_unique<QueueTimeline>(*this, transferQueue);
+			}
+
+			commandPool = std::make_unique<CommandPool>(*this, graphicsQueueFamilyIndex);
+			if (HasDedicatedTransferQueue())
+			{
+				transferCommandPool = std::make_unique<CommandPool>(*this, transferQueueFamilyIndex);
+			}
 			allocator = std::make_unique<Allocator>(instance, *this);
+			uploader = std::make_unique<Uploader>(*this);
+			pipelineCache = std::make_unique<PipelineCache>(*this, physicalDevice);
+			deletionQueue = std::make_unique<DeletionQueue>();
 		}
 
 		LogicalDevice::~LogicalDevice()
 		{
+			deletionQueue.reset();	// Only safe once the device is idle, the renderer waits for it on shutdown
+			pipelineCache.reset();	// Serializes the cache to disk
+			uploader.reset();
+			transferTimeline.reset();
+			graphicsTimeline.reset();
+			transferCommandPool.reset();
 			commandPool.reset();
 			allocator.reset();
 			vkDestroyDevice(device, nullptr);
@@ -124,50 +177,14 @@ namespace Baal
 		{
 			commandBuffer.EndRecording();
 
-			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
-			submitInfo.commandBufferCount = 1;
-			submitInfo.pCommandBuffers = &commandBuffer.GetVkCommandBuffer();
-
-			VK_CHECK(vkQueueSubmit(queue, 1, &submitInfo, nullptr), "flushing command buffer");
-			VK_CHECK(vkQueueWaitIdle(queue), "waiting queue idle");
-		}
-
-		void LogicalDevice::CopyBuffer(Buffer& source, Buffer& destination, VkDeviceSize size)
-		{
-			CommandBuffer commandBuffer(CreateCommandBuffer());
-
-			VkBufferCopy copyRegion{};
-			copyRegion.size = size;
-			vkCmdCopyBuffer(commandBuffer.GetVkCommandBuffer(), source.GetVkBuffer(), destination.GetVkBuffer(), 1, &copyRegion);
-
-			FlushCommandBuffer(commandBuffer, GetGraphicsQueue());
-		}
-
-		void LogicalDevice::CopyBufferToImage(Buffer& source, Image& destination, const uint32_t width, const uint32_t height)
-		{
-			CommandBuffer commandBuffer(CreateCommandBuffer());
-
-			VkBufferImageCopy copyRegion{};
-			
-			copyRegion.bufferOffset = 0;
-			copyRegion.bufferRowLength = 0;
-			copyRegion.bufferImageHeight = 0;
-
-			copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			copyRegion.imageSubresource.mipLevel = 0;
-			copyRegion.imageSubresource.baseArrayLayer = 0;
-			copyRegion.imageSubresource.layerCount = 1;
-
-			copyRegion.imageOffset = {0, 0, 0};
-			copyRegion.imageExtent = {
-				width,
-				height,
-				1
-			};
-
-			vkCmdCopyBufferToImage(commandBuffer.GetVkCommandBuffer(), source.GetVkBuffer(), destination.GetVkImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+			QueueTimeline& timeline = (HasDedicatedTransferQueue() && queue == transferQueue) ? *transferTimeline.get() : *graphicsTimeline.get();
+			if (queue != timeline.GetVkQueue())
+			{
+				DEBUG_LOG(LOG::ERRORLOG, "Failed to flush command buffer! Only the graphics and transfer queues have a timeline");
+				throw std::runtime_error("Failed to flush command buffer, the queue has no timeline");
+			}
 
-			FlushCommandBuffer(commandBuffer, GetGraphicsQueue());
+			timeline.Wait(timeline.Submit({ commandBuffer.GetVkCommandBuffer() }));
 		}
 
 		void LogicalDevice::QueryAvailableExtensions(std::vector<VkExtensionProperties>& outExtensions) const
@@ -185,6 +202,42 @@ namespace Baal
 			}
 		}
 
+		void LogicalDevice::EnableSupportedFeatures()
+		{
+			const VkPhysicalDeviceFeatures& supported = physicalDevice.GetFeatures();
+			const VkPhysicalDeviceVulkan12Features& supported12 = physicalDevice.GetVulkan12Features();
+
+			// GPU driven rendering, see IndirectDrawPass
+			enabledFeatures.multiDrawIndirect = supported.multiDrawIndirect;
+			enabledFeatures.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+			enabledVulkan12Features.drawIndirectCount = supported12.drawIndirectCount;
+
+			// Bindless textures and materials, see BindlessTable
+			enabledVulkan12Features.descriptorIndexing = supported12.descriptorIndexing;
+			enabledVulkan12Features.runtimeDescriptorArray = supported12.runtimeDescriptorArray;
+			enabledVulkan12Features.descriptorBindingPartiallyBound = supported12.descriptorBindingPartiallyBound;
+			enabledVulkan12Features.descriptorBindingSampledImageUpdateAfterBind = supported12.descriptorBindingSampledImageUpdateAfterBind;
+			enabledVulkan12Features.shaderSampledImageArrayNonUniformIndexing = supported12.shaderSampledImageArrayNonUniformIndexing;
+
+			// Pre-compressed BC textures, see TextureFile
+			enabledFeatures.textureCompressionBC = supported.textureCompressionBC;
+
+			// Every queue submission signals a timeline semaphore, see QueueTimeline
+			if (supported12.timelineSemaphore != VK_TRUE)
+			{
+				DEBUG_LOG(LOG::ERRORLOG, "Failed to create logical device! Timeline semaphores are required, the GPU must support Vulkan 1.2");
+				throw std::runtime_error("Timeline semaphores are not supported");
+			}
+			enabledVulkan12Features.timelineSemaphore = VK_TRUE;
+
+			DEBUG_LOG(LOG::INFO, "Multi draw indirect: {}, Draw indirect first instance: {}, Draw indirect count: {}, Descriptor indexing: {}, BC texture compression: {}",
+				enabledFeatures.multiDrawIndirect == VK_TRUE,
+				enabledFeatures.drawIndirectFirstInstance == VK_TRUE,
+				enabledVulkan12Features.drawIndirectCount == VK_TRUE,
+				enabledVulkan12Features.descriptorIndexing == VK_TRUE,
+				enabledFeatures.textureCompressionBC == VK_TRUE);
+		}
+
 		bool LogicalDevice::IsExtensionAvailable(const char* extensionName, const std::vector<VkExtensionProperties>& extensions) const
 		{
 			for (auto& availableExtension : extensions)
@@ -17,15 +17,18 @@ namespace Baal
 		class CommandPool;
 		class CommandBuffer;
 		class Allocator;
-		class Buffer;
-		class Image;
+		class Uploader;
+		class PipelineCache;
+		class DeletionQueue;
+		class QueueTimeline;
 
 		// The interface that is used to interact with the vkPhysicalDevice
 		
 		class LogicalDevice
 		{
 		public:
-			explicit LogicalDevice(Instance& instance, Surface& surface, const std::vector<const char*>& requiredExtensions = {});
+			// Surface can be nullptr when rendering headless, in that case no present queue is fetched
+			explicit LogicalDevice(Instance& instance, Surface* surface, const std::vector<const char*>& requiredExtensions = {});
 			LogicalDevice(const LogicalDevice&) = delete;
 			LogicalDevice(LogicalDevice&&) = delete;
 
@@ -35,30 +38,55 @@ namespace Baal
 			LogicalDevice& operator = (LogicalDevice&&) = delete;
 
 			VkDevice& GetVkDevice() { return device; }
+			const PhysicalDevice& GetPhysicalDevice() const { return physicalDevice; }
 			VkQueue& GetGraphicsQueue() { return graphicsQueue; };
 			VkQueue& GetPresentQueue() { return presentQueue; };
+			VkQueue& GetTransferQueue() { return transferQueue; };	// Same as the graphics queue when there is no dedicated transfer family
+			uint32_t GetGraphicsQueueFamilyIndex() const { return graphicsQueueFamilyIndex; }
+			uint32_t GetTransferQueueFamilyIndex() const { return transferQueueFamilyIndex; }
+			bool HasDedicatedTransferQueue() const { return graphicsQueueFamilyIndex != transferQueueFamilyIndex; }
+			QueueTimeline& GetGraphicsTimeline() { return *graphicsTimeline.get(); }
+			QueueTimeline& GetTransferTimeline() { return HasDedicatedTransferQueue() ? *transferTimeline.get() : *graphicsTimeline.get(); }
 			CommandPool& GetCommandPool() { return *commandPool.get(); }
+			CommandPool& GetTransferCommandPool() { return HasDedicatedTransferQueue() ? *transferCommandPool.get() : *commandPool.get(); }
 			Allocator& GetAllocator() { return *allocator.get(); }
+			Uploader& GetUploader() { return *uploader.get(); }
+			PipelineCache& GetPipelineCache() { return *pipelineCache.get(); }
+			DeletionQueue& GetDeletionQueue() { return *deletionQueue.get(); }	// Frame numbers are driven by the Renderer
+
+			// Optional features are only enabled when the GPU supports them, check these before relying on one
+			const VkPhysicalDeviceFeatures& GetEnabledFeatures() const { return enabledFeatures; }
+			const VkPhysicalDeviceVulkan12Features& GetEnabledVulkan12Features() const { return enabledVulkan12Features; }
 
 			uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
 
 			CommandBuffer CreateCommandBuffer(bool bBeginCommand = true);
+			// Submits through the queue's timeline and waits only on that submission, not the whole queue
 			void FlushCommandBuffer(CommandBuffer& commandBuffer, VkQueue queue);
 
-			void CopyBuffer(Buffer& source, Buffer& destination, VkDeviceSize size);
-			void CopyBufferToImage(Buffer& source, Image& destination, const uint32_t width, const uint32_t height);
-
 		private:
 			const PhysicalDevice& physicalDevice;
 			VkDevice device{ VK_NULL_HANDLE };
 			VkQueue graphicsQueue{ VK_NULL_HANDLE };
 			VkQueue presentQueue{ VK_NULL_HANDLE };
+			VkQueue transferQueue{ VK_NULL_HANDLE };
+			uint32_t graphicsQueueFamilyIndex = 0;
+			uint32_t transferQueueFamilyIndex = 0;
 			std::vector<const char*> enabledExtensions;
+			VkPhysicalDeviceFeatures enabledFeatures{};
+			VkPhysicalDeviceVulkan12Features enabledVulkan12Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+			std::unique_ptr<QueueTimeline> graphicsTimeline;
+			std::unique_ptr<QueueTimeline> transferTimeline;	// Only with a dedicated transfer queue
 			std::unique_ptr<CommandPool> commandPool;
+			std::unique_ptr<CommandPool> transferCommandPool;
 			std::unique_ptr<Allocator> allocator;
+			std::unique_ptr<Uploader> uploader;
+			std::unique_ptr<PipelineCache> pipelineCache;
+			std::unique_ptr<DeletionQueue> deletionQueue;
 
 			void QueryAvailableExtensions(std::vector<VkExtensionProperties>& outExtensions) const;
 			bool IsExtensionAvailable(const char* extensionName, const std::vector<VkExtensionProperties>& extensions) const;
+			void EnableSupportedFeatures();
 		};
 	}
 }
@@ -13,6 +13,19 @@ namespace Baal
 			vkGetPhysicalDeviceProperties(vkPhysicalDevice, &properties);
 			DEBUG_LOG(LOG::INFO, "Found GPU: \"{}\"", properties.deviceName);
 
+			if (properties.apiVersion >= VK_API_VERSION_1_2)
+			{
+				VkPhysicalDeviceFeatures2 features2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+				features2.pNext = &vulkan12Features;
+				vkGetPhysicalDeviceFeatures2(vkPhysicalDevice, &features2);
+				features = features2.features;
+			}
+			else
+			{
+				vkGetPhysicalDeviceFeatures(vkPhysicalDevice, &features);
+			}
+			vulkan12Features.pNext = nullptr;
+
 			uint32_t count;
 			vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice, &count, nullptr);
 			queueFamilyProperties.resize(count);
@@ -54,6 +67,20 @@ namespace Baal
 			throw std::runtime_error("Could not find matching queue family index");
 		}
 
+		bool PhysicalDevice::TryGetDedicatedQueueFamilyIndex(VkQueueFlags flags, VkQueueFlags excludedFlags, uint32_t& outIndex) const
+		{
+			uint32_t size = queueFamilyProperties.size();
+			for (uint32_t i = 0; i < size; ++i)
+			{
+				if ((queueFamilyProperties[i].queueFlags & flags) == flags && (queueFamilyProperties[i].queueFlags & excludedFlags) == 0)
+				{
+					outIndex = i;
+					return true;
+				}
+			}
+			return false;
+		}
+
 		VkFormat PhysicalDevice::GetSuitableDepthFormat(const std::vector<VkFormat>& inDepthformats)
 		{
 			VkFormat depthFormat = VK_FORMAT_UNDEFINED;
@@ -79,5 +106,22 @@ namespace Baal
 
 			throw std::runtime_error("No suitable depth format could be determined");
 		}
+
+		bool PhysicalDevice::IsFormatSupported(const VkFormat format, const VkFormatFeatureFlags requiredFeatures) const
+		{
+			VkFormatProperties formatProperties;
+			vkGetPhysicalDeviceFormatProperties(vkPhysicalDevice, format, &formatProperties);
+			return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+		}
+
+		bool PhysicalDevice::IsTextureFormatSupported(const VkFormat format) const
+		{
+			const bool bBlockCompressed = format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+			if (bBlockCompressed && features.textureCompressionBC != VK_TRUE)
+			{
+				return false;
+			}
+			return IsFormatSupported(format, VK_FORMAT_FEATURE_TRANSFER_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+		}
 	}
 }
\ No newline at end of file
@@ -28,13 +28,23 @@ namespace Baal
 			VkPhysicalDevice GetVkPhysicalDevice() const;
 
 			const VkPhysicalDeviceProperties& GetProperties() const;
+			const VkPhysicalDeviceFeatures& GetFeatures() const { return features; }
+			const VkPhysicalDeviceVulkan12Features& GetVulkan12Features() const { return vulkan12Features; }	// All false below Vulkan 1.2
 			const std::vector<VkQueueFamilyProperties>& GetQueueFamilyProperties() const;
 			uint32_t GetQueueFamilyIndex(VkQueueFlags flags) const;
+			// Finds a queue family that supports flags without supporting any of excludedFlags, e.g. a transfer only family
+			bool TryGetDedicatedQueueFamilyIndex(VkQueueFlags flags, VkQueueFlags excludedFlags, uint32_t& outIndex) const;
 			VkFormat GetSuitableDepthFormat(const std::vector<VkFormat>& inDepthformats);
+			// With optimal tiling, e.g. VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT to generate mip levels with blits
+			bool IsFormatSupported(const VkFormat format, const VkFormatFeatureFlags requiredFeatures) const;
+			// Can be uploaded with copies and sampled with linear filtering, BC formats also need the textureCompressionBC feature
+			bool IsTextureFormatSupported(const VkFormat format) const;
 
 		private:
 			VkPhysicalDevice vkPhysicalDevice{VK_NULL_HANDLE};
 			VkPhysicalDeviceProperties properties;
+			VkPhysicalDeviceFeatures features{};
+			VkPhysicalDeviceVulkan12Features vulkan12Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
 			std::vector<VkQueueFamilyProperties> queueFamilyProperties;
 		};
 	}
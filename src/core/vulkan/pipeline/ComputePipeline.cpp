@@ -0,0 +1,51 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "ComputePipeline.h"
+
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/pipeline/ShaderModule.h"
+#include "../src/core/vulkan/pipeline/PipelineCache.h"
+#include "../src/core/vulkan/descriptors/DescriptorSetLayout.h"
+#include "../src/core/vulkan/debugging/Error.h"
+
+namespace Baal
+{
+	namespace VK
+	{
+		ComputePipeline::ComputePipeline(
+			LogicalDevice& _device,
+			const ShaderInfo& shaderInfo,
+			DescriptorSetLayout& descriptorSetLayout,
+			const std::vector<VkPushConstantRange>& pushConstants)
+			: device(_device)
+		{
+			// The module is only needed until the pipeline is created
+			const ShaderModule shaderModule(device, shaderInfo);
+
+			VkPipelineShaderStageCreateInfo shaderStageInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+			shaderStageInfo.stage = shaderModule.GetStage();
+			shaderStageInfo.module = shaderModule.GetVkShaderModule();
+			shaderStageInfo.pName = "main";
+
+			VkPipelineLayoutCreateInfo pipelineLayoutInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+			pipelineLayoutInfo.setLayoutCount = 1;
+			pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout.GetVkDescriptorSetLayout();
+			pipelineLayoutInfo.pushConstantRangeCount = pushConstants.size();
+			pipelineLayoutInfo.pPushConstantRanges = pushConstants.data();
+
+			VK_CHECK(vkCreatePipelineLayout(device.GetVkDevice(), &pipelineLayoutInfo, nullptr, &layout), "creating compute pipeline layout");
+
+			VkComputePipelineCreateInfo pipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+			pipelineInfo.stage = shaderStageInfo;
+			pipelineInfo.layout = layout;
+
+			VK_CHECK(vkCreateComputePipelines(device.GetVkDevice(), device.GetPipelineCache().GetVkPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline), "creating compute pipeline");
+		}
+
+		ComputePipeline::~ComputePipeline()
+		{
+			vkDestroyPipeline(device.GetVkDevice(), pipeline, nullptr);
+			vkDestroyPipelineLayout(device.GetVkDevice(), layout, nullptr);
+		}
+	}
+}
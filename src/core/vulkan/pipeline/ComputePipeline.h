@@ -0,0 +1,47 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_COMPUTE_PIPELINE_H
+#define BAAL_COMPUTE_PIPELINE_H
+
+#include <vulkan/vulkan_core.h>
+#include <vector>
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+		struct ShaderInfo;
+		class DescriptorSetLayout;
+
+		// Single compute shader stage, created through the device's PipelineCache like GraphicsPipeline
+
+		class ComputePipeline
+		{
+		public:
+			explicit ComputePipeline(
+				LogicalDevice& _device,
+				const ShaderInfo& shaderInfo,
+				DescriptorSetLayout& descriptorSetLayout,
+				const std::vector<VkPushConstantRange>& pushConstants);
+
+			ComputePipeline(const ComputePipeline&) = delete;
+			ComputePipeline(ComputePipeline&&) = delete;
+
+			~ComputePipeline();
+
+			ComputePipeline& operator=(const ComputePipeline&) = delete;
+			ComputePipeline& operator = (ComputePipeline&&) = delete;
+
+			VkPipeline& GetVkComputePipeline() { return pipeline; }
+			VkPipelineLayout& GetVkComputePipelineLayout() { return layout; }
+
+		private:
+			VkPipeline pipeline{ VK_NULL_HANDLE };
+			VkPipelineLayout layout{ VK_NULL_HANDLE };
+			LogicalDevice& device;
+		};
+	}
+}
+
+#endif // !BAAL_COMPUTE_PIPELINE_H
@@ -0,0 +1,61 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_DRAW_SORT_KEY_H
+#define BAAL_VK_DRAW_SORT_KEY_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace Baal
+{
+	namespace VK
+	{
+		// Draws sorted by their key change the most expensive state the least often
+		// Most significant bits first: | pass 2 | pipeline 4 | material 16 | geometry 26 | depth 16 |
+		using DrawSortKey = uint64_t;
+
+		enum class DrawPass : uint8_t
+		{
+			OPAQUE_GEOMETRY = 0,	// Front to back, so early depth testing rejects hidden fragments
+			TRANSPARENT_GEOMETRY	// Back to front, so blending composes correctly
+		};
+
+		constexpr uint32_t DRAW_SORT_KEY_PASS_BITS = 2;
+		constexpr uint32_t DRAW_SORT_KEY_PIPELINE_BITS = 4;
+		constexpr uint32_t DRAW_SORT_KEY_MATERIAL_BITS = 16;
+		constexpr uint32_t DRAW_SORT_KEY_GEOMETRY_BITS = 26;
+		constexpr uint32_t DRAW_SORT_KEY_DEPTH_BITS = 16;
+		static_assert(DRAW_SORT_KEY_PASS_BITS + DRAW_SORT_KEY_PIPELINE_BITS + DRAW_SORT_KEY_MATERIAL_BITS + DRAW_SORT_KEY_GEOMETRY_BITS + DRAW_SORT_KEY_DEPTH_BITS == 64, "Draw sort key fields must fill 64 bits");
+
+		// Positive floats compare the same as their bit patterns, the top 16 bits keep the exponent and 7 bits of mantissa
+		inline uint16_t QuantizeDrawDepth(float depth)
+		{
+			depth = depth > 0.0f ? depth : 0.0f;
+			uint32_t bits;
+			std::memcpy(&bits, &depth, sizeof(bits));
+			return static_cast<uint16_t>(bits >> 16);
+		}
+
+		// Fields wider than their bits wrap, which only makes unrelated draws sort next to each other, never breaks them
+		inline DrawSortKey MakeDrawSortKey(const DrawPass pass, const uint32_t pipeline, const uint32_t material, const uint32_t geometry, const uint16_t depth)
+		{
+			constexpr uint32_t DEPTH_SHIFT = 0;
+			constexpr uint32_t GEOMETRY_SHIFT = DEPTH_SHIFT + DRAW_SORT_KEY_DEPTH_BITS;
+			constexpr uint32_t MATERIAL_SHIFT = GEOMETRY_SHIFT + DRAW_SORT_KEY_GEOMETRY_BITS;
+			constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + DRAW_SORT_KEY_MATERIAL_BITS;
+			constexpr uint32_t PASS_SHIFT = PIPELINE_SHIFT + DRAW_SORT_KEY_PIPELINE_BITS;
+
+			const uint16_t sortedDepth = pass == DrawPass::TRANSPARENT_GEOMETRY ? static_cast<uint16_t>(~depth) : depth;
+
+			DrawSortKey key = 0;
+			key |= (static_cast<uint64_t>(pass) & ((1ull << DRAW_SORT_KEY_PASS_BITS) - 1)) << PASS_SHIFT;
+			key |= (static_cast<uint64_t>(pipeline) & ((1ull << DRAW_SORT_KEY_PIPELINE_BITS) - 1)) << PIPELINE_SHIFT;
+			key |= (static_cast<uint64_t>(material) & ((1ull << DRAW_SORT_KEY_MATERIAL_BITS) - 1)) << MATERIAL_SHIFT;
+			key |= (static_cast<uint64_t>(geometry) & ((1ull << DRAW_SORT_KEY_GEOMETRY_BITS) - 1)) << GEOMETRY_SHIFT;
+			key |= static_cast<uint64_t>(sortedDepth) << DEPTH_SHIFT;
+			return key;
+		}
+	}
+}
+
+#endif // !BAAL_VK_DRAW_SORT_KEY_H
@@ -5,6 +5,7 @@
 #include "../src/core/vulkan/devices/LogicalDevice.h"
 #include "../src/core/vulkan/pipeline/ShaderModule.h"
 #include "../src/core/vulkan/pipeline/RenderPass.h"
+#include "../src/core/vulkan/pipeline/PipelineCache.h"
 #include "../src/core/vulkan/descriptors/DescriptorSetLayout.h"
 #include "../src/core/3d/Mesh.h"
 #include "../src/core/vulkan/debugging/Error.h"
@@ -21,8 +22,11 @@ namespace Baal
 			VkPipelineRasterizationStateCreateInfo& rasterizerInfo,
 			std::vector<VkPushConstantRange>& pushConstants,
 			const uint32_t width,
-			const uint32_t height)
+			const uint32_t height,
+			const bool _bInstanced /*= false*/,
+			const std::vector<DescriptorSetLayout*>& additionalSetLayouts /*= {}*/)
 			: device(_device)
+			, bInstanced(_bInstanced)
 		{
 			for (size_t i = 0; i < shaderInfo.size(); ++i)
 			{
@@ -51,16 +55,12 @@ namespace Baal
 			dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
 			dynamicState.pDynamicStates = dynamicStates.data();
 			
-			VkVertexInputBindingDescription bindingDescription;
-			bindingDescription.binding = 0;
-			bindingDescription.stride = sizeof(Vertex);
-			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
+			std::vector<VkVertexInputBindingDescription> bindingDescriptions = GetVertexBindings();
 			std::vector<VkVertexInputAttributeDescription> attributeDescriptions = GetVertexAttributes();
 
 			VkPipelineVertexInputStateCreateInfo vertexInput = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
-			vertexInput.vertexBindingDescriptionCount = 1;
-			vertexInput.pVertexBindingDescriptions = &bindingDescription; 
+			vertexInput.vertexBindingDescriptionCount = bindingDescriptions.size();
+			vertexInput.pVertexBindingDescriptions = bindingDescriptions.data();
 			vertexInput.vertexAttributeDescriptionCount = attributeDescriptions.size();
 			vertexInput.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -126,8 +126,14 @@ namespace Baal
 			depthStencil.back = {};
 
 			VkPipelineLayoutCreateInfo pipelineLayoutInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
-			pipelineLayoutInfo.setLayoutCount = 1;
-			pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout.GetVkDescriptorSetLayout();
+			std::vector<VkDescriptorSetLayout> setLayouts = { descriptorSetLayout.GetVkDescriptorSetLayout() };
+			for (DescriptorSetLayout* setLayout : additionalSetLayouts)
+			{
+				setLayouts.push_back(setLayout->GetVkDescriptorSetLayout());
+			}
+
+			pipelineLayoutInfo.setLayoutCount = setLayouts.size();
+			pipelineLayoutInfo.pSetLayouts = setLayouts.data();
 			pipelineLayoutInfo.pushConstantRangeCount = pushConstants.size();
 			pipelineLayoutInfo.pPushConstantRanges = pushConstants.data();
 
@@ -148,7 +154,7 @@ namespace Baal
 			pipelineInfo.renderPass = renderPass.GetVkRenderPass();
 			pipelineInfo.subpass = 0;
 			
-			VK_CHECK(vkCreateGraphicsPipelines(device.GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline), "creating graphics pipeline");
+			VK_CHECK(vkCreateGraphicsPipelines(device.GetVkDevice(), device.GetPipelineCache().GetVkPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline), "creating graphics pipeline");
 		}
 
 		GraphicsPipeline::~GraphicsPipeline()
@@ -158,6 +164,17 @@ namespace Baal
 			shaderStages.clear();
 		}
 
+		std::vector<VkVertexInputBindingDescription> GraphicsPipeline::GetVertexBindings() const
+		{
+			std::vector<VkVertexInputBindingDescription> vertexBindings;
+			vertexBindings.push_back(VkVertexInputBindingDescription(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX));
+			if (bInstanced)
+			{
+				vertexBindings.push_back(VkVertexInputBindingDescription(1, sizeof(InstanceData), VK_VERTEX_INPUT_RATE_INSTANCE));
+			}
+			return vertexBindings;
+		}
+
 		std::vector<VkVertexInputAttributeDescription> GraphicsPipeline::GetVertexAttributes() const
 		{
 			std::vector<VkVertexInputAttributeDescription> vertexAttributes;
@@ -165,6 +182,14 @@ namespace Baal
 			vertexAttributes.push_back(VkVertexInputAttributeDescription(1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, norm)));
 			vertexAttributes.push_back(VkVertexInputAttributeDescription(2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, texCoords)));
 			vertexAttributes.push_back(VkVertexInputAttributeDescription(3, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color)));
+			if (bInstanced)
+			{
+				// A mat4 attribute takes one location per column
+				for (uint32_t column = 0; column < 4; ++column)
+				{
+					vertexAttributes.push_back(VkVertexInputAttributeDescription(4 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(InstanceData, model) + column * sizeof(float) * 4));
+				}
+			}
 			return vertexAttributes;
 		}
 	}
@@ -17,6 +17,8 @@ namespace Baal
 		class DescriptorSetLayout;
 
 		// Sets up Shader Stages and Fixed-Function stages of pipeline
+		// Instanced pipelines read an InstanceData per instance from vertex binding 1, at the locations after the Vertex attributes
+		// descriptorSetLayout is set 0, additionalSetLayouts follow from set 1, e.g. the BindlessTable
 
 		class GraphicsPipeline
 		{
@@ -29,7 +31,9 @@ namespace Baal
 				VkPipelineRasterizationStateCreateInfo& rasterizerInfo,
 				std::vector<VkPushConstantRange>& pushConstants,
 				const uint32_t width, 
-				const uint32_t height);
+				const uint32_t height,
+				const bool _bInstanced = false,
+				const std::vector<DescriptorSetLayout*>& additionalSetLayouts = {});
 
 			GraphicsPipeline(const GraphicsPipeline&) = delete;
 			GraphicsPipeline(GraphicsPipeline&&) = delete;
@@ -47,7 +51,9 @@ namespace Baal
 			VkPipelineLayout layout{ VK_NULL_HANDLE };
 			LogicalDevice& device;
 			std::vector<ShaderModule> shaderStages;
+			const bool bInstanced;
 
+			std::vector<VkVertexInputBindingDescription> GetVertexBindings() const;
 			std::vector<VkVertexInputAttributeDescription> GetVertexAttributes() const;
 		};
 	}
@@ -0,0 +1,243 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "IndirectDrawPass.h"
+
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/resource/Buffer.h"
+#include "../src/core/vulkan/resource/GeometryPool.h"
+#include "../src/core/vulkan/commands/CommandBuffer.h"
+#include "../src/core/vulkan/pipeline/ShaderModule.h"
+#include "../src/core/vulkan/pipeline/ComputePipeline.h"
+#include "../src/core/vulkan/descriptors/DescriptorPool.h"
+#include "../src/core/vulkan/descriptors/DescriptorSetLayout.h"
+#include "../src/core/vulkan/descriptors/DescriptorSet.h"
+#include "../src/core/vulkan/debugging/Error.h"
+#include "../src/core/3d/MeshHandler.h"
+
+namespace Baal
+{
+	namespace VK
+	{
+		static_assert(sizeof(GPUObjectData) == 144, "GPUObjectData must match the std430 layout of ObjectData in the indirect shaders");
+
+		namespace
+		{
+			struct CullPushConstants
+			{
+				uint32_t objectCount;
+				uint32_t bucketBase[2];		// First command slot of each bucket
+				uint32_t bCompact;			// Visible draws are appended per bucket, the GPU supplies the draw count
+			};
+		}
+
+		IndirectDrawPass::IndirectDrawPass(LogicalDevice& _device, const std::vector<Buffer*>& cameraBuffers, const uint32_t _maxDraws /*= BAAL_MAX_INDIRECT_DRAWS*/):
+			device(_device),
+			maxDraws(_maxDraws),
+			bDrawIndirectCount(_device.GetEnabledVulkan12Features().drawIndirectCount == VK_TRUE),
+			bMultiDrawIndirect(_device.GetEnabledFeatures().multiDrawIndirect == VK_TRUE)
+		{
+			const uint32_t frameCount = static_cast<uint32_t>(cameraBuffers.size());
+			frames.resize(frameCount);
+
+			for (FrameResources& frame : frames)
+			{
+				frame.objectBuffer = std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(GPUObjectData) * maxDraws);
+				frame.drawCommandBuffer = std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(VkDrawIndexedIndirectCommand) * maxDraws);
+				frame.drawCountBuffer = std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(uint32_t) * BUCKET_COUNT);
+			}
+
+			std::vector<DescriptorPoolSize> poolSizes;
+			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * frameCount));
+			descriptorPool = std::make_unique<DescriptorPool>(device, poolSizes);
+
+			std::vector<DescriptorSetBinding> bindings;
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 0, 1));	// Camera
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1, 1));	// Objects
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 2, 1));	// Draw Commands
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 3, 1));	// Draw Counts
+			descriptorSetLayout = std::make_unique<DescriptorSetLayout>(device, bindings);
+
+			VkPushConstantRange pushConstant = {};
+			pushConstant.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			pushConstant.offset = 0;
+			pushConstant.size = sizeof(CullPushConstants);
+
+			cullPipeline = std::make_unique<ComputePipeline>(device, ShaderInfo(VK_SHADER_STAGE_COMPUTE_BIT, BAAL_SHADERS_DIR, "Cull.comp"), *descriptorSetLayout.get(), std::vector<VkPushConstantRange>{ pushConstant });
+
+			CreateDescriptorSets(cameraBuffers);
+
+			objects.reserve(maxDraws);
+
+			DEBUG_LOG(LOG::INFO, "Created indirect draw pass, up to {} draws, draw count on the GPU: {}", maxDraws, bDrawIndirectCount);
+		}
+
+		IndirectDrawPass::~IndirectDrawPass()
+		{
+			frames.clear();
+			cullPipeline.reset();
+			descriptorSetLayout.reset();
+			descriptorPool.reset();
+		}
+
+		bool IndirectDrawPass::IsSupported(const LogicalDevice& device)
+		{
+			return device.GetEnabledFeatures().drawIndirectFirstInstance == VK_TRUE;
+		}
+
+		void IndirectDrawPass::Update(const uint32_t frameIndex, MeshHandler& meshHandler)
+		{
+			FrameResources& frame = frames[frameIndex];
+
+			const std::vector<SubMeshInstance>& subMeshes = meshHandler.GetSubMeshInstances();
+			const std::vector<uint32_t>& visibleSubMeshes = meshHandler.GetVisibleSubMeshes();
+
+			if (visibleSubMeshes.size() > maxDraws)
+			{
+				DEBUG_LOG(LOG::WARNING, "{} sub meshes to render, only the first {} are drawn! Increase BAAL_MAX_INDIRECT_DRAWS", visibleSubMeshes.size(), maxDraws);
+			}
+
+			// Grouped by bucket, so each bucket's commands are contiguous and can be drawn with a single indirect draw
+			objects.clear();
+			frame.bucketCounts.fill(0);
+			for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+			{
+				for (size_t i = 0; i < visibleSubMeshes.size() && objects.size() < maxDraws; ++i)
+				{
+					const SubMeshInstance& subMesh = subMeshes[visibleSubMeshes[i]];
+					if (GetBucket(subMesh.indexType) != bucket)
+					{
+						continue;
+					}
+
+					GPUObjectData object;
+					object.model = meshHandler.GetMeshInstance(subMesh.parent)->model;
+					object.material = subMesh.material;
+					const BoundingSphere& sphere = subMesh.bounds.sphere;
+					object.boundingSphere = Vector4f(sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius);
+					object.firstIndex = subMesh.firstIndex;
+					object.indexCount = subMesh.indexCount;
+					object.vertexOffset = subMesh.vertexOffset;
+					object.bucket = bucket;
+					objects.push_back(object);
+
+					++frame.bucketCounts[bucket];
+				}
+			}
+
+			frame.objectCount = static_cast<uint32_t>(objects.size());
+			if (frame.objectCount > 0)
+			{
+				frame.objectBuffer->Update(objects.data(), sizeof(GPUObjectData) * objects.size());
+			}
+		}
+
+		void IndirectDrawPass::RecordCulling(CommandBuffer& commandBuffer, const uint32_t frameIndex)
+		{
+			FrameResources& frame = frames[frameIndex];
+			VkCommandBuffer vkCommandBuffer = commandBuffer.GetVkCommandBuffer();
+
+			vkCmdFillBuffer(vkCommandBuffer, frame.drawCountBuffer->GetVkBuffer(), 0, VK_WHOLE_SIZE, 0);
+
+			VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(vkCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			if (frame.objectCount > 0)
+			{
+				CullPushConstants constants;
+				constants.objectCount = frame.objectCount;
+				constants.bucketBase[0] = 0;
+				constants.bucketBase[1] = frame.bucketCounts[0];
+				constants.bCompact = bDrawIndirectCount ? 1 : 0;
+
+				vkCmdBindPipeline(vkCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline->GetVkComputePipeline());
+				vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline->GetVkComputePipelineLayout(), 0, 1, &frame.descriptorSet->GetVkDescriptorSet(), 0, nullptr);
+				vkCmdPushConstants(vkCommandBuffer, cullPipeline->GetVkComputePipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &constants);
+				vkCmdDispatch(vkCommandBuffer, (frame.objectCount + BAAL_CULL_WORKGROUP_SIZE - 1) / BAAL_CULL_WORKGROUP_SIZE, 1, 1);
+			}
+
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			vkCmdPipelineBarrier(vkCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
+		void IndirectDrawPass::RecordDraws(CommandBuffer& commandBuffer, const uint32_t frameIndex, GeometryPool& geometryPool)
+		{
+			FrameResources& frame = frames[frameIndex];
+			VkCommandBuffer vkCommandBuffer = commandBuffer.GetVkCommandBuffer();
+
+			const VkDeviceSize vertexOffset = 0;
+			vkCmdBindVertexBuffers(vkCommandBuffer, 0, 1, &geometryPool.GetVertexBuffer()->GetVkBuffer(), &vertexOffset);
+
+			const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+			uint32_t bucketBase = 0;
+			for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+			{
+				const uint32_t drawCount = frame.bucketCounts[bucket];
+				if (drawCount == 0)
+				{
+					continue;
+				}
+
+				const VkIndexType indexType = bucket == 0 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+				vkCmdBindIndexBuffer(vkCommandBuffer, geometryPool.GetIndexBuffer(indexType)->GetVkBuffer(), 0, indexType);
+
+				const VkDeviceSize commandOffset = static_cast<VkDeviceSize>(bucketBase) * stride;
+				if (bDrawIndirectCount)
+				{
+					vkCmdDrawIndexedIndirectCount(vkCommandBuffer, frame.drawCommandBuffer->GetVkBuffer(), commandOffset, frame.drawCountBuffer->GetVkBuffer(), sizeof(uint32_t) * bucket, drawCount, stride);
+				}
+				else if (bMultiDrawIndirect)
+				{
+					vkCmdDrawIndexedIndirect(vkCommandBuffer, frame.drawCommandBuffer->GetVkBuffer(), commandOffset, drawCount, stride);
+				}
+				else
+				{
+					// Without multiDrawIndirect every indirect draw is limited to a single command
+					for (uint32_t i = 0; i < drawCount; ++i)
+					{
+						vkCmdDrawIndexedIndirect(vkCommandBuffer, frame.drawCommandBuffer->GetVkBuffer(), commandOffset + static_cast<VkDeviceSize>(i) * stride, 1, stride);
+					}
+				}
+
+				bucketBase += drawCount;
+			}
+		}
+
+		Buffer& IndirectDrawPass::GetObjectBuffer(const uint32_t frameIndex)
+		{
+			return *frames[frameIndex].objectBuffer.get();
+		}
+
+		void IndirectDrawPass::CreateDescriptorSets(const std::vector<Buffer*>& cameraBuffers)
+		{
+			for (size_t frameIndex = 0; frameIndex < frames.size(); ++frameIndex)
+			{
+				FrameResources& frame = frames[frameIndex];
+				frame.descriptorSet = std::make_unique<DescriptorSet>(device, *descriptorPool.get(), *descriptorSetLayout.get());
+
+				const std::array<Buffer*, 4> buffers = { cameraBuffers[frameIndex], frame.objectBuffer.get(), frame.drawCommandBuffer.get(), frame.drawCountBuffer.get() };
+
+				std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+				std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+				for (uint32_t binding = 0; binding < buffers.size(); ++binding)
+				{
+					bufferInfos[binding].buffer = buffers[binding]->GetVkBuffer();
+					bufferInfos[binding].offset = 0;
+					bufferInfos[binding].range = VK_WHOLE_SIZE;
+
+					descriptorWrites[binding] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+					descriptorWrites[binding].dstSet = frame.descriptorSet->GetVkDescriptorSet();
+					descriptorWrites[binding].dstBinding = binding;
+					descriptorWrites[binding].dstArrayElement = 0;
+					descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+					descriptorWrites[binding].descriptorCount = 1;
+					descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+				}
+
+				vkUpdateDescriptorSets(device.GetVkDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+			}
+		}
+	}
+}
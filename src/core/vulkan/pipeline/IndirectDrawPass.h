@@ -0,0 +1,113 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_INDIRECT_DRAW_PASS_H
+#define BAAL_VK_INDIRECT_DRAW_PASS_H
+
+#include <vulkan/vulkan_core.h>
+#include <Mjolnir.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "../src/core/3d/Mesh.h"
+
+#ifndef BAAL_MAX_INDIRECT_DRAWS
+#define BAAL_MAX_INDIRECT_DRAWS 16384	// Sub mesh instances per frame, the rest are dropped with a warning
+#endif // !BAAL_MAX_INDIRECT_DRAWS
+
+#ifndef BAAL_CULL_WORKGROUP_SIZE
+#define BAAL_CULL_WORKGROUP_SIZE 64		// Must match local_size_x in Cull.comp
+#endif // !BAAL_CULL_WORKGROUP_SIZE
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+		class Buffer;
+		class CommandBuffer;
+		class DescriptorPool;
+		class DescriptorSetLayout;
+		class DescriptorSet;
+		class ComputePipeline;
+		class GeometryPool;
+		class MeshHandler;
+
+		// Per sub mesh instance data read by Cull.comp and the indirect shaders, laid out to match std430
+		struct GPUObjectData
+		{
+			Matrix4f model;
+			Material material;
+			Vector4f boundingSphere;	// Object space center in xyz, radius in w
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+			int32_t vertexOffset = 0;
+			uint32_t bucket = 0;		// Index type of the draw, see IndirectDrawPass::GetBucket()
+		};
+
+		// GPU driven drawing of every sub mesh instance
+		// Instance data is written into a per frame storage buffer, a compute shader frustum culls it against the camera
+		// and writes one VkDrawIndexedIndirectCommand per visible instance. Draws are issued with one indirect draw per index type,
+		// the first instance of each draw is its object index, so shaders find their instance data through gl_InstanceIndex.
+		//
+		// With drawIndirectCount the culling pass compacts the visible draws and the GPU supplies the draw count,
+		// otherwise every instance keeps its command slot and culled draws get an instance count of 0.
+		class IndirectDrawPass
+		{
+		public:
+			explicit IndirectDrawPass(LogicalDevice& _device, const std::vector<Buffer*>& cameraBuffers, const uint32_t _maxDraws = BAAL_MAX_INDIRECT_DRAWS);
+			IndirectDrawPass(const IndirectDrawPass&) = delete;
+			IndirectDrawPass(IndirectDrawPass&&) = delete;
+
+			~IndirectDrawPass();
+
+			IndirectDrawPass& operator=(const IndirectDrawPass&) = delete;
+			IndirectDrawPass& operator = (IndirectDrawPass&&) = delete;
+
+			// gl_InstanceIndex is only usable as an object index with drawIndirectFirstInstance
+			static bool IsSupported(const LogicalDevice& device);
+
+			// Writes every sub mesh instance collected for rendering into the frame's object buffer, grouped by index type
+			void Update(const uint32_t frameIndex, MeshHandler& meshHandler);
+
+			// Must be recorded outside of a render pass, before RecordDraws()
+			void RecordCulling(CommandBuffer& commandBuffer, const uint32_t frameIndex);
+
+			// Must be recorded inside a render pass, with a pipeline using the indirect shaders and the object buffer bound
+			void RecordDraws(CommandBuffer& commandBuffer, const uint32_t frameIndex, GeometryPool& geometryPool);
+
+			Buffer& GetObjectBuffer(const uint32_t frameIndex);
+			uint32_t GetMaxDraws() const { return maxDraws; }
+
+		private:
+			static constexpr uint32_t BUCKET_COUNT = 2;	// 16-bit and 32-bit indices, each index type needs its own index buffer binding
+
+			struct FrameResources
+			{
+				std::unique_ptr<Buffer> objectBuffer;		// Host visible, written every frame
+				std::unique_ptr<Buffer> drawCommandBuffer;	// Written by Cull.comp
+				std::unique_ptr<Buffer> drawCountBuffer;	// One visible draw count per bucket, written by Cull.comp
+				std::unique_ptr<DescriptorSet> descriptorSet;
+				uint32_t objectCount = 0;
+				std::array<uint32_t, BUCKET_COUNT> bucketCounts{};
+			};
+
+			LogicalDevice& device;
+			const uint32_t maxDraws;
+			const bool bDrawIndirectCount;
+			const bool bMultiDrawIndirect;
+
+			std::unique_ptr<DescriptorPool> descriptorPool;
+			std::unique_ptr<DescriptorSetLayout> descriptorSetLayout;
+			std::unique_ptr<ComputePipeline> cullPipeline;
+			std::vector<FrameResources> frames;	// One per frame in flight
+
+			std::vector<GPUObjectData> objects;	// Reused every frame to avoid reallocating
+
+			static uint32_t GetBucket(const VkIndexType indexType) { return indexType == VK_INDEX_TYPE_UINT16 ? 0 : 1; }
+			void CreateDescriptorSets(const std::vector<Buffer*>& cameraBuffers);
+		};
+	}
+}
+
+#endif // !BAAL_VK_INDIRECT_DRAW_PASS_H
@@ -0,0 +1,138 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "InstancedDrawBuilder.h"
+
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/resource/Buffer.h"
+#include "../src/core/3d/MeshHandler.h"
+#include "../src/core/vulkan/pipeline/DrawSortKey.h"
+#include "../src/core/3d/Bounds.h"
+#include "../src/utility/RadixSort.h"
+#include "../src/utility/Hash.h"
+#include "../src/utility/DebugLog.h"
+
+namespace Baal
+{
+	namespace VK
+	{
+		namespace
+		{
+			bool IsSameGeometry(const SubMeshInstance& a, const SubMeshInstance& b)
+			{
+				return a.firstIndex == b.firstIndex && a.vertexOffset == b.vertexOffset && a.indexType == b.indexType;
+			}
+
+			bool IsSameMaterial(const SubMeshInstance& a, const SubMeshInstance& b)
+			{
+				return a.materialIndex == b.materialIndex && a.material == b.material;
+			}
+
+			// Hashes the members rather than the struct, so its alignment padding is never read
+			uint32_t GetMaterialSortId(const SubMeshInstance& subMesh)
+			{
+				const Material& material = subMesh.material;
+				uint64_t hash = HashFNV1a(&subMesh.materialIndex, sizeof(subMesh.materialIndex));
+				hash = HashFNV1a(&material.ambient, sizeof(material.ambient), hash);
+				hash = HashFNV1a(&material.diffuse, sizeof(material.diffuse), hash);
+				hash = HashFNV1a(&material.specular, sizeof(material.specular), hash);
+				hash = HashFNV1a(&material.shininess, sizeof(material.shininess), hash);
+				return static_cast<uint32_t>(hash ^ (hash >> 32));
+			}
+
+			// Every instance of a Sub Mesh shares its GeometryPool allocation, and the index type picks the index buffer
+			uint32_t GetGeometrySortId(const SubMeshInstance& subMesh)
+			{
+				const uint32_t indexTypeBit = subMesh.indexType == VK_INDEX_TYPE_UINT16 ? 0u : 1u;
+				return (indexTypeBit << (DRAW_SORT_KEY_GEOMETRY_BITS - 1)) | (subMesh.firstIndex & ((1u << (DRAW_SORT_KEY_GEOMETRY_BITS - 1)) - 1));
+			}
+		}
+
+		InstancedDrawBuilder::InstancedDrawBuilder(LogicalDevice& _device, const uint32_t framesInFlight, const uint32_t _maxInstances /*= BAAL_MAX_DRAW_INSTANCES*/):
+			device(_device),
+			maxInstances(_maxInstances)
+		{
+			for (uint32_t i = 0; i < framesInFlight; ++i)
+			{
+				instanceBuffers.push_back(std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(InstanceData) * maxInstances));
+			}
+		}
+
+		InstancedDrawBuilder::~InstancedDrawBuilder()
+		{
+			instanceBuffers.clear();
+		}
+
+		void InstancedDrawBuilder::Build(const uint32_t frameIndex, MeshHandler& meshHandler, const Vector3f& viewPosition)
+		{
+			const std::vector<SubMeshInstance>& subMeshes = meshHandler.GetSubMeshInstances();
+			const std::vector<uint32_t>& visibleSubMeshes = meshHandler.GetVisibleSubMeshes();
+
+			draws.clear();
+			order.assign(visibleSubMeshes.begin(), visibleSubMeshes.end());
+
+			if (order.size() > maxInstances)
+			{
+				DEBUG_LOG(LOG::WARNING, "{} sub meshes to render, only the first {} are drawn! Increase BAAL_MAX_DRAW_INSTANCES", order.size(), maxInstances);
+				order.resize(maxInstances);
+			}
+
+			// Draws sort by material and then geometry, so both change as rarely as possible and repeated sub meshes end up next to each other
+			// Instances of one draw are rasterized in order, the depth field keeps them front to back
+			sortKeys.resize(order.size());
+			for (size_t i = 0; i < order.size(); ++i)
+			{
+				const SubMeshInstance& subMesh = subMeshes[order[i]];
+
+				float model[16];
+				ToColumnMajor(meshHandler.GetMeshInstance(subMesh.parent)->model, model);
+				const BoundingSphere sphere = subMesh.bounds.sphere.Transform(model);
+				const float dx = sphere.center.x - viewPosition.x;
+				const float dy = sphere.center.y - viewPosition.y;
+				const float dz = sphere.center.z - viewPosition.z;
+
+				sortKeys[i] = MakeDrawSortKey(DrawPass::OPAQUE_GEOMETRY, 0, GetMaterialSortId(subMesh), GetGeometrySortId(subMesh), QuantizeDrawDepth(dx * dx + dy * dy + dz * dz));
+			}
+			RadixSort(sortKeys, order, scratchSortKeys, scratchOrder);
+
+			// The instance buffer is persistently mapped, model matrices are written straight into it
+			Buffer& instanceBuffer = *instanceBuffers[frameIndex].get();
+			InstanceData* instances = reinterpret_cast<InstanceData*>(instanceBuffer.GetMappedSpan().data());
+			uint32_t instanceCount = 0;
+
+			size_t groupBegin = 0;
+			while (groupBegin < order.size())
+			{
+				// Truncated fields can collide, so the sorted runs are still confirmed against the sub meshes themselves
+				const SubMeshInstance& first = subMeshes[order[groupBegin]];
+				size_t groupEnd = groupBegin + 1;
+				while (groupEnd < order.size() && IsSameGeometry(first, subMeshes[order[groupEnd]]) && IsSameMaterial(first, subMeshes[order[groupEnd]]))
+				{
+					++groupEnd;
+				}
+
+				InstancedDraw draw;
+				draw.firstIndex = first.firstIndex;
+				draw.indexCount = first.indexCount;
+				draw.vertexOffset = first.vertexOffset;
+				draw.indexType = first.indexType;
+				draw.firstInstance = instanceCount;
+				draw.instanceCount = static_cast<uint32_t>(groupEnd - groupBegin);
+				draw.material = first.material;
+				draw.materialIndex = first.materialIndex;
+				draws.push_back(draw);
+
+				for (size_t i = groupBegin; i < groupEnd; ++i)
+				{
+					instances[instanceCount++].model = meshHandler.GetMeshInstance(subMeshes[order[i]].parent)->model;
+				}
+
+				groupBegin = groupEnd;
+			}
+
+			if (instanceCount > 0)
+			{
+				instanceBuffer.Flush(0, sizeof(InstanceData) * instanceCount);
+			}
+		}
+	}
+}
@@ -0,0 +1,75 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_INSTANCED_DRAW_BUILDER_H
+#define BAAL_VK_INSTANCED_DRAW_BUILDER_H
+
+#include <vulkan/vulkan_core.h>
+#include <memory>
+#include <vector>
+
+#include "../src/core/3d/Mesh.h"
+
+#ifndef BAAL_MAX_DRAW_INSTANCES
+#define BAAL_MAX_DRAW_INSTANCES 65536	// Visible sub mesh instances per frame, the rest are dropped with a warning
+#endif // !BAAL_MAX_DRAW_INSTANCES
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+		class Buffer;
+		class MeshHandler;
+
+		// One vkCmdDrawIndexed covering every visible instance of a sub mesh that shares its geometry and material
+		struct InstancedDraw
+		{
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+			int32_t vertexOffset = 0;
+			VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+			uint32_t firstInstance = 0;		// Into the frame's instance buffer
+			uint32_t instanceCount = 0;
+			Material material;
+			uint32_t materialIndex = 0;	// Into the BindlessTable's materials, when the renderer has one
+		};
+
+		// Groups the visible sub mesh instances into instanced draws, for drawing from the CPU
+		// Sub meshes are radix sorted by a DrawSortKey, material first and then their GeometryPool allocation, every copy of a Mesh shares one.
+		// Each run of the same geometry and material becomes one draw, its instances ordered front to back.
+		// Each group's model matrices are written contiguously into a per frame instance rate vertex buffer, see GraphicsPipeline
+		class InstancedDrawBuilder
+		{
+		public:
+			explicit InstancedDrawBuilder(LogicalDevice& _device, const uint32_t framesInFlight, const uint32_t _maxInstances = BAAL_MAX_DRAW_INSTANCES);
+			InstancedDrawBuilder(const InstancedDrawBuilder&) = delete;
+			InstancedDrawBuilder(InstancedDrawBuilder&&) = delete;
+
+			~InstancedDrawBuilder();
+
+			InstancedDrawBuilder& operator=(const InstancedDrawBuilder&) = delete;
+			InstancedDrawBuilder& operator = (InstancedDrawBuilder&&) = delete;
+
+			// Call once per frame, after MeshHandler::CollectSubMeshesToRender()
+			// viewPosition is the world space camera position, for the depth part of the sort key
+			void Build(const uint32_t frameIndex, MeshHandler& meshHandler, const Vector3f& viewPosition);
+
+			const std::vector<InstancedDraw>& GetDraws() const { return draws; }
+			Buffer& GetInstanceBuffer(const uint32_t frameIndex) { return *instanceBuffers[frameIndex].get(); }
+
+		private:
+			LogicalDevice& device;
+			const uint32_t maxInstances;
+			std::vector<std::unique_ptr<Buffer>> instanceBuffers;	// One per frame in flight
+
+			// Rebuilt every frame, kept to avoid reallocating
+			std::vector<uint32_t> order;
+			std::vector<uint64_t> sortKeys;
+			std::vector<uint64_t> scratchSortKeys;
+			std::vector<uint32_t> scratchOrder;
+			std::vector<InstancedDraw> draws;
+		};
+	}
+}
+
+#endif // !BAAL_VK_INSTANCED_DRAW_BUILDER_H
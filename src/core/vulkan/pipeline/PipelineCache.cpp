@@ -0,0 +1,115 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "PipelineCache.h"
+
+#include "../src/core/vulkan/debugging/Error.h"
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/devices/PhysicalDevice.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace Baal
+{
+	namespace VK
+	{
+		PipelineCache::PipelineCache(LogicalDevice& _device, const PhysicalDevice& physicalDevice, const std::string& _filePath /*= BAAL_PIPELINE_CACHE_PATH*/):
+			device(_device),
+			filePath(_filePath)
+		{
+			std::string initialData;
+
+			std::ifstream file(filePath, std::ios::binary);
+			if (file.is_open())
+			{
+				initialData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+				file.close();
+
+				if (!IsCompatible(initialData, physicalDevice))
+				{
+					DEBUG_LOG(LOG::INFO, "Discarding pipeline cache {}, it was written by a different device or driver", filePath);
+					initialData.clear();
+				}
+			}
+
+			VkPipelineCacheCreateInfo cacheInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+			cacheInfo.initialDataSize = initialData.size();
+			cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+			VK_CHECK(vkCreatePipelineCache(device.GetVkDevice(), &cacheInfo, nullptr, &vkPipelineCache), "creating pipeline cache");
+
+			DEBUG_LOG(LOG::INFO, "Created pipeline cache, seeded with {} bytes from {}", initialData.size(), filePath);
+		}
+
+		PipelineCache::~PipelineCache()
+		{
+			Save();
+			vkDestroyPipelineCache(device.GetVkDevice(), vkPipelineCache, nullptr);
+		}
+
+		bool PipelineCache::Save()
+		{
+			size_t dataSize = 0;
+			VK_CHECK(vkGetPipelineCacheData(device.GetVkDevice(), vkPipelineCache, &dataSize, nullptr), "querying pipeline cache size");
+			if (dataSize == 0)
+			{
+				return false;
+			}
+
+			std::vector<char> data(dataSize);
+			VK_CHECK(vkGetPipelineCacheData(device.GetVkDevice(), vkPipelineCache, &dataSize, data.data()), "reading pipeline cache data");
+
+			const std::filesystem::path path(filePath);
+			std::error_code error;
+			if (path.has_parent_path())
+			{
+				std::filesystem::create_directories(path.parent_path(), error);
+			}
+
+			// Written to a temporary file first, so a crash while saving never leaves a truncated cache behind
+			std::filesystem::path tempPath = path;
+			tempPath += ".tmp";
+
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				if (!file.is_open() || !file.write(data.data(), dataSize))
+				{
+					DEBUG_LOG(LOG::WARNING, "Failed to save pipeline cache: {}", filePath);
+					return false;
+				}
+			}
+
+			std::filesystem::rename(tempPath, path, error);
+			if (error)
+			{
+				DEBUG_LOG(LOG::WARNING, "Failed to save pipeline cache: {}, Error: {}", filePath, error.message());
+				return false;
+			}
+
+			DEBUG_LOG(LOG::INFO, "Saved {} bytes of pipeline cache to {}", dataSize, filePath);
+			return true;
+		}
+
+		bool PipelineCache::IsCompatible(const std::string& data, const PhysicalDevice& physicalDevice) const
+		{
+			VkPipelineCacheHeaderVersionOne header{};
+			if (data.size() < sizeof(header))
+			{
+				return false;
+			}
+
+			std::memcpy(&header, data.data(), sizeof(header));
+
+			const VkPhysicalDeviceProperties& properties = physicalDevice.GetProperties();
+			return header.headerSize >= sizeof(header) &&
+				header.headerSize <= data.size() &&
+				header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+				header.vendorID == properties.vendorID &&
+				header.deviceID == properties.deviceID &&
+				std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+	}
+}
@@ -0,0 +1,50 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_PIPELINE_CACHE_H
+#define BAAL_VK_PIPELINE_CACHE_H
+
+#include <vulkan/vulkan_core.h>
+#include <string>
+
+// Where the pipeline cache is persisted between runs, the build points this at the build directory
+#ifndef BAAL_PIPELINE_CACHE_PATH
+#define BAAL_PIPELINE_CACHE_PATH "cache/pipelines.bin"
+#endif // !BAAL_PIPELINE_CACHE_PATH
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+		class PhysicalDevice;
+
+		// Device owned VkPipelineCache, used for every pipeline the device creates
+		// Seeded from disk when the blob was written by the same vendor, device and driver (pipeline cache UUID), otherwise starts empty
+		class PipelineCache
+		{
+		public:
+			explicit PipelineCache(LogicalDevice& _device, const PhysicalDevice& physicalDevice, const std::string& _filePath = BAAL_PIPELINE_CACHE_PATH);
+			PipelineCache(const PipelineCache&) = delete;
+			PipelineCache(PipelineCache&&) = delete;
+
+			~PipelineCache();
+
+			PipelineCache& operator=(const PipelineCache&) = delete;
+			PipelineCache& operator = (PipelineCache&&) = delete;
+
+			VkPipelineCache& GetVkPipelineCache() { return vkPipelineCache; }
+
+			// Serializes the cache back to disk, also done on destruction
+			bool Save();
+
+		private:
+			VkPipelineCache vkPipelineCache{ VK_NULL_HANDLE };
+			LogicalDevice& device;
+			std::string filePath;
+
+			bool IsCompatible(const std::string& data, const PhysicalDevice& physicalDevice) const;
+		};
+	}
+}
+
+#endif // !BAAL_VK_PIPELINE_CACHE_H
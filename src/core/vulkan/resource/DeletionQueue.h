@@ -0,0 +1,71 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_DELETION_QUEUE_H
+#define BAAL_VK_DELETION_QUEUE_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+namespace Baal
+{
+	namespace VK
+	{
+		// Frames are numbered from 1 as the renderer begins them, 0 is never used and is always complete
+		using FrameNumber = uint64_t;
+
+		// Defers destroying GPU resources until the last frame that could have used them has finished on the GPU
+		// Anything can be queued: a wrapper object such as a Buffer, Image, GraphicsPipeline or DescriptorSet whose destructor releases it,
+		// or a callback that destroys raw Vulkan handles. Resources queued during a frame are tagged with that frame's number,
+		// and released by Retire() once the renderer knows that frame completed, instead of draining the device with vkDeviceWaitIdle
+		//
+		// Uploads are submitted before the frame that follows them on the graphics queue, and transfers are acquired on the graphics queue,
+		// so a frame completing also covers every upload recorded before it
+		class DeletionQueue
+		{
+		public:
+			DeletionQueue() = default;
+			DeletionQueue(const DeletionQueue&) = delete;
+			DeletionQueue(DeletionQueue&&) = delete;
+
+			~DeletionQueue();
+
+			DeletionQueue& operator=(const DeletionQueue&) = delete;
+			DeletionQueue& operator = (DeletionQueue&&) = delete;
+
+			// Destroyed by its destructor once the current frame completes
+			template<typename T>
+			void Push(std::unique_ptr<T> resource) { Push(std::shared_ptr<void>(std::move(resource))); }
+			void Push(std::shared_ptr<void> resource);
+
+			// Called once the current frame completes, for raw Vulkan handles
+			void Push(std::function<void()> destroy);
+
+			// Every resource queued from here on is tagged with frame
+			void BeginFrame(const FrameNumber frame) { currentFrame = frame; }
+
+			// Releases everything queued during completedFrame or earlier
+			void Retire(const FrameNumber completedFrame);
+
+			// Releases everything, only once the device is idle
+			void Flush();
+
+			FrameNumber GetCurrentFrame() const { return currentFrame; }
+			size_t GetPendingCount() const { return entries.size(); }
+
+		private:
+			struct Entry
+			{
+				FrameNumber frame = 0;
+				std::shared_ptr<void> resource;
+				std::function<void()> destroy;
+			};
+
+			std::deque<Entry> entries;	// In frame order, so retiring only ever pops from the front
+			FrameNumber currentFrame = 0;
+		};
+	}
+}
+
+#endif // !BAAL_VK_DELETION_QUEUE_H
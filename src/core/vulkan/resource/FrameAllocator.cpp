@@ -0,0 +1,91 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "FrameAllocator.h"
+
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/devices/PhysicalDevice.h"
+#include "../src/core/vulkan/resource/Buffer.h"
+#include "../src/utility/DebugLog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Baal
+{
+	namespace VK
+	{
+		namespace
+		{
+			// Index data only needs 4 bytes, vertex data 16 covers every vertex format in use
+			constexpr VkDeviceSize MIN_ALIGNMENT = 16;
+
+			VkDeviceSize AlignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+			{
+				return (value + alignment - 1) & ~(alignment - 1);
+			}
+		}
+
+		FrameAllocator::FrameAllocator(LogicalDevice& device, const PhysicalDevice& gpu, const uint32_t framesInFlight, const VkDeviceSize _frameCapacity /*= BAAL_FRAME_ALLOCATOR_SIZE*/):
+			frameCapacity(_frameCapacity),
+			uniformAlignment(std::max<VkDeviceSize>(gpu.GetProperties().limits.minUniformBufferOffsetAlignment, MIN_ALIGNMENT)),
+			storageAlignment(std::max<VkDeviceSize>(gpu.GetProperties().limits.minStorageBufferOffsetAlignment, MIN_ALIGNMENT))
+		{
+			const VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+			buffer = std::make_unique<Buffer>(device.GetAllocator(), usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frameCapacity * framesInFlight);
+			mappedData = buffer->GetMappedData();
+
+			BeginFrame(0);
+
+			DEBUG_LOG(LOG::INFO, "Created frame allocator with {} bytes per frame in flight", frameCapacity);
+		}
+
+		FrameAllocator::~FrameAllocator()
+		{
+			buffer.reset();
+		}
+
+		void FrameAllocator::BeginFrame(const uint32_t frameIndex)
+		{
+			frameBegin = frameCapacity * frameIndex;
+			frameEnd = frameBegin + frameCapacity;
+			head.store(frameBegin, std::memory_order_relaxed);
+		}
+
+		FrameAllocation FrameAllocator::Allocate(const VkDeviceSize size, const VkDeviceSize alignment)
+		{
+			VkDeviceSize offset = 0;
+			VkDeviceSize current = head.load(std::memory_order_relaxed);
+			do
+			{
+				offset = AlignUp(current, alignment);
+				if (offset + size > frameEnd)
+				{
+					DEBUG_LOG(LOG::ERRORLOG, "Failed to allocate {} bytes of frame data! {} of {} bytes are in use, increase BAAL_FRAME_ALLOCATOR_SIZE", size, current - frameBegin, frameCapacity);
+					throw std::runtime_error("Frame allocator is full");
+				}
+			} while (!head.compare_exchange_weak(current, offset + size, std::memory_order_relaxed));
+
+			FrameAllocation allocation;
+			allocation.buffer = buffer->GetVkBuffer();
+			allocation.offset = static_cast<uint32_t>(offset);
+			allocation.size = size;
+			allocation.data = mappedData + offset;
+			return allocation;
+		}
+
+		FrameAllocation FrameAllocator::AllocateUniform(const void* data, const VkDeviceSize size)
+		{
+			FrameAllocation allocation = Allocate(size, uniformAlignment);
+			std::memcpy(allocation.data, data, size);
+			return allocation;
+		}
+
+		FrameAllocation FrameAllocator::AllocateStorage(const void* data, const VkDeviceSize size)
+		{
+			FrameAllocation allocation = Allocate(size, storageAlignment);
+			std::memcpy(allocation.data, data, size);
+			return allocation;
+		}
+	}
+}
@@ -0,0 +1,76 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_FRAME_ALLOCATOR_H
+#define BAAL_VK_FRAME_ALLOCATOR_H
+
+#include <vulkan/vulkan_core.h>
+#include <atomic>
+#include <memory>
+
+#ifndef BAAL_FRAME_ALLOCATOR_SIZE
+#define BAAL_FRAME_ALLOCATOR_SIZE (4 * 1024 * 1024)	// Bytes of transient data each frame in flight can allocate
+#endif // !BAAL_FRAME_ALLOCATOR_SIZE
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+		class PhysicalDevice;
+		class Buffer;
+
+		// Transient GPU data, only valid for the frame it was allocated in
+		struct FrameAllocation
+		{
+			VkBuffer buffer{ VK_NULL_HANDLE };
+			uint32_t offset = 0;	// From the start of the buffer, the dynamic offset to bind the allocation with
+			VkDeviceSize size = 0;
+			uint8_t* data{ nullptr };	// Write only, the memory can be write-combined
+		};
+
+		// Linear allocator for data rewritten every frame, such as camera and light constants or per draw data
+		// One persistently mapped buffer is split into a region per frame in flight, and a frame's region is handed out by bumping an offset.
+		// The region is reset as a whole by BeginFrame(), once the frame's previous submission has completed, so nothing the GPU still reads is overwritten.
+		// Descriptors point at the buffer once, with a _DYNAMIC type, and each allocation is bound through its offset
+		// Allocating is thread safe, and never calls into VMA
+		class FrameAllocator
+		{
+		public:
+			explicit FrameAllocator(LogicalDevice& device, const PhysicalDevice& gpu, const uint32_t framesInFlight, const VkDeviceSize _frameCapacity = BAAL_FRAME_ALLOCATOR_SIZE);
+			FrameAllocator(const FrameAllocator&) = delete;
+			FrameAllocator(FrameAllocator&&) = delete;
+
+			~FrameAllocator();
+
+			FrameAllocator& operator=(const FrameAllocator&) = delete;
+			FrameAllocator& operator = (FrameAllocator&&) = delete;
+
+			// The frame's previous submission must have completed
+			void BeginFrame(const uint32_t frameIndex);
+
+			// Throws when the frame's region is full, see BAAL_FRAME_ALLOCATOR_SIZE
+			FrameAllocation Allocate(const VkDeviceSize size, const VkDeviceSize alignment);
+
+			// Aligned for binding as a uniform or storage buffer, and filled with size bytes of data
+			FrameAllocation AllocateUniform(const void* data, const VkDeviceSize size);
+			FrameAllocation AllocateStorage(const void* data, const VkDeviceSize size);
+
+			Buffer& GetBuffer() { return *buffer.get(); }
+			VkDeviceSize GetFrameCapacity() const { return frameCapacity; }
+			VkDeviceSize GetUsedBytes() const { return head.load(std::memory_order_relaxed) - frameBegin; }
+
+		private:
+			const VkDeviceSize frameCapacity;
+			const VkDeviceSize uniformAlignment;
+			const VkDeviceSize storageAlignment;
+			std::unique_ptr<Buffer> buffer;
+			uint8_t* mappedData{ nullptr };
+
+			VkDeviceSize frameBegin = 0;
+			VkDeviceSize frameEnd = 0;
+			std::atomic<VkDeviceSize> head{ 0 };
+		};
+	}
+}
+
+#endif // !BAAL_VK_FRAME_ALLOCATOR_H
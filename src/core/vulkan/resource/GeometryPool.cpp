@@ -0,0 +1,71 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "GeometryPool.h"
+
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/resource/Buffer.h"
+#include "../src/core/vulkan/debugging/Error.h"
+
+#include <stdexcept>
+
+namespace Baal
+{
+	namespace VK
+	{
+		GeometryPool::GeometryPool(LogicalDevice& _device, const VkDeviceSize _vertexStride, const uint32_t _vertexCapacity /*= BAAL_GEOMETRY_POOL_VERTEX_CAPACITY*/, const uint32_t _indexCapacity /*= BAAL_GEOMETRY_POOL_INDEX_CAPACITY*/):
+			device(_device),
+			vertexStride(_vertexStride),
+			vertexCapacity(_vertexCapacity),
+			indexCapacity(_indexCapacity)
+		{
+			vertexBuffer = std::make_shared<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexStride * vertexCapacity);
+			indexBuffer16 = std::make_shared<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(uint16_t) * indexCapacity);
+			indexBuffer32 = std::make_shared<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(uint32_t) * indexCapacity);
+
+			DEBUG_LOG(LOG::INFO, "Created geometry pool, {} vertices and {} indices per index type", vertexCapacity, indexCapacity);
+		}
+
+		GeometryPool::~GeometryPool()
+		{
+			indexBuffer32.reset();
+			indexBuffer16.reset();
+			vertexBuffer.reset();
+		}
+
+		UploadTicket GeometryPool::Allocate(const void* vertexData, const uint32_t _vertexCount, const std::vector<uint32_t>& indices, const VkIndexType indexType, GeometryAllocation& outAllocation)
+		{
+			if (indexType == VK_INDEX_TYPE_UINT16)
+			{
+				const std::vector<uint16_t> narrowIndices(indices.begin(), indices.end());
+				return Allocate(vertexData, _vertexCount, narrowIndices.data(), static_cast<uint32_t>(narrowIndices.size()), indexType, outAllocation);
+			}
+			return Allocate(vertexData, _vertexCount, indices.data(), static_cast<uint32_t>(indices.size()), indexType, outAllocation);
+		}
+
+		UploadTicket GeometryPool::Allocate(const void* vertexData, const uint32_t _vertexCount, const void* indexData, const uint32_t _indexCount, const VkIndexType indexType, GeometryAllocation& outAllocation)
+		{
+			uint32_t& indexCount = indexType == VK_INDEX_TYPE_UINT16 ? indexCount16 : indexCount32;
+			const VkDeviceSize indexStride = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+			if (vertexCount + _vertexCount > vertexCapacity || indexCount + _indexCount > indexCapacity)
+			{
+				DEBUG_LOG(LOG::ERRORLOG, "Geometry pool is out of space! Increase BAAL_GEOMETRY_POOL_VERTEX_CAPACITY or BAAL_GEOMETRY_POOL_INDEX_CAPACITY");
+				throw std::runtime_error("Geometry pool is out of space");
+			}
+
+			outAllocation.vertexOffset = static_cast<int32_t>(vertexCount);
+			outAllocation.firstIndex = indexCount;
+			outAllocation.indexCount = _indexCount;
+			outAllocation.indexType = indexType;
+
+			Uploader& uploader = device.GetUploader();
+
+			uploader.UploadBuffer(*vertexBuffer.get(), vertexData, vertexStride * _vertexCount, vertexStride * vertexCount);
+			const UploadTicket ticket = uploader.UploadBuffer(*GetIndexBuffer(indexType).get(), indexData, indexStride * _indexCount, indexStride * indexCount);
+
+			vertexCount += _vertexCount;
+			indexCount += _indexCount;
+			return ticket;
+		}
+	}
+}
@@ -0,0 +1,83 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_GEOMETRY_POOL_H
+#define BAAL_VK_GEOMETRY_POOL_H
+
+#include <vulkan/vulkan_core.h>
+#include <memory>
+#include <vector>
+
+#include "../src/core/vulkan/resource/Uploader.h"
+
+#ifndef BAAL_GEOMETRY_POOL_VERTEX_CAPACITY
+#define BAAL_GEOMETRY_POOL_VERTEX_CAPACITY (1024 * 1024)	// Vertices shared by every Mesh
+#endif // !BAAL_GEOMETRY_POOL_VERTEX_CAPACITY
+
+#ifndef BAAL_GEOMETRY_POOL_INDEX_CAPACITY
+#define BAAL_GEOMETRY_POOL_INDEX_CAPACITY (2 * 1024 * 1024)	// Indices per index type
+#endif // !BAAL_GEOMETRY_POOL_INDEX_CAPACITY
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+		class Buffer;
+
+		// Where a Sub Mesh's geometry lives inside the pool, maps directly onto vkCmdDrawIndexed parameters
+		struct GeometryAllocation
+		{
+			int32_t vertexOffset = 0;
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+			VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+		};
+
+		// One vertex buffer and one index buffer per index type, shared by every Mesh
+		// Sharing the buffers lets any number of draws be issued from a single indirect draw per index type
+		// Indices stay relative to the allocation's vertexOffset, so Sub Meshes under 65536 vertices keep 16-bit indices
+		// Mesh resources live until shutdown, so allocations are never freed and the pool is a simple append only allocator
+		class GeometryPool
+		{
+		public:
+			explicit GeometryPool(
+				LogicalDevice& _device,
+				const VkDeviceSize _vertexStride,
+				const uint32_t _vertexCapacity = BAAL_GEOMETRY_POOL_VERTEX_CAPACITY,
+				const uint32_t _indexCapacity = BAAL_GEOMETRY_POOL_INDEX_CAPACITY);
+			GeometryPool(const GeometryPool&) = delete;
+			GeometryPool(GeometryPool&&) = delete;
+
+			~GeometryPool();
+
+			GeometryPool& operator=(const GeometryPool&) = delete;
+			GeometryPool& operator = (GeometryPool&&) = delete;
+
+			// Stages the geometry through the Uploader, narrowing the indices when indexType is VK_INDEX_TYPE_UINT16
+			// Throws when the pool is out of space
+			UploadTicket Allocate(const void* vertexData, const uint32_t vertexCount, const std::vector<uint32_t>& indices, const VkIndexType indexType, GeometryAllocation& outAllocation);
+
+			// Indices are already the width of indexType, uploaded as they are, e.g. straight from a mapped MeshFile
+			UploadTicket Allocate(const void* vertexData, const uint32_t vertexCount, const void* indexData, const uint32_t _indexCount, const VkIndexType indexType, GeometryAllocation& outAllocation);
+
+			std::shared_ptr<Buffer>& GetVertexBuffer() { return vertexBuffer; }
+			std::shared_ptr<Buffer>& GetIndexBuffer(const VkIndexType indexType) { return indexType == VK_INDEX_TYPE_UINT16 ? indexBuffer16 : indexBuffer32; }
+
+		private:
+			LogicalDevice& device;
+			const VkDeviceSize vertexStride;
+			const uint32_t vertexCapacity;
+			const uint32_t indexCapacity;
+
+			std::shared_ptr<Buffer> vertexBuffer;
+			std::shared_ptr<Buffer> indexBuffer16;
+			std::shared_ptr<Buffer> indexBuffer32;
+
+			uint32_t vertexCount = 0;
+			uint32_t indexCount16 = 0;
+			uint32_t indexCount32 = 0;
+		};
+	}
+}
+
+#endif // !BAAL_VK_GEOMETRY_POOL_H
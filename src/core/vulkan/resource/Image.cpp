@@ -5,8 +5,9 @@
 #include "../src/core/vulkan/debugging/Error.h"
 #include "../src/core/vulkan/devices/LogicalDevice.h"
 #include "../src/core/vulkan/resource/Allocator.h"
-#include "../src/core/vulkan/resource/Buffer.h"
-#include "../src/core/vulkan/commands/CommandBuffer.h"
+#include "../src/core/vulkan/resource/Uploader.h"
+
+#include <algorithm>
 
 namespace Baal
 {
@@ -14,8 +15,8 @@ namespace Baal
 	{
 		Image::Image(
 			LogicalDevice& _device, 
-			const uint32_t width, 
-			const uint32_t height, 
+			const uint32_t _width, 
+			const uint32_t _height, 
 			VkImageType type, 
 			VkFormat format, 
 			VkImageTiling tiling, 
@@ -23,7 +24,10 @@ namespace Baal
 			VkSampleCountFlagBits samples,
 			VkImageViewType viewType,
 			VkImageSubresourceRange subresourceRange):
-			device(_device)
+			device(_device),
+			width(_width),
+			height(_height),
+			mipLevels(subresourceRange.baseMipLevel + subresourceRange.levelCount)
 		{
 			vkFormat = format;
 
@@ -32,7 +36,7 @@ namespace Baal
 			imageInfo.extent.height = height;
 			imageInfo.extent.depth = 1;
 			imageInfo.arrayLayers = 1;
-			imageInfo.mipLevels = 1;
+			imageInfo.mipLevels = mipLevels;
 
 			imageInfo.imageType = type;
 			imageInfo.format = format;
@@ -77,6 +81,9 @@ namespace Baal
 			vkImageView = other.vkImageView;
 			vmaAllocation = other.vmaAllocation;
 			vkFormat = other.vkFormat;
+			width = other.width;
+			height = other.height;
+			mipLevels = other.mipLevels;
 
 			other.vkImage = VK_NULL_HANDLE;
 			other.vkImageView = VK_NULL_HANDLE;
@@ -92,6 +99,16 @@ namespace Baal
 			}
 		}
 
+		uint32_t Image::CalculateMipLevels(const uint32_t width, const uint32_t height)
+		{
+			uint32_t levels = 1;
+			for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+			{
+				++levels;
+			}
+			return levels;
+		}
+
 		void Image::TransitionToLayout(
 			Image& image,
 			VkFormat format,
@@ -103,27 +120,8 @@ namespace Baal
 			VkAccessFlags dstAccessMask,
 			VkImageSubresourceRange subresouceRange)
 		{
-			CommandBuffer commandBuffer(image.device.CreateCommandBuffer());
-
-			VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-			barrier.oldLayout = oldLayout;
-			barrier.newLayout = newLayout;
-
-			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-			barrier.image = image.GetVkImage();
-			barrier.subresourceRange = subresouceRange;
-
-			VkPipelineStageFlags sourceStage = srcStage;
-			VkPipelineStageFlags destinationStage = dstStage;
-
-			barrier.srcAccessMask = srcAccessMask;
-			barrier.dstAccessMask = dstAccessMask;
-
-			vkCmdPipelineBarrier(commandBuffer.GetVkCommandBuffer(), sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-			image.device.FlushCommandBuffer(commandBuffer, image.device.GetGraphicsQueue());
+			// Recorded into the device's current upload batch, which is submitted ahead of the next frame
+			image.device.GetUploader().TransitionImageLayout(image, oldLayout, newLayout, srcStage, dstStage, srcAccessMask, dstAccessMask, subresouceRange);
 		}
 	}
 }
\ No newline at end of file
@@ -16,6 +16,7 @@ namespace Baal
 		class Image
 		{
 		public:
+			// Allocates every mip level up to the last one the subresource range covers, the view covers exactly the range
 			explicit Image(
 				LogicalDevice& _device, 
 				const uint32_t width, 
@@ -39,6 +40,12 @@ namespace Baal
 			VkImage& GetVkImage() { return vkImage; }
 			VkImageView& GetVkImageView() { return vkImageView; }
 			VkFormat& GetVkFormat() { return vkFormat; }
+			uint32_t GetWidth() const { return width; }
+			uint32_t GetHeight() const { return height; }
+			uint32_t GetMipLevels() const { return mipLevels; }
+
+			// Levels of a full mip chain, down to 1x1
+			static uint32_t CalculateMipLevels(const uint32_t width, const uint32_t height);
 
 			static void TransitionToLayout(
 				Image& image, 
@@ -56,7 +63,10 @@ namespace Baal
 			VkImageView vkImageView{ VK_NULL_HANDLE };
 			VmaAllocation vmaAllocation{ VK_NULL_HANDLE };
 			LogicalDevice& device;
-			VkFormat vkFormat;			
+			VkFormat vkFormat;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			uint32_t mipLevels = 1;
 		};
 	}
 }
@@ -6,6 +6,8 @@
 #include "../src/core/vulkan/devices/LogicalDevice.h"
 #include "../src/core/vulkan/devices/PhysicalDevice.h"
 
+#include <algorithm>
+
 namespace Baal
 {
 	namespace VK
@@ -13,7 +15,14 @@ namespace Baal
 		Sampler::Sampler(LogicalDevice& _device, PhysicalDevice& gpu, VkSamplerCreateInfo& samplerCreateInfo):
 			device(_device)
 		{
-			VK_CHECK(vkCreateSampler(device.GetVkDevice(), &samplerCreateInfo, nullptr, &vkSampler), "creating sampler");			
+			VkSamplerCreateInfo createInfo = samplerCreateInfo;
+
+			if (createInfo.anisotropyEnable == VK_TRUE)
+			{
+				createInfo.maxAnisotropy = std::min(createInfo.maxAnisotropy, gpu.GetProperties().limits.maxSamplerAnisotropy);
+			}
+
+			VK_CHECK(vkCreateSampler(device.GetVkDevice(), &createInfo, nullptr, &vkSampler), "creating sampler");			
 		}
 
 		Sampler::~Sampler()
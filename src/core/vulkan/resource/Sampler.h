@@ -15,6 +15,7 @@ namespace Baal
 		class Sampler
 		{
 		public:
+			// maxAnisotropy is clamped to the GPU's limit
 			explicit Sampler(LogicalDevice& _device, PhysicalDevice& gpu, VkSamplerCreateInfo& samplerCreateInfo);
 			Sampler(const Sampler&) = delete;
 			Sampler(Sampler&&) noexcept = delete;
@@ -0,0 +1,605 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "Uploader.h"
+
+#include "../src/core/vulkan/debugging/Error.h"
+#include "../src/core/vulkan/devices/LogicalDevice.h"
+#include "../src/core/vulkan/commands/CommandBuffer.h"
+#include "../src/core/vulkan/resource/Buffer.h"
+#include "../src/core/vulkan/resource/Image.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Baal
+{
+	namespace VK
+	{
+		namespace
+		{
+			// Satisfies the buffer offset rules of vkCmdCopyBufferToImage for every format up to 16 byte texel blocks
+			constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+			// Everything an uploaded resource can be consumed as
+			constexpr VkAccessFlags UPLOAD_CONSUMER_ACCESS = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+			VkDeviceSize AlignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+			{
+				return (value + alignment - 1) & ~(alignment - 1);
+			}
+		}
+
+		Uploader::Batch::Batch(LogicalDevice& _device):
+			device(_device)
+		{
+			commandBuffer = std::make_unique<CommandBuffer>(device.GetCommandPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+			if (device.HasDedicatedTransferQueue())
+			{
+				transferCommandBuffer = std::make_unique<CommandBuffer>(device.GetTransferCommandPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+			}
+		}
+
+		Uploader::Batch::~Batch()
+		{
+			overflowStaging.clear();
+			commandBuffer.reset();
+			transferCommandBuffer.reset();
+		}
+
+		Uploader::Uploader(LogicalDevice& _device, const VkDeviceSize stagingSize /*= BAAL_UPLOAD_STAGING_SIZE*/):
+			device(_device),
+			bDedicatedTransfer(_device.HasDedicatedTransferQueue()),
+			ringCapacity(stagingSize)
+		{
+			stagingRing = std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, ringCapacity);
+			stagingData = stagingRing->GetMappedData();	// Host visible buffers are persistently mapped
+
+			DEBUG_LOG(LOG::INFO, "Created uploader with a {} byte staging ring, dedicated transfer queue: {}", ringCapacity, bDedicatedTransfer);
+		}
+
+		Uploader::~Uploader()
+		{
+			WaitIdle();
+			freeBatches.clear();
+			stagingRing.reset();
+		}
+
+		UploadTicket Uploader::UploadBuffer(Buffer& destination, const void* data, const VkDeviceSize size, const VkDeviceSize dstOffset /*= 0*/)
+		{
+			if (destination.IsHostVisible() && !HasPendingWrite(destination.GetVkBuffer(), dstOffset, size))
+			{
+				// ReBAR or UMA, the host writes the destination itself. Host writes are visible to every later submission
+				destination.Update(const_cast<void*>(data), size, dstOffset);
+				return 0;
+			}
+
+			VkBuffer stagingBuffer = VK_NULL_HANDLE;
+			const VkDeviceSize stagingOffset = Stage(data, size, stagingBuffer);
+			Batch& batch = GetRecordingBatch();
+
+			VkBufferCopy copyRegion{};
+			copyRegion.srcOffset = stagingOffset;
+			copyRegion.dstOffset = dstOffset;
+			copyRegion.size = size;
+			vkCmdCopyBuffer(GetCopyCommandBuffer(batch).GetVkCommandBuffer(), stagingBuffer, destination.GetVkBuffer(), 1, &copyRegion);
+			batch.bufferWrites.push_back({ destination.GetVkBuffer(), dstOffset, size });
+
+			if (bDedicatedTransfer)
+			{
+				// Release on the transfer queue, acquire on the graphics queue, both barriers must describe the same range and families
+				VkBufferMemoryBarrier barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+				barrier.srcQueueFamilyIndex = device.GetTransferQueueFamilyIndex();
+				barrier.dstQueueFamilyIndex = device.GetGraphicsQueueFamilyIndex();
+				barrier.buffer = destination.GetVkBuffer();
+				barrier.offset = dstOffset;
+				barrier.size = size;
+
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = 0;
+				vkCmdPipelineBarrier(batch.transferCommandBuffer->GetVkCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+				barrier.srcAccessMask = 0;
+				barrier.dstAccessMask = UPLOAD_CONSUMER_ACCESS;
+				vkCmdPipelineBarrier(batch.commandBuffer->GetVkCommandBuffer(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+			}
+
+			return batch.ticket;
+		}
+
+		UploadTicket Uploader::UploadBufferInUse(Buffer& destination, const void* data, const VkDeviceSize size, const VkDeviceSize dstOffset, VkPipelineStageFlags readStages, VkAccessFlags readAccessMask)
+		{
+			VkBuffer stagingBuffer = VK_NULL_HANDLE;
+			const VkDeviceSize stagingOffset = Stage(data, size, stagingBuffer);
+			Batch& batch = GetRecordingBatch();
+			VkCommandBuffer commandBuffer = batch.commandBuffer->GetVkCommandBuffer();
+
+			VkBufferMemoryBarrier barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = destination.GetVkBuffer();
+			barrier.offset = dstOffset;
+			barrier.size = size;
+
+			// Write after read, an execution dependency on the reads of earlier submissions is enough
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, readStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+			VkBufferCopy copyRegion{};
+			copyRegion.srcOffset = stagingOffset;
+			copyRegion.dstOffset = dstOffset;
+			copyRegion.size = size;
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer, destination.GetVkBuffer(), 1, &copyRegion);
+			batch.bufferWrites.push_back({ destination.GetVkBuffer(), dstOffset, size });
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = readAccessMask;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, readStages, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+			return batch.ticket;
+		}
+
+		UploadTicket Uploader::UploadImage(
+			Image& destination,
+			const void* data,
+			const VkDeviceSize size,
+			const uint32_t width,
+			const uint32_t height,
+			VkImageSubresourceRange subresourceRange,
+			VkImageLayout finalLayout /*= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/,
+			VkPipelineStageFlags dstStage /*= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT*/,
+			VkAccessFlags dstAccessMask /*= VK_ACCESS_SHADER_READ_BIT*/)
+		{
+			const ImageUploadLevel level = { data, size, width, height };
+			return UploadImageLevels(destination, { level }, subresourceRange, finalLayout, dstStage, dstAccessMask);
+		}
+
+		UploadTicket Uploader::UploadImageLevels(
+			Image& destination,
+			const std::vector<ImageUploadLevel>& levels,
+			VkImageSubresourceRange subresourceRange,
+			VkImageLayout finalLayout /*= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/,
+			VkPipelineStageFlags dstStage /*= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT*/,
+			VkAccessFlags dstAccessMask /*= VK_ACCESS_SHADER_READ_BIT*/)
+		{
+			// Every level is staged in one reservation, staging them one by one could submit the batch between two levels
+			VkDeviceSize stagingSize = 0;
+			for (const ImageUploadLevel& level : levels)
+			{
+				stagingSize = AlignUp(stagingSize, STAGING_ALIGNMENT) + level.size;
+			}
+
+			VkBuffer stagingBuffer = VK_NULL_HANDLE;
+			uint8_t* stagingPointer = nullptr;
+			const VkDeviceSize stagingOffset = Reserve(stagingSize, stagingBuffer, stagingPointer);
+			Batch& batch = GetRecordingBatch();
+			VkCommandBuffer copyCommandBuffer = GetCopyCommandBuffer(batch).GetVkCommandBuffer();
+
+			VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = destination.GetVkImage();
+			barrier.subresourceRange = subresourceRange;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(copyCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			std::vector<VkBufferImageCopy> copyRegions(levels.size());
+			VkDeviceSize levelOffset = 0;
+			for (size_t i = 0; i < levels.size(); ++i)
+			{
+				levelOffset = AlignUp(levelOffset, STAGING_ALIGNMENT);
+				std::memcpy(stagingPointer + levelOffset, levels[i].data, levels[i].size);
+
+				VkBufferImageCopy& copyRegion = copyRegions[i];
+				copyRegion.bufferOffset = stagingOffset + levelOffset;
+				copyRegion.bufferRowLength = 0;
+				copyRegion.bufferImageHeight = 0;
+
+				copyRegion.imageSubresource.aspectMask = subresourceRange.aspectMask;
+				copyRegion.imageSubresource.mipLevel = subresourceRange.baseMipLevel + static_cast<uint32_t>(i);
+				copyRegion.imageSubresource.baseArrayLayer = subresourceRange.baseArrayLayer;
+				copyRegion.imageSubresource.layerCount = subresourceRange.layerCount;
+
+				copyRegion.imageOffset = { 0, 0, 0 };
+				copyRegion.imageExtent = { levels[i].width, levels[i].height, 1 };
+
+				levelOffset += levels[i].size;
+			}
+
+			vkCmdCopyBufferToImage(copyCommandBuffer, stagingBuffer, destination.GetVkImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
+
+			const uint32_t width = levels[0].width;
+			const uint32_t height = levels[0].height;
+			const bool bGenerateMips = levels.size() == 1 && subresourceRange.levelCount > 1;
+			if (!bDedicatedTransfer)
+			{
+				if (bGenerateMips)
+				{
+					RecordMipChain(copyCommandBuffer, destination, width, height, subresourceRange, finalLayout, dstStage, dstAccessMask);
+					return batch.ticket;
+				}
+				return TransitionImageLayout(destination, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, VK_ACCESS_TRANSFER_WRITE_BIT, dstAccessMask, subresourceRange);
+			}
+
+			// The layout transition to finalLayout happens as part of the ownership transfer, release and acquire must match
+			// Blits need a graphics queue, so an image with mips stays in TRANSFER_DST and the chain is recorded after the acquire
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = bGenerateMips ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : finalLayout;
+			barrier.srcQueueFamilyIndex = device.GetTransferQueueFamilyIndex();
+			barrier.dstQueueFamilyIndex = device.GetGraphicsQueueFamilyIndex();
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			vkCmdPipelineBarrier(copyCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			VkCommandBuffer graphicsCommandBuffer = batch.commandBuffer->GetVkCommandBuffer();
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = bGenerateMips ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : dstAccessMask;
+			vkCmdPipelineBarrier(graphicsCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, bGenerateMips ? VK_PIPELINE_STAGE_TRANSFER_BIT : dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			if (bGenerateMips)
+			{
+				RecordMipChain(graphicsCommandBuffer, destination, width, height, subresourceRange, finalLayout, dstStage, dstAccessMask);
+			}
+
+			return batch.ticket;
+		}
+
+		void Uploader::RecordMipChain(VkCommandBuffer commandBuffer, Image& image, const uint32_t width, const uint32_t height, const VkImageSubresourceRange& subresourceRange, VkImageLayout finalLayout, VkPipelineStageFlags dstStage, VkAccessFlags dstAccessMask)
+		{
+			// Every level starts in TRANSFER_DST, each one is read once to write the next and then goes straight to finalLayout
+			VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image.GetVkImage();
+			barrier.subresourceRange = subresourceRange;
+			barrier.subresourceRange.levelCount = 1;
+
+			int32_t mipWidth = static_cast<int32_t>(width);
+			int32_t mipHeight = static_cast<int32_t>(height);
+			const uint32_t lastLevel = subresourceRange.baseMipLevel + subresourceRange.levelCount - 1;
+			for (uint32_t level = subresourceRange.baseMipLevel; level < lastLevel; ++level)
+			{
+				barrier.subresourceRange.baseMipLevel = level;
+				barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+				const int32_t nextWidth = std::max(mipWidth / 2, 1);
+				const int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+				VkImageBlit blit{};
+				blit.srcOffsets[0] = { 0, 0, 0 };
+				blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+				blit.srcSubresource.aspectMask = subresourceRange.aspectMask;
+				blit.srcSubresource.mipLevel = level;
+				blit.srcSubresource.baseArrayLayer = subresourceRange.baseArrayLayer;
+				blit.srcSubresource.layerCount = subresourceRange.layerCount;
+				blit.dstOffsets[0] = { 0, 0, 0 };
+				blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+				blit.dstSubresource = blit.srcSubresource;
+				blit.dstSubresource.mipLevel = level + 1;
+				vkCmdBlitImage(commandBuffer, image.GetVkImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image.GetVkImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+				barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				barrier.newLayout = finalLayout;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				barrier.dstAccessMask = dstAccessMask;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+				mipWidth = nextWidth;
+				mipHeight = nextHeight;
+			}
+
+			// The last level is only ever written
+			barrier.subresourceRange.baseMipLevel = lastLevel;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = finalLayout;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = dstAccessMask;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		UploadTicket Uploader::TransitionImageLayout(
+			Image& image,
+			VkImageLayout oldLayout,
+			VkImageLayout newLayout,
+			VkPipelineStageFlags srcStage,
+			VkPipelineStageFlags dstStage,
+			VkAccessFlags srcAccessMask,
+			VkAccessFlags dstAccessMask,
+			VkImageSubresourceRange subresourceRange)
+		{
+			Batch& batch = GetRecordingBatch();
+
+			VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image.GetVkImage();
+			barrier.subresourceRange = subresourceRange;
+			barrier.srcAccessMask = srcAccessMask;
+			barrier.dstAccessMask = dstAccessMask;
+
+			vkCmdPipelineBarrier(batch.commandBuffer->GetVkCommandBuffer(), srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			return batch.ticket;
+		}
+
+		UploadTicket Uploader::Submit()
+		{
+			SubmitAcquires(0);
+
+			if (currentBatch == nullptr)
+			{
+				return nextTicket - 1;	// Nothing recorded, the last handed out ticket is the latest one
+			}
+
+			const UploadTicket ticket = currentBatch->ticket;
+
+			if (bDedicatedTransfer)
+			{
+				currentBatch->transferCommandBuffer->EndRecording();
+				currentBatch->transferValue = device.GetTransferTimeline().Submit({ currentBatch->transferCommandBuffer->GetVkCommandBuffer() });
+
+				// The graphics side is submitted once the transfer has finished, see SubmitAcquires()
+				transferringBatches.push_back(std::move(currentBatch));
+				return ticket;
+			}
+
+			// Make every transfer write of the batch visible to whatever is submitted after it
+			VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = UPLOAD_CONSUMER_ACCESS;
+			vkCmdPipelineBarrier(currentBatch->commandBuffer->GetVkCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			currentBatch->commandBuffer->EndRecording();
+			currentBatch->graphicsValue = device.GetGraphicsTimeline().Submit({ currentBatch->commandBuffer->GetVkCommandBuffer() });
+
+			inFlightBatches.push_back(std::move(currentBatch));
+			return ticket;
+		}
+
+		bool Uploader::IsComplete(const UploadTicket ticket)
+		{
+			return ticket <= GetCompletedTicket();
+		}
+
+		UploadTicket Uploader::GetCompletedTicket()
+		{
+			RetireCompletedBatches(false);
+			return completedTicket;
+		}
+
+		void Uploader::Wait(const UploadTicket ticket)
+		{
+			if (currentBatch != nullptr && ticket >= currentBatch->ticket)
+			{
+				Submit();
+			}
+
+			SubmitAcquires(ticket);
+
+			while (ticket > completedTicket && !inFlightBatches.empty())
+			{
+				RetireCompletedBatches(true);
+			}
+		}
+
+		void Uploader::WaitIdle()
+		{
+			Wait(nextTicket - 1);
+		}
+
+		Uploader::Batch& Uploader::GetRecordingBatch()
+		{
+			if (currentBatch == nullptr)
+			{
+				RetireCompletedBatches(false);
+
+				if (!freeBatches.empty())
+				{
+					currentBatch = std::move(freeBatches.back());
+					freeBatches.pop_back();
+					currentBatch->commandBuffer->Reset();
+					if (bDedicatedTransfer)
+					{
+						currentBatch->transferCommandBuffer->Reset();
+					}
+				}
+				else
+				{
+					currentBatch = std::make_unique<Batch>(device);
+				}
+
+				currentBatch->ticket = nextTicket++;
+				currentBatch->ringBytes = 0;
+				currentBatch->commandBuffer->BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+				if (bDedicatedTransfer)
+				{
+					currentBatch->transferCommandBuffer->BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+				}
+			}
+
+			return *currentBatch.get();
+		}
+
+		CommandBuffer& Uploader::GetCopyCommandBuffer(Batch& batch)
+		{
+			return bDedicatedTransfer ? *batch.transferCommandBuffer.get() : *batch.commandBuffer.get();
+		}
+
+		VkDeviceSize Uploader::Stage(const void* data, const VkDeviceSize size, VkBuffer& outStagingBuffer)
+		{
+			uint8_t* stagingPointer = nullptr;
+			const VkDeviceSize offset = Reserve(size, outStagingBuffer, stagingPointer);
+			std::memcpy(stagingPointer, data, size);
+			return offset;
+		}
+
+		VkDeviceSize Uploader::Reserve(const VkDeviceSize size, VkBuffer& outStagingBuffer, uint8_t*& outStagingPointer)
+		{
+			if (size > ringCapacity)
+			{
+				// Too large to ever fit into the ring, give it its own staging buffer that lives as long as the batch
+				Batch& batch = GetRecordingBatch();
+				batch.overflowStaging.push_back(std::make_unique<Buffer>(device.GetAllocator(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, size));
+				outStagingBuffer = batch.overflowStaging.back()->GetVkBuffer();
+				outStagingPointer = batch.overflowStaging.back()->GetMappedData();
+				return 0;
+			}
+
+			VkDeviceSize offset = 0;
+			while (!TryAllocate(size, offset))
+			{
+				// The ring is full, push out what is recorded and wait on the oldest batch to hand its space back
+				Submit();
+				WaitForOldestBatch();
+			}
+
+			outStagingBuffer = stagingRing->GetVkBuffer();
+			outStagingPointer = stagingData + offset;
+			return offset;
+		}
+
+		bool Uploader::TryAllocate(const VkDeviceSize size, VkDeviceSize& outOffset)
+		{
+			Batch& batch = GetRecordingBatch();
+
+			VkDeviceSize offset = AlignUp(ringHead, STAGING_ALIGNMENT);
+			VkDeviceSize required = (offset - ringHead) + size;
+
+			if (offset + size > ringCapacity)
+			{
+				// Not enough room before the end of the ring, skip the tail and wrap around to the start
+				offset = 0;
+				required = (ringCapacity - ringHead) + size;
+			}
+
+			if (ringUsed + required > ringCapacity)
+			{
+				return false;
+			}
+
+			batch.ringBytes += required;
+			ringUsed += required;
+			ringHead = offset + size;
+			outOffset = offset;
+			return true;
+		}
+
+		bool Uploader::HasPendingWrite(const VkBuffer buffer, const VkDeviceSize offset, const VkDeviceSize size)
+		{
+			RetireCompletedBatches(false);
+
+			const auto Overlaps = [buffer, offset, size](const Batch& batch)
+			{
+				for (const BufferRange& range : batch.bufferWrites)
+				{
+					if (range.buffer == buffer && range.offset < offset + size && offset < range.offset + range.size)
+					{
+						return true;
+					}
+				}
+				return false;
+			};
+
+			if (currentBatch != nullptr && Overlaps(*currentBatch.get()))
+			{
+				return true;
+			}
+
+			for (const std::unique_ptr<Batch>& batch : transferringBatches)
+			{
+				if (Overlaps(*batch.get()))
+				{
+					return true;
+				}
+			}
+
+			for (const std::unique_ptr<Batch>& batch : inFlightBatches)
+			{
+				if (Overlaps(*batch.get()))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void Uploader::SubmitAcquires(const UploadTicket waitTicket)
+		{
+			// Transfers finish in submission order, hand each finished one to the graphics queue
+			// Submitting only finished transfers keeps the graphics queue from ever stalling on the transfer timeline
+			QueueTimeline& transferTimeline = device.GetTransferTimeline();
+			while (!transferringBatches.empty())
+			{
+				Batch& batch = *transferringBatches.front().get();
+				if (batch.ticket <= waitTicket)
+				{
+					transferTimeline.Wait(batch.transferValue);
+				}
+				else if (!transferTimeline.IsComplete(batch.transferValue))
+				{
+					break;
+				}
+
+				batch.commandBuffer->EndRecording();
+
+				// Already reached, but the wait is what orders the release on the transfer queue before the acquire
+				SemaphoreWait transferWait;
+				transferWait.semaphore = transferTimeline.GetVkSemaphore();
+				transferWait.value = batch.transferValue;
+				transferWait.stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+				batch.graphicsValue = device.GetGraphicsTimeline().Submit({ batch.commandBuffer->GetVkCommandBuffer() }, { transferWait });
+
+				inFlightBatches.push_back(std::move(transferringBatches.front()));
+				transferringBatches.pop_front();
+			}
+		}
+
+		void Uploader::RetireCompletedBatches(const bool bWaitForOldest)
+		{
+			QueueTimeline& graphicsTimeline = device.GetGraphicsTimeline();
+			if (bWaitForOldest && !inFlightBatches.empty())
+			{
+				graphicsTimeline.Wait(inFlightBatches.front()->graphicsValue);
+			}
+
+			// Batches are submitted to a single queue, so they finish in the order they were submitted
+			while (!inFlightBatches.empty() && graphicsTimeline.IsComplete(inFlightBatches.front()->graphicsValue))
+			{
+				std::unique_ptr<Batch> batch = std::move(inFlightBatches.front());
+				inFlightBatches.pop_front();
+
+				ringUsed -= batch->ringBytes;
+				completedTicket = batch->ticket;
+
+				batch->overflowStaging.clear();
+				batch->bufferWrites.clear();
+				freeBatches.push_back(std::move(batch));
+			}
+
+			if (ringUsed == 0 && (currentBatch == nullptr || currentBatch->ringBytes == 0))
+			{
+				ringHead = 0;
+			}
+		}
+
+		void Uploader::WaitForOldestBatch()
+		{
+			if (inFlightBatches.empty() && !transferringBatches.empty())
+			{
+				SubmitAcquires(transferringBatches.front()->ticket);
+			}
+			RetireCompletedBatches(true);
+		}
+	}
+}
@@ -0,0 +1,167 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_VK_UPLOADER_H
+#define BAAL_VK_UPLOADER_H
+
+#include <vulkan/vulkan_core.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "../src/core/vulkan/commands/QueueTimeline.h"
+
+#ifndef BAAL_UPLOAD_STAGING_SIZE
+#define BAAL_UPLOAD_STAGING_SIZE (32 * 1024 * 1024)	// Size of the persistent staging ring in bytes
+#endif // !BAAL_UPLOAD_STAGING_SIZE
+
+namespace Baal
+{
+	namespace VK
+	{
+		class LogicalDevice;
+		class CommandBuffer;
+		class Buffer;
+		class Image;
+
+		// One mip level of an image upload, already in the image's format
+		struct ImageUploadLevel
+		{
+			const void* data;
+			VkDeviceSize size;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		// Identifies the batch an upload was recorded into, 0 is never handed out and is always complete
+		using UploadTicket = uint64_t;
+
+		// Batches staging copies and layout transitions into one command buffer per submit
+		// Source data is written into a persistently mapped staging ring, the ring space is reclaimed once the graphics timeline passes the batch
+		//
+		// With a dedicated transfer queue family, copies run on the transfer queue and every destination is released to the graphics family.
+		// Once the transfer timeline passes the batch, a small graphics submission waits on it and acquires the resources,
+		// so rendering never waits on an in-progress transfer. Without one, everything is recorded into a single graphics queue submission.
+		class Uploader
+		{
+		public:
+			explicit Uploader(LogicalDevice& _device, const VkDeviceSize stagingSize = BAAL_UPLOAD_STAGING_SIZE);
+			Uploader(const Uploader&) = delete;
+			Uploader(Uploader&&) = delete;
+
+			~Uploader();
+
+			Uploader& operator=(const Uploader&) = delete;
+			Uploader& operator = (Uploader&&) = delete;
+
+			// The destination range must not be read by a submission that may still be executing, see UploadBufferInUse() for that
+			// Host visible destinations, e.g. device local memory on ReBAR and UMA systems, are written directly and return the always complete ticket 0,
+			// unless a staged copy into an overlapping range has not completed yet. The write is then staged as well, so it lands after that copy
+			UploadTicket UploadBuffer(Buffer& destination, const void* data, const VkDeviceSize size, const VkDeviceSize dstOffset = 0);
+
+			// Overwrites a range that frames in flight may still be reading, e.g. a slot of a table bound every frame
+			// Always staged and recorded on the graphics queue between two barriers, so the copy waits for every earlier read in readStages
+			// and every later read sees it. The destination must only ever be used by the graphics queue family
+			UploadTicket UploadBufferInUse(Buffer& destination, const void* data, const VkDeviceSize size, const VkDeviceSize dstOffset, VkPipelineStageFlags readStages, VkAccessFlags readAccessMask);
+
+			// Transitions the image to TRANSFER_DST, copies the pixels into it and transitions it to finalLayout
+			// The pixels fill the range's base mip level, with more than one level in the range the rest are generated from it with a chain of
+			// linear blits on the graphics queue, so the format must support BLIT_SRC, BLIT_DST and SAMPLED_IMAGE_FILTER_LINEAR and the image TRANSFER_SRC usage
+			UploadTicket UploadImage(
+				Image& destination,
+				const void* data,
+				const VkDeviceSize size,
+				const uint32_t width,
+				const uint32_t height,
+				VkImageSubresourceRange subresourceRange,
+				VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				VkAccessFlags dstAccessMask = VK_ACCESS_SHADER_READ_BIT);
+
+			// Copies precomputed mip levels, e.g. block compressed ones from a TextureFile, into consecutive levels from the range's base mip level
+			// Nothing is generated, pass one level per level of the range. A single level with a larger range behaves like UploadImage()
+			UploadTicket UploadImageLevels(
+				Image& destination,
+				const std::vector<ImageUploadLevel>& levels,
+				VkImageSubresourceRange subresourceRange,
+				VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				VkAccessFlags dstAccessMask = VK_ACCESS_SHADER_READ_BIT);
+
+			// Always recorded for the graphics queue
+			UploadTicket TransitionImageLayout(
+				Image& image,
+				VkImageLayout oldLayout,
+				VkImageLayout newLayout,
+				VkPipelineStageFlags srcStage,
+				VkPipelineStageFlags dstStage,
+				VkAccessFlags srcAccessMask,
+				VkAccessFlags dstAccessMask,
+				VkImageSubresourceRange subresourceRange);
+
+			// Submits everything recorded so far, and hands finished transfers over to the graphics queue
+			// Returns the ticket of the submitted batch
+			UploadTicket Submit();
+
+			// Non-blocking, also reclaims the staging space of every finished batch
+			bool IsComplete(const UploadTicket ticket);
+			UploadTicket GetCompletedTicket();
+			void Wait(const UploadTicket ticket);
+			void WaitIdle();
+
+			bool HasPendingUploads() const { return currentBatch != nullptr; }
+
+		private:
+			struct BufferRange
+			{
+				VkBuffer buffer;
+				VkDeviceSize offset;
+				VkDeviceSize size;
+			};
+
+			struct Batch
+			{
+				explicit Batch(LogicalDevice& device);
+				~Batch();
+
+				LogicalDevice& device;
+				std::unique_ptr<CommandBuffer> transferCommandBuffer;	// Only with a dedicated transfer queue
+				std::unique_ptr<CommandBuffer> commandBuffer;			// Graphics queue, acquires ownership and records layout transitions
+				TimelineValue transferValue = 0;	// On the transfer timeline, only with a dedicated transfer queue
+				TimelineValue graphicsValue = 0;	// On the graphics timeline, the batch is complete once it is reached
+				UploadTicket ticket = 0;
+				VkDeviceSize ringBytes = 0;		// Staging ring bytes, including alignment padding, owned by this batch
+				std::vector<std::unique_ptr<Buffer>> overflowStaging;	// Uploads larger than the whole ring get their own staging buffer
+				std::vector<BufferRange> bufferWrites;	// Destination ranges of the batch's buffer copies
+			};
+
+			LogicalDevice& device;
+			const bool bDedicatedTransfer;
+			std::unique_ptr<Buffer> stagingRing;
+			uint8_t* stagingData{ nullptr };
+			VkDeviceSize ringCapacity = 0;
+			VkDeviceSize ringHead = 0;
+			VkDeviceSize ringUsed = 0;
+
+			std::unique_ptr<Batch> currentBatch;
+			std::deque<std::unique_ptr<Batch>> transferringBatches;	// Submitted to the transfer queue, not yet acquired by the graphics queue
+			std::deque<std::unique_ptr<Batch>> inFlightBatches;		// Submitted to the graphics queue
+			std::vector<std::unique_ptr<Batch>> freeBatches;
+
+			UploadTicket nextTicket = 1;
+			UploadTicket completedTicket = 0;
+
+			Batch& GetRecordingBatch();
+			CommandBuffer& GetCopyCommandBuffer(Batch& batch);
+			VkDeviceSize Stage(const void* data, const VkDeviceSize size, VkBuffer& outStagingBuffer);
+			VkDeviceSize Reserve(const VkDeviceSize size, VkBuffer& outStagingBuffer, uint8_t*& outStagingPointer);	// Staging space the caller writes itself
+			bool TryAllocate(const VkDeviceSize size, VkDeviceSize& outOffset);
+			bool HasPendingWrite(const VkBuffer buffer, const VkDeviceSize offset, const VkDeviceSize size);	// Recorded or submitted, and not yet complete
+			void RecordMipChain(VkCommandBuffer commandBuffer, Image& image, const uint32_t width, const uint32_t height, const VkImageSubresourceRange& subresourceRange, VkImageLayout finalLayout, VkPipelineStageFlags dstStage, VkAccessFlags dstAccessMask);
+			void SubmitAcquires(const UploadTicket waitTicket);
+			void RetireCompletedBatches(const bool bWaitForOldest);
+			void WaitForOldestBatch();
+		};
+	}
+}
+
+#endif // !BAAL_VK_UPLOADER_H
@@ -6,24 +6,34 @@
 #include "../src/core/vulkan/devices/PhysicalDevice.h"
 #include "../src/core/vulkan/devices/LogicalDevice.h"
 #include "../src/core/vulkan/resource/Buffer.h"
+#include "../src/core/vulkan/resource/Uploader.h"
 #include "../src/core/vulkan/resource/Image.h"
+#include "../src/core/vulkan/resource/GeometryPool.h"
+#include "../src/core/vulkan/resource/FrameAllocator.h"
 #include "../src/core/vulkan/commands/CommandBuffer.h"
+#include "../src/core/vulkan/commands/ParallelCommandRecorder.h"
 #include "../src/core/vulkan/presentation/SwapChain.h"
 #include "../src/core/vulkan/pipeline/RenderPass.h"
 #include "../src/core/vulkan/pipeline/Framebuffer.h"
 #include "../src/core/vulkan/pipeline/ShaderModule.h"
 #include "../src/core/vulkan/pipeline/GraphicsPipeline.h"
+#include "../src/core/vulkan/pipeline/IndirectDrawPass.h"
+#include "../src/core/vulkan/pipeline/InstancedDrawBuilder.h"
 #include "../src/core/vulkan/descriptors/DescriptorPool.h"
 #include "../src/core/vulkan/descriptors/DescriptorSetLayout.h"
 #include "../src/core/vulkan/descriptors/DescriptorSet.h"
+#include "../src/core/vulkan/descriptors/BindlessTable.h"
 #include "../src/core/3d/MeshHandler.h"
 #include "../src/core/3d/Mesh.h"
 #include "../src/core/3d/Camera.h"
 #include "../src/core/3d/Texture.h"
 #include "../src/core/3d/Light.h"
 #include "../src/core/vulkan/resource/Sampler.h"
+#include "../src/core/jobs/JobSystem.h"
+#include "../src/utility/DebugLog.h"
 
 #include <array>
+#include <cstring>
 
 namespace Baal
 {
@@ -42,31 +52,38 @@ namespace Baal
 
 		void TestRenderer::Initialize()
 		{
-			AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "spoon.obj"));
-			AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "spoon.obj"));
-			destroyTarget = AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "spoon.obj"));
-			AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "Skull.obj"));
-			AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "teacup.obj"));
-			AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "teacup.obj"));
-			AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "spoon.obj"));
-			AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "teapot.obj"));
-			AddMeshInstanceToScene(LoadMeshResource(BAAL_MODELS_DIR, "teacup.obj"));
+			// Instances draw the placeholder mesh until their mesh is resident
+			AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "spoon.obj"));
+			AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "spoon.obj"));
+			destroyTarget = AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "spoon.obj"));
+			AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "Skull.obj"));
+			AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "teacup.obj"));
+			AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "teacup.obj"));
+			AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "spoon.obj"));
+			AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "teapot.obj"));
+			AddMeshInstanceToScene(LoadMeshResourceAsync(BAAL_MODELS_DIR, "teacup.obj"));
 
 			CreateTextures();
 
 			CreateTestLights();
 
+			CreateIndirectDrawPass();
+			CreateInstancedDrawBuilder();
+
 			CreateDescriptorPool();
 			CreateDescriptorSetLayout();
 			CreatePipelines();
-			CreateDescriptorSet();
+			CreateDescriptorSets();
 		}
 
 		void TestRenderer::Destroy()
 		{
 			DestroyPipelines();
+			descriptorSets.clear();
 			descriptorSetLayout.reset();
 			descriptorPool.reset();
+			indirectDrawPass.reset();
+			instancedDrawBuilder.reset();
 
 			DestroyTextures();
 			
@@ -79,7 +96,7 @@ namespace Baal
 			renderPassInfo.renderPass = GetRenderPass().GetVkRenderPass();
 			renderPassInfo.clearValueCount = 1;
 			renderPassInfo.renderArea.offset = { 0, 0 };
-			renderPassInfo.renderArea.extent = GetSwapChain().GetExtent();
+			renderPassInfo.renderArea.extent = GetRenderExtent();
 
 			renderPassInfo.framebuffer = frameBuffer.GetVkFramebuffer();
 
@@ -93,59 +110,142 @@ namespace Baal
 			renderPassInfo.clearValueCount = clearValues.size();
 			renderPassInfo.pClearValues = clearValues.data();
 
-			vkCmdBeginRenderPass(commandBuffer.GetVkCommandBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+			if (indirectDrawPass != nullptr)
+			{
+				// Culling writes the draw commands, so it has to run before the render pass begins
+				indirectDrawPass->Update(GetFrameIndex(), GetMeshHandler());
+				indirectDrawPass->RecordCulling(commandBuffer, GetFrameIndex());
+
+				vkCmdBeginRenderPass(commandBuffer.GetVkCommandBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+				RecordIndirectDraws(commandBuffer);
+				vkCmdEndRenderPass(commandBuffer.GetVkCommandBuffer());
+
+				commandBuffer.EndRecording();
+				return;
+			}
+
+			// Draws are recorded into secondary command buffers across threads, see RecordDrawChunk()
+			vkCmdBeginRenderPass(commandBuffer.GetVkCommandBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
+			VkCommandBufferInheritanceInfo inheritanceInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+			inheritanceInfo.renderPass = GetRenderPass().GetVkRenderPass();
+			inheritanceInfo.subpass = 0;
+			inheritanceInfo.framebuffer = frameBuffer.GetVkFramebuffer();
+
+			// Repeated sub meshes are merged into one instanced draw each
+			instancedDrawBuilder->Build(GetFrameIndex(), GetMeshHandler(), GetCamera().GetTransform().GetPosition());
+			const uint32_t drawCount = static_cast<uint32_t>(instancedDrawBuilder->GetDraws().size());
+			GetCommandRecorder().Record(commandBuffer, GetFrameIndex(), inheritanceInfo, drawCount,
+				[this](CommandBuffer& secondaryCommandBuffer, const uint32_t begin, const uint32_t end)
+				{
+					RecordDrawChunk(secondaryCommandBuffer, begin, end);
+				});
+
+			vkCmdEndRenderPass(commandBuffer.GetVkCommandBuffer());
+
+			commandBuffer.EndRecording();
+		}
+
+		void TestRenderer::RecordDrawChunk(CommandBuffer& commandBuffer, const uint32_t begin, const uint32_t end)
+		{
+			// Secondary command buffers inherit no state, every chunk binds its own pipeline and dynamic state
 			vkCmdBindPipeline(commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, forwardPipeline->GetVkGraphicsPipeline());
 
 			VkViewport viewport{};
 			viewport.x = 0.0f;
 			viewport.y = 0.0f;
-			viewport.width = static_cast<float>(GetSwapChain().GetExtent().width);
-			viewport.height = static_cast<float>(GetSwapChain().GetExtent().height);
+			viewport.width = static_cast<float>(GetRenderExtent().width);
+			viewport.height = static_cast<float>(GetRenderExtent().height);
 			viewport.minDepth = 0.0f;
 			viewport.maxDepth = 1.0f;
 			vkCmdSetViewport(commandBuffer.GetVkCommandBuffer(), 0, 1, &viewport);
 
 			VkRect2D scissor{};
 			scissor.offset = { 0, 0 };
-			scissor.extent = GetSwapChain().GetExtent();
+			scissor.extent = GetRenderExtent();
 			vkCmdSetScissor(commandBuffer.GetVkCommandBuffer(), 0, 1, &scissor);
 
-			VkDeviceSize offsets[] = { 0 };
+			vkCmdBindDescriptorSets(commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, forwardPipeline->GetVkGraphicsPipelineLayout(), 0, 1, &descriptorSets[GetFrameIndex()]->GetVkDescriptorSet(), static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
 
-			std::vector<std::shared_ptr<SubMeshInstance>>& subMeshes = GetMeshHandler().GetSubMeshInstances();
-			for (size_t i = 0; i < subMeshes.size(); ++i)
+			// Every texture and material lives in set 1, a draw only pushes the index of its material
+			BindlessTable* bindlessTable = GetBindlessTable();
+			if (bindlessTable != nullptr)
 			{
-				vkCmdBindVertexBuffers(commandBuffer.GetVkCommandBuffer(), 0, 1, &subMeshes[i]->GetVertexBuffer().GetVkBuffer(), offsets);
-				vkCmdBindIndexBuffer(commandBuffer.GetVkCommandBuffer(), subMeshes[i]->GetIndexBuffer().GetVkBuffer(), 0, VK_INDEX_TYPE_UINT32);
+				vkCmdBindDescriptorSets(commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, forwardPipeline->GetVkGraphicsPipelineLayout(), 1, 1, &bindlessTable->GetDescriptorSet().GetVkDescriptorSet(), 0, nullptr);
+			}
+
+			// Every sub mesh lives in the shared GeometryPool buffers, only the index buffer changes with the index type
+			// Binding 1 holds the model matrices of every instanced draw, indexed by firstInstance
+			GeometryPool& geometryPool = GetMeshHandler().GetGeometryPool();
+			VkBuffer vertexBuffers[] = { geometryPool.GetVertexBuffer()->GetVkBuffer(), instancedDrawBuilder->GetInstanceBuffer(GetFrameIndex()).GetVkBuffer() };
+			VkDeviceSize offsets[] = { 0, 0 };
+			vkCmdBindVertexBuffers(commandBuffer.GetVkCommandBuffer(), 0, 2, vertexBuffers, offsets);
 
-				VertexPushConstants vertConstants(GetMeshHandler().GetMeshInstances()[subMeshes[i]->GetParentId()]->model);
-				vkCmdPushConstants(commandBuffer.GetVkCommandBuffer(), forwardPipeline->GetVkGraphicsPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VertexPushConstants), &vertConstants);
+			// Draws are sorted by material and then geometry, so consecutive draws often share state that is already bound
+			VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+			const InstancedDraw* previousDraw = nullptr;
 
-				FragmentPushConstants fragConstants(subMeshes[i]->GetMaterial());
-				vkCmdPushConstants(commandBuffer.GetVkCommandBuffer(), forwardPipeline->GetVkGraphicsPipelineLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(VertexPushConstants), sizeof(FragmentPushConstants), &fragConstants);
-				
-				uint32_t dynamicOffset = 3 * static_cast<uint32_t>(dynamicAlignment);
-				vkCmdBindDescriptorSets(commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, forwardPipeline->GetVkGraphicsPipelineLayout(), 0, 1, &descriptorSet->GetVkDescriptorSet(), 1, &dynamicOffset);
+			const std::vector<InstancedDraw>& draws = instancedDrawBuilder->GetDraws();
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const InstancedDraw& draw = draws[i];
+				if (draw.indexType != boundIndexType)
+				{
+					vkCmdBindIndexBuffer(commandBuffer.GetVkCommandBuffer(), geometryPool.GetIndexBuffer(draw.indexType)->GetVkBuffer(), 0, draw.indexType);
+					boundIndexType = draw.indexType;
+				}
 
-				vkCmdDrawIndexed(commandBuffer.GetVkCommandBuffer(), subMeshes[i]->GetIndexCount(), 1, 0, 0, 0);
+				// Push constants stay set between draws, they only need pushing again when the material changes
+				const bool bMaterialChanged = previousDraw == nullptr || previousDraw->materialIndex != draw.materialIndex || !(previousDraw->material == draw.material);
+				previousDraw = &draw;
+				if (bMaterialChanged && bindlessTable != nullptr)
+				{
+					vkCmdPushConstants(commandBuffer.GetVkCommandBuffer(), forwardPipeline->GetVkGraphicsPipelineLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &draw.materialIndex);
+				}
+				else if (bMaterialChanged)
+				{
+					FragmentPushConstants fragConstants(draw.material);
+					vkCmdPushConstants(commandBuffer.GetVkCommandBuffer(), forwardPipeline->GetVkGraphicsPipelineLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(FragmentPushConstants), &fragConstants);
+				}
+
+				vkCmdDrawIndexed(commandBuffer.GetVkCommandBuffer(), draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset, draw.firstInstance);
 			}
+		}
 
-			vkCmdEndRenderPass(commandBuffer.GetVkCommandBuffer());
+		void TestRenderer::RecordIndirectDraws(CommandBuffer& commandBuffer)
+		{
+			vkCmdBindPipeline(commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, indirectPipeline->GetVkGraphicsPipeline());
 
-			commandBuffer.EndRecording();
+			VkViewport viewport{};
+			viewport.x = 0.0f;
+			viewport.y = 0.0f;
+			viewport.width = static_cast<float>(GetRenderExtent().width);
+			viewport.height = static_cast<float>(GetRenderExtent().height);
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+			vkCmdSetViewport(commandBuffer.GetVkCommandBuffer(), 0, 1, &viewport);
+
+			VkRect2D scissor{};
+			scissor.offset = { 0, 0 };
+			scissor.extent = GetRenderExtent();
+			vkCmdSetScissor(commandBuffer.GetVkCommandBuffer(), 0, 1, &scissor);
+
+			vkCmdBindDescriptorSets(commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, indirectPipeline->GetVkGraphicsPipelineLayout(), 0, 1, &descriptorSets[GetFrameIndex()]->GetVkDescriptorSet(), static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+
+			// Model matrices and materials come from the object buffer, nothing is pushed per draw
+			indirectDrawPass->RecordDraws(commandBuffer, GetFrameIndex(), GetMeshHandler().GetGeometryPool());
 		}
 
 		void TestRenderer::PreRender()
 		{
-			std::vector<std::shared_ptr<MeshInstance>>& meshInstances = GetMeshHandler().GetMeshInstances();
+			std::vector<MeshInstance>& meshInstances = GetMeshHandler().GetMeshInstances();
 			for (size_t i = 0; i < meshInstances.size(); ++i)
 			{
 				if (i % 2 == 0)
 				{
 					modelRotation += 0.3f;
 
-					meshInstances[i]->model = Matrix4f::Translate(Vector3f(1.0f, 1.0f, 1.0f) * static_cast<float>(i)) * Matrix4f::Rotate(modelRotation * static_cast<float>(i), Vector3f(0.0f, 1.0f, 0.0f)) * Matrix4f::Scale(Vector3f(2.0f));
+					meshInstances[i].model = Matrix4f::Translate(Vector3f(1.0f, 1.0f, 1.0f) * static_cast<float>(i)) * Matrix4f::Rotate(modelRotation * static_cast<float>(i), Vector3f(0.0f, 1.0f, 0.0f)) * Matrix4f::Scale(Vector3f(2.0f));
 				}
 			}
 
@@ -162,13 +262,35 @@ namespace Baal
 			GetDirectionalLight().color = Color::White;
 			GetDirectionalLight().direction = direction;
 
-			GetDirectionalLightUniformBuffer().Update(&GetDirectionalLight(), GetDirectionalLightUniformBuffer().GetSize());
-
 			GetPointLight(3).color.r -= 1;
 			GetPointLight(3).color.g -= 2;
 			GetPointLight(3).color.b -= 3;
 
-			GetPointLightsUniformBuffer().Update(&GetPointLight(3), sizeof(PointLight), 3 * sizeof(PointLight));
+			// This frame's lights go into transient memory the GPU is done with, and are bound by their offsets, see RecordDrawChunk()
+			const FrameAllocation directionalLight = GetFrameAllocator().AllocateStorage(&GetDirectionalLight(), sizeof(DirectionalLight));
+			const FrameAllocation pointLights = GetFrameAllocator().AllocateStorage(&GetPointLight(0), sizeof(PointLight) * BAAL_MAX_LIGHTS);
+			dynamicOffsets = { 3 * dynamicAlignment, directionalLight.offset, pointLights.offset };
+
+			// A frame's descriptor set is only rewritten once that frame has finished on the GPU, which it has by PreRender()
+			const uint32_t frameBit = 1u << GetFrameIndex();
+			if ((staleTextureFrames & frameBit) != 0)
+			{
+				VkDescriptorImageInfo imageInfo{};
+				imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageInfo.imageView = texture->GetImage().GetVkImageView();
+				imageInfo.sampler = textureSampler->GetVkSampler();
+
+				VkWriteDescriptorSet imageDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				imageDescWrite.dstSet = descriptorSets[GetFrameIndex()]->GetVkDescriptorSet();
+				imageDescWrite.dstBinding = 2;
+				imageDescWrite.dstArrayElement = 0;
+				imageDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				imageDescWrite.descriptorCount = 1;
+				imageDescWrite.pImageInfo = &imageInfo;
+				vkUpdateDescriptorSets(GetDevice().GetVkDevice(), 1, &imageDescWrite, 0, nullptr);
+
+				staleTextureFrames &= ~frameBit;
+			}
 		}
 
 		void TestRenderer::PostRender()
@@ -178,18 +300,25 @@ namespace Baal
 		void TestRenderer::CreatePipelines()
 		{
 			CreateForwardPipeline();
+			if (indirectDrawPass != nullptr)
+			{
+				CreateIndirectPipeline();
+			}
 		}
 
 		void TestRenderer::DestroyPipelines()
 		{
+			indirectPipeline.reset();
 			forwardPipeline.reset();
 		}
 
 		void TestRenderer::CreateForwardPipeline()
 		{
+			BindlessTable* bindlessTable = GetBindlessTable();
+
 			std::vector<ShaderInfo> shaderInfo;
 			shaderInfo.push_back(ShaderInfo(VK_SHADER_STAGE_VERTEX_BIT, BAAL_SHADERS_DIR, "Phong.vert"));
-			shaderInfo.push_back(ShaderInfo(VK_SHADER_STAGE_FRAGMENT_BIT, BAAL_SHADERS_DIR, "Phong.frag"));
+			shaderInfo.push_back(ShaderInfo(VK_SHADER_STAGE_FRAGMENT_BIT, BAAL_SHADERS_DIR, bindlessTable != nullptr ? "PhongBindless.frag" : "Phong.frag"));
 			
 			VkPipelineRasterizationStateCreateInfo rasterizer = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
 			rasterizer.depthClampEnable = VK_FALSE;
@@ -203,29 +332,88 @@ namespace Baal
 			rasterizer.depthBiasClamp = 0.0f;
 			rasterizer.depthBiasSlopeFactor = 0.0f;
 
-			VkPushConstantRange vertPushConstant = {};
-			vertPushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-			vertPushConstant.offset = 0;
-			vertPushConstant.size = sizeof(VertexPushConstants);
-
+			// Model matrices are instance rate vertex attributes, only the material, or its bindless index, is pushed per draw
 			VkPushConstantRange fragPushConstant = {};
 			fragPushConstant.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-			fragPushConstant.offset = sizeof(VertexPushConstants);
-			fragPushConstant.size = sizeof(FragmentPushConstants);
+			fragPushConstant.offset = 0;
+			fragPushConstant.size = bindlessTable != nullptr ? sizeof(uint32_t) : sizeof(FragmentPushConstants);
 
 			std::vector<VkPushConstantRange> pushConstants;
-			pushConstants.push_back(vertPushConstant);
 			pushConstants.push_back(fragPushConstant);
 
-			forwardPipeline = std::make_unique<GraphicsPipeline>(GetDevice(), shaderInfo, GetRenderPass(), *descriptorSetLayout.get(), rasterizer, pushConstants, GetSwapChain().GetExtent().width, GetSwapChain().GetExtent().height);
+			std::vector<DescriptorSetLayout*> additionalSetLayouts;
+			if (bindlessTable != nullptr)
+			{
+				additionalSetLayouts.push_back(&bindlessTable->GetDescriptorSetLayout());
+			}
+
+			forwardPipeline = std::make_unique<GraphicsPipeline>(GetDevice(), shaderInfo, GetRenderPass(), *descriptorSetLayout.get(), rasterizer, pushConstants, GetRenderExtent().width, GetRenderExtent().height, true, additionalSetLayouts);
+		}
+
+		void TestRenderer::CreateIndirectPipeline()
+		{
+			std::vector<ShaderInfo> shaderInfo;
+			shaderInfo.push_back(ShaderInfo(VK_SHADER_STAGE_VERTEX_BIT, BAAL_SHADERS_DIR, "PhongIndirect.vert"));
+			shaderInfo.push_back(ShaderInfo(VK_SHADER_STAGE_FRAGMENT_BIT, BAAL_SHADERS_DIR, "PhongIndirect.frag"));
+
+			VkPipelineRasterizationStateCreateInfo rasterizer = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
+			rasterizer.depthClampEnable = VK_FALSE;
+			rasterizer.rasterizerDiscardEnable = VK_FALSE;
+			rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+			rasterizer.lineWidth = 1.0f;
+			rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+			rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+			rasterizer.depthBiasEnable = VK_FALSE;
+			rasterizer.depthBiasConstantFactor = 0.0f;
+			rasterizer.depthBiasClamp = 0.0f;
+			rasterizer.depthBiasSlopeFactor = 0.0f;
+
+			std::vector<VkPushConstantRange> pushConstants;	// Per draw data lives in the object buffer
+
+			indirectPipeline = std::make_unique<GraphicsPipeline>(GetDevice(), shaderInfo, GetRenderPass(), *descriptorSetLayout.get(), rasterizer, pushConstants, GetRenderExtent().width, GetRenderExtent().height);
+		}
+
+		void TestRenderer::CreateIndirectDrawPass()
+		{
+			if (!GetSettings().bGPUDrivenRendering)
+			{
+				return;
+			}
+
+			if (!IndirectDrawPass::IsSupported(GetDevice()))
+			{
+				DEBUG_LOG(LOG::WARNING, "GPU driven rendering is not supported by this GPU, drawing from the CPU instead");
+				return;
+			}
+
+			std::vector<Buffer*> cameraBuffers;
+			for (uint32_t frameIndex = 0; frameIndex < GetFramesInFlight(); ++frameIndex)
+			{
+				cameraBuffers.push_back(&GetCameraUniformBuffer(frameIndex));
+			}
+
+			indirectDrawPass = std::make_unique<IndirectDrawPass>(GetDevice(), cameraBuffers);
+		}
+
+		void TestRenderer::CreateInstancedDrawBuilder()
+		{
+			if (indirectDrawPass != nullptr)
+			{
+				return;
+			}
+
+			instancedDrawBuilder = std::make_unique<InstancedDrawBuilder>(GetDevice(), GetFramesInFlight());
 		}
 
 		void TestRenderer::CreateDescriptorPool()
 		{
+			const uint32_t setCount = GetFramesInFlight();
+
 			std::vector<DescriptorPoolSize> poolSizes;
-			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1));
-			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1));
-			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3));
+			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 * setCount));
+			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 * setCount));
+			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * setCount));
+			poolSizes.push_back(DescriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 2 * setCount));
 
 			descriptorPool = std::make_unique<DescriptorPool>(GetDevice(), poolSizes);
 		}
@@ -236,104 +424,130 @@ namespace Baal
 			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT, 0, 1));	// Camera
 			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT, 1, 1));	// Test Lights
 			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 2, 1));	// Texture Sampler
-			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, 3, 1));	// Directional Light 
-			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, 4, 1));	// Point Light
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_FRAGMENT_BIT, 3, 1));	// Directional Light, in the FrameAllocator
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_FRAGMENT_BIT, 4, 1));	// Point Light, in the FrameAllocator
+			bindings.push_back(DescriptorSetBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 5, 1));	// Indirect Draw Objects
 			
 			descriptorSetLayout = std::make_unique<DescriptorSetLayout>(GetDevice(), bindings);
 		}
 
-		void TestRenderer::CreateDescriptorSet()
+		void TestRenderer::CreateDescriptorSets()
 		{
-			descriptorSet = std::make_unique<DescriptorSet>(GetDevice(), *descriptorPool.get(), *descriptorSetLayout.get());
-
-			VkDescriptorBufferInfo camInfo{};
-			camInfo.buffer = GetCameraUniformBuffer().GetVkBuffer();
-			camInfo.offset = 0;
-			camInfo.range = GetCameraUniformBuffer().GetSize();
-
-			VkWriteDescriptorSet camDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			camDescWrite.dstSet = descriptorSet->GetVkDescriptorSet();
-			camDescWrite.dstBinding = 0;
-			camDescWrite.dstArrayElement = 0;
-			camDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-			camDescWrite.descriptorCount = 1;
-			camDescWrite.pBufferInfo = &camInfo;
-			camDescWrite.pImageInfo = nullptr; // Optional
-			camDescWrite.pTexelBufferView = nullptr; // Optional
-
-			VkDescriptorBufferInfo lightInfo{};
-			lightInfo.buffer = lightsUBO->GetVkBuffer();
-			lightInfo.offset = 0;
-			lightInfo.range = dynamicAlignment;
-
-			VkWriteDescriptorSet lightDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			lightDescWrite.dstSet = descriptorSet->GetVkDescriptorSet();
-			lightDescWrite.dstBinding = 1;
-			lightDescWrite.dstArrayElement = 0;
-			lightDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-			lightDescWrite.descriptorCount = 1;
-			lightDescWrite.pBufferInfo = &lightInfo;
-			lightDescWrite.pImageInfo = nullptr; // Optional
-			lightDescWrite.pTexelBufferView = nullptr; // Optional
-
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = texture->GetImage().GetVkImageView();
-			imageInfo.sampler = textureSampler->GetVkSampler();
-
-			VkWriteDescriptorSet imageDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			imageDescWrite.dstSet = descriptorSet->GetVkDescriptorSet();
-			imageDescWrite.dstBinding = 2;
-			imageDescWrite.dstArrayElement = 0;
-			imageDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			imageDescWrite.descriptorCount = 1;
-			imageDescWrite.pBufferInfo = nullptr;
-			imageDescWrite.pImageInfo = &imageInfo; // Optional
-			imageDescWrite.pTexelBufferView = nullptr; // Optional
-
-			VkDescriptorBufferInfo dlightInfo{};
-			dlightInfo.buffer = GetDirectionalLightUniformBuffer().GetVkBuffer();
-			dlightInfo.offset = 0;
-			dlightInfo.range = GetDirectionalLightUniformBuffer().GetSize();
-
-			VkWriteDescriptorSet dlightDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			dlightDescWrite.dstSet = descriptorSet->GetVkDescriptorSet();
-			dlightDescWrite.dstBinding = 3;
-			dlightDescWrite.dstArrayElement = 0;
-			dlightDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-			dlightDescWrite.descriptorCount = 1;
-			dlightDescWrite.pBufferInfo = &dlightInfo;
-			dlightDescWrite.pImageInfo = nullptr; // Optional
-			dlightDescWrite.pTexelBufferView = nullptr; // Optional
-
-			VkDescriptorBufferInfo plightInfo{};
-			plightInfo.buffer = GetPointLightsUniformBuffer().GetVkBuffer();
-			plightInfo.offset = 0;
-			plightInfo.range = GetPointLightsUniformBuffer().GetSize();
-
-			VkWriteDescriptorSet plightDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			plightDescWrite.dstSet = descriptorSet->GetVkDescriptorSet();
-			plightDescWrite.dstBinding = 4;
-			plightDescWrite.dstArrayElement = 0;
-			plightDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-			plightDescWrite.descriptorCount = 1;
-			plightDescWrite.pBufferInfo = &plightInfo;
-			plightDescWrite.pImageInfo = nullptr; // Optional
-			plightDescWrite.pTexelBufferView = nullptr; // Optional
-
-			std::vector<VkWriteDescriptorSet> descriptorWrites;
-			descriptorWrites.push_back(camDescWrite);
-			descriptorWrites.push_back(lightDescWrite);
-			descriptorWrites.push_back(imageDescWrite);
-			descriptorWrites.push_back(dlightDescWrite);
-			descriptorWrites.push_back(plightDescWrite);
-
-			vkUpdateDescriptorSets(GetDevice().GetVkDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+			for (uint32_t frameIndex = 0; frameIndex < GetFramesInFlight(); ++frameIndex)
+			{
+				descriptorSets.push_back(std::make_unique<DescriptorSet>(GetDevice(), *descriptorPool.get(), *descriptorSetLayout.get()));
+				DescriptorSet& descriptorSet = *descriptorSets[frameIndex].get();
+
+				VkDescriptorBufferInfo camInfo{};
+				camInfo.buffer = GetCameraUniformBuffer(frameIndex).GetVkBuffer();
+				camInfo.offset = 0;
+				camInfo.range = GetCameraUniformBuffer(frameIndex).GetSize();
+
+				VkWriteDescriptorSet camDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				camDescWrite.dstSet = descriptorSet.GetVkDescriptorSet();
+				camDescWrite.dstBinding = 0;
+				camDescWrite.dstArrayElement = 0;
+				camDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				camDescWrite.descriptorCount = 1;
+				camDescWrite.pBufferInfo = &camInfo;
+				camDescWrite.pImageInfo = nullptr; // Optional
+				camDescWrite.pTexelBufferView = nullptr; // Optional
+
+				VkDescriptorBufferInfo lightInfo{};
+				lightInfo.buffer = lightsUBO->GetVkBuffer();
+				lightInfo.offset = 0;
+				lightInfo.range = dynamicAlignment;
+
+				VkWriteDescriptorSet lightDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				lightDescWrite.dstSet = descriptorSet.GetVkDescriptorSet();
+				lightDescWrite.dstBinding = 1;
+				lightDescWrite.dstArrayElement = 0;
+				lightDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+				lightDescWrite.descriptorCount = 1;
+				lightDescWrite.pBufferInfo = &lightInfo;
+				lightDescWrite.pImageInfo = nullptr; // Optional
+				lightDescWrite.pTexelBufferView = nullptr; // Optional
+
+				VkDescriptorImageInfo imageInfo{};
+				imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageInfo.imageView = texture->GetImage().GetVkImageView();
+				imageInfo.sampler = textureSampler->GetVkSampler();
+
+				VkWriteDescriptorSet imageDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				imageDescWrite.dstSet = descriptorSet.GetVkDescriptorSet();
+				imageDescWrite.dstBinding = 2;
+				imageDescWrite.dstArrayElement = 0;
+				imageDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				imageDescWrite.descriptorCount = 1;
+				imageDescWrite.pBufferInfo = nullptr;
+				imageDescWrite.pImageInfo = &imageInfo; // Optional
+				imageDescWrite.pTexelBufferView = nullptr; // Optional
+
+				// The lights are rewritten every frame, the dynamic offsets pick out this frame's copy
+				VkDescriptorBufferInfo dlightInfo{};
+				dlightInfo.buffer = GetFrameAllocator().GetBuffer().GetVkBuffer();
+				dlightInfo.offset = 0;
+				dlightInfo.range = sizeof(DirectionalLight);
+
+				VkWriteDescriptorSet dlightDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				dlightDescWrite.dstSet = descriptorSet.GetVkDescriptorSet();
+				dlightDescWrite.dstBinding = 3;
+				dlightDescWrite.dstArrayElement = 0;
+				dlightDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+				dlightDescWrite.descriptorCount = 1;
+				dlightDescWrite.pBufferInfo = &dlightInfo;
+				dlightDescWrite.pImageInfo = nullptr; // Optional
+				dlightDescWrite.pTexelBufferView = nullptr; // Optional
+
+				VkDescriptorBufferInfo plightInfo{};
+				plightInfo.buffer = GetFrameAllocator().GetBuffer().GetVkBuffer();
+				plightInfo.offset = 0;
+				plightInfo.range = sizeof(PointLight) * BAAL_MAX_LIGHTS;
+
+				VkWriteDescriptorSet plightDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				plightDescWrite.dstSet = descriptorSet.GetVkDescriptorSet();
+				plightDescWrite.dstBinding = 4;
+				plightDescWrite.dstArrayElement = 0;
+				plightDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+				plightDescWrite.descriptorCount = 1;
+				plightDescWrite.pBufferInfo = &plightInfo;
+				plightDescWrite.pImageInfo = nullptr; // Optional
+				plightDescWrite.pTexelBufferView = nullptr; // Optional
+
+				std::vector<VkWriteDescriptorSet> descriptorWrites;
+				descriptorWrites.push_back(camDescWrite);
+				descriptorWrites.push_back(lightDescWrite);
+				descriptorWrites.push_back(imageDescWrite);
+				descriptorWrites.push_back(dlightDescWrite);
+				descriptorWrites.push_back(plightDescWrite);
+
+				// Only read by the indirect pipeline
+				VkDescriptorBufferInfo objectInfo{};
+				VkWriteDescriptorSet objectDescWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				if (indirectDrawPass != nullptr)
+				{
+					objectInfo.buffer = indirectDrawPass->GetObjectBuffer(frameIndex).GetVkBuffer();
+					objectInfo.offset = 0;
+					objectInfo.range = indirectDrawPass->GetObjectBuffer(frameIndex).GetSize();
+
+					objectDescWrite.dstSet = descriptorSet.GetVkDescriptorSet();
+					objectDescWrite.dstBinding = 5;
+					objectDescWrite.dstArrayElement = 0;
+					objectDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+					objectDescWrite.descriptorCount = 1;
+					objectDescWrite.pBufferInfo = &objectInfo;
+					descriptorWrites.push_back(objectDescWrite);
+				}
+
+				vkUpdateDescriptorSets(GetDevice().GetVkDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+			}
 		}
 
 		void TestRenderer::CreateTextures()
 		{
-			texture = std::make_unique<TextureInstance>(GetDevice(), Texture(BAAL_TEXTURES_DIR, "CheckerboardPattern.png", VK_IMAGE_TYPE_2D));
+			// Sampled as a white placeholder until it is decoded, see OnTextureLoaded()
+			texture = std::make_unique<TextureInstance>(GetDevice(), GetJobSystem(), Texture(BAAL_TEXTURES_DIR, "CheckerboardPattern.png", VK_IMAGE_TYPE_2D),
+				[this](TextureInstance& loadedTexture, const bool bSuccess) { OnTextureLoaded(loadedTexture, bSuccess); });
 
 			VkSamplerCreateInfo samplerInfo = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
 			samplerInfo.magFilter = VK_FILTER_LINEAR;
@@ -350,15 +564,42 @@ namespace Baal
 			samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 			samplerInfo.mipLodBias = 0.0f;
 			samplerInfo.minLod = 0.0f;
-			samplerInfo.maxLod = 0.0f;
+			samplerInfo.maxLod = VK_LOD_CLAMP_NONE;	// A maxLod of 0 would pin every lookup to the base level of the texture's mip chain
 
 			textureSampler = std::make_unique<Sampler>(GetDevice(), GetInstance().GetGPU(), samplerInfo);
+
+			if (BindlessTable* bindlessTable = GetBindlessTable())
+			{
+				bindlessTable->AddTexture(*texture.get(), *textureSampler.get());
+			}
 		}
 
 		void TestRenderer::DestroyTextures()
 		{
+			if (BindlessTable* bindlessTable = GetBindlessTable())
+			{
+				bindlessTable->RemoveTexture(*texture.get());
+			}
 			textureSampler.reset();
 			texture.reset();
+			staleTextureFrames = 0;
+		}
+
+		void TestRenderer::OnTextureLoaded(TextureInstance& loadedTexture, const bool bSuccess)
+		{
+			if (!bSuccess)
+			{
+				return;
+			}
+
+			if (BindlessTable* bindlessTable = GetBindlessTable())
+			{
+				bindlessTable->UpdateTexture(loadedTexture, *textureSampler.get());
+			}
+			else
+			{
+				staleTextureFrames = (1u << GetFramesInFlight()) - 1;
+			}
 		}
 
 		void TestRenderer::CreateTestLights()
@@ -378,6 +619,7 @@ namespace Baal
 			lights[2].color = Color::White;
 			lights[3].color = Color::Yellow;
 			lights[4].color = Color::Red;
+			lights[0].color = Color::Cyan;
 
 			size_t minUniformBufferOffsetAlignment = static_cast<size_t>(GetInstance().GetGPU().GetProperties().limits.minUniformBufferOffsetAlignment);
 			dynamicAlignment = sizeof(PointLight);
@@ -386,20 +628,16 @@ namespace Baal
 				dynamicAlignment = (dynamicAlignment + minUniformBufferOffsetAlignment - 1) & ~(minUniformBufferOffsetAlignment - 1);
 			}
 
+			// Lay the lights out at the dynamic offset stride before staging them, so they go up in a single copy
 			const VkDeviceSize bufferSize = dynamicAlignment * lights.size();
-			Buffer stagingBuffer = Buffer::CreateStagingBuffer(GetAllocator(), bufferSize, lights.data());
-			
-
-			lightsUBO = std::make_unique<Buffer>(GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bufferSize);
-			GetDevice().CopyBuffer(stagingBuffer, *lightsUBO.get(), bufferSize);
-
-
-			lights[0].color = Color::Cyan;
-
-			for (size_t i = 0; i < lights.size(); i++) 
+			std::vector<uint8_t> alignedLights(bufferSize);
+			for (size_t i = 0; i < lights.size(); i++)
 			{
-				lightsUBO->Update(&lights[i], dynamicAlignment, (i * dynamicAlignment));
+				std::memcpy(alignedLights.data() + (i * dynamicAlignment), &lights[i], sizeof(PointLight));
 			}
+
+			lightsUBO = std::make_unique<Buffer>(GetAllocator(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bufferSize);
+			GetDevice().GetUploader().UploadBuffer(*lightsUBO.get(), alignedLights.data(), bufferSize);
 		}
 
 		void TestRenderer::DestroyTestLights()
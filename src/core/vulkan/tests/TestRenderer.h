@@ -13,6 +13,8 @@ namespace Baal
 		class Image;
 		class CommandBuffer;
 		class GraphicsPipeline;
+		class IndirectDrawPass;
+		class InstancedDrawBuilder;
 		class RenderPass;
 		class Framebuffer;
 		class DescriptorPool;
@@ -20,7 +22,6 @@ namespace Baal
 		class DescriptorSet;
 		class TextureInstance;
 		class Sampler;
-		class MeshInstance;
 		class PointLight;
 
 		class TestRenderer : public Renderer
@@ -44,34 +45,47 @@ namespace Baal
 			virtual void PreRender() override final;
 			virtual void PostRender() override final;
 
+			void RecordDrawChunk(CommandBuffer& commandBuffer, const uint32_t begin, const uint32_t end);
+			void RecordIndirectDraws(CommandBuffer& commandBuffer);
+
 			std::unique_ptr<GraphicsPipeline> forwardPipeline;
+			std::unique_ptr<GraphicsPipeline> indirectPipeline;
+			std::unique_ptr<IndirectDrawPass> indirectDrawPass;	// nullptr when drawing from the CPU
+			std::unique_ptr<InstancedDrawBuilder> instancedDrawBuilder;	// Only when drawing from the CPU
 
 			float modelRotation = 0.0f;
 			float lightRotation = 0.0f;
 
 			std::unique_ptr<DescriptorPool> descriptorPool;
 			std::unique_ptr<DescriptorSetLayout> descriptorSetLayout;
-			std::unique_ptr<DescriptorSet> descriptorSet;
+			std::vector<std::unique_ptr<DescriptorSet>> descriptorSets;	// One per frame in flight
 
 			std::unique_ptr<TextureInstance> texture;
 			std::unique_ptr<Sampler> textureSampler;
+			uint32_t staleTextureFrames = 0;	// One bit per frame in flight whose descriptor set still points at the placeholder texture
 
-			std::weak_ptr<MeshInstance> destroyTarget;
+			MeshInstanceHandle destroyTarget;
 
 			uint32_t dynamicAlignment = 0;
+			std::array<uint32_t, 3> dynamicOffsets = {};	// Bindings 1, 3 and 4, in binding order as Vulkan expects
 			std::unique_ptr<Buffer> lightsUBO;
 			std::vector<PointLight> lights;
 
 			void CreatePipelines();
 			void DestroyPipelines();
 			void CreateForwardPipeline();
+			void CreateIndirectPipeline();
+
+			void CreateIndirectDrawPass();
+			void CreateInstancedDrawBuilder();
 
 			void CreateDescriptorPool();
 			void CreateDescriptorSetLayout();
-			void CreateDescriptorSet();
+			void CreateDescriptorSets();
 
 			void CreateTextures();
 			void DestroyTextures();
+			void OnTextureLoaded(TextureInstance& loadedTexture, const bool bSuccess);
 
 			void CreateTestLights();
 			void DestroyTestLights();
@@ -108,5 +108,11 @@ namespace Baal
 			glslang::FinalizeProcess();
 			return true;
 		}
+
+		std::string GLSLCompiler::GetVersion()
+		{
+			const glslang::Version version = glslang::GetVersion();
+			return "glslang " + std::to_string(version.major) + "." + std::to_string(version.minor) + "." + std::to_string(version.patch) + version.flavor;
+		}
 	}
 }
\ No newline at end of file
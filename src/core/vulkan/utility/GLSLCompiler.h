@@ -29,6 +29,9 @@ namespace Baal
 				const std::string& entryPoint,
 				std::vector<std::uint32_t>& spirv,
 				std::string& outLog);
+
+			// Identifies the glslang build, SPIR-V compiled by a different version is not reused from the shader cache
+			static std::string GetVersion();
 		};
 
 	}
@@ -0,0 +1,154 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "ShaderCache.h"
+
+#include "../src/core/vulkan/utility/GLSLCompiler.h"
+#include "../src/utility/DebugLog.h"
+#include "../src/utility/Hash.h"
+
+#include <filesystem>
+#include <fstream>
+#include <format>
+
+namespace Baal
+{
+	namespace VK
+	{
+		namespace
+		{
+			constexpr uint32_t SHADER_CACHE_MAGIC = 0x56505342;	// "BSPV"
+			constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+			struct ShaderCacheHeader
+			{
+				uint32_t magic;
+				uint32_t cacheVersion;
+				uint64_t sourceHash;
+				uint32_t stage;
+				uint32_t entryPointLength;
+				uint32_t compilerVersionLength;
+				uint32_t spirvWordCount;
+			};
+
+			template<typename T>
+			bool ReadValue(std::ifstream& file, T& outValue)
+			{
+				return static_cast<bool>(file.read(reinterpret_cast<char*>(&outValue), sizeof(T)));
+			}
+
+			bool ReadString(std::ifstream& file, const uint32_t length, std::string& outString)
+			{
+				outString.resize(length);
+				return static_cast<bool>(file.read(outString.data(), length));
+			}
+		}
+
+		ShaderCacheKey ShaderCacheKey::Create(VkShaderStageFlagBits stage, const std::vector<char>& sourceCode, const std::string& entryPoint)
+		{
+			ShaderCacheKey key;
+			key.sourceHash = HashFNV1a(sourceCode.data(), sourceCode.size());
+			key.stage = stage;
+			key.entryPoint = entryPoint;
+			key.compilerVersion = GLSLCompiler::GetVersion();
+			return key;
+		}
+
+		std::string ShaderCacheKey::GetFileName() const
+		{
+			const uint32_t cacheVersion = BAAL_SHADER_CACHE_VERSION;
+			uint64_t hash = HashFNV1a(&sourceHash, sizeof(sourceHash));
+			hash = HashFNV1a(&stage, sizeof(stage), hash);
+			hash = HashFNV1a(entryPoint, hash);
+			hash = HashFNV1a(compilerVersion, hash);
+			hash = HashFNV1a(&cacheVersion, sizeof(cacheVersion), hash);
+			return std::format("{:016x}.spv", hash);
+		}
+
+		ShaderCache::ShaderCache(const std::string& _cacheDirectory):
+			cacheDirectory(_cacheDirectory)
+		{
+		}
+
+		bool ShaderCache::TryLoad(const ShaderCacheKey& key, std::vector<uint32_t>& outSpirv) const
+		{
+			const std::filesystem::path filePath = std::filesystem::path(cacheDirectory) / key.GetFileName();
+
+			std::ifstream file(filePath, std::ios::binary);
+			if (!file.is_open())
+			{
+				return false;
+			}
+
+			ShaderCacheHeader header{};
+			std::string entryPoint;
+			std::string compilerVersion;
+			if (!ReadValue(file, header) ||
+				header.magic != SHADER_CACHE_MAGIC ||
+				header.cacheVersion != BAAL_SHADER_CACHE_VERSION ||
+				!ReadString(file, header.entryPointLength, entryPoint) ||
+				!ReadString(file, header.compilerVersionLength, compilerVersion))
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring invalid shader cache file: {}", filePath.string());
+				return false;
+			}
+
+			if (header.sourceHash != key.sourceHash || header.stage != static_cast<uint32_t>(key.stage) || entryPoint != key.entryPoint || compilerVersion != key.compilerVersion)
+			{
+				return false;	// Collision on the file name, the file belongs to a different shader
+			}
+
+			std::vector<uint32_t> spirv(header.spirvWordCount);
+			if (!file.read(reinterpret_cast<char*>(spirv.data()), spirv.size() * sizeof(uint32_t)) || spirv.empty() || spirv[0] != SPIRV_MAGIC)
+			{
+				DEBUG_LOG(LOG::WARNING, "Ignoring truncated shader cache file: {}", filePath.string());
+				return false;
+			}
+
+			outSpirv = std::move(spirv);
+			return true;
+		}
+
+		bool ShaderCache::Store(const ShaderCacheKey& key, const std::vector<uint32_t>& spirv) const
+		{
+			std::error_code error;
+			std::filesystem::create_directories(cacheDirectory, error);
+
+			const std::filesystem::path filePath = std::filesystem::path(cacheDirectory) / key.GetFileName();
+
+			// Written to a temporary file first, so a concurrent reader never sees a partially written cache entry
+			std::filesystem::path tempPath = filePath;
+			tempPath += ".tmp";
+
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+				{
+					DEBUG_LOG(LOG::WARNING, "Failed to write shader cache file: {}", filePath.string());
+					return false;
+				}
+
+				ShaderCacheHeader header{};
+				header.magic = SHADER_CACHE_MAGIC;
+				header.cacheVersion = BAAL_SHADER_CACHE_VERSION;
+				header.sourceHash = key.sourceHash;
+				header.stage = static_cast<uint32_t>(key.stage);
+				header.entryPointLength = static_cast<uint32_t>(key.entryPoint.size());
+				header.compilerVersionLength = static_cast<uint32_t>(key.compilerVersion.size());
+				header.spirvWordCount = static_cast<uint32_t>(spirv.size());
+
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(key.entryPoint.data(), key.entryPoint.size());
+				file.write(key.compilerVersion.data(), key.compilerVersion.size());
+				file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+			}
+
+			std::filesystem::rename(tempPath, filePath, error);
+			if (error)
+			{
+				DEBUG_LOG(LOG::WARNING, "Failed to write shader cache file: {}, Error: {}", filePath.string(), error.message());
+				return false;
+			}
+			return true;
+		}
+	}
+}
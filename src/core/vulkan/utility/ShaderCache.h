@@ -0,0 +1,63 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_SHADER_CACHE_H
+#define BAAL_SHADER_CACHE_H
+
+#include <vulkan/vulkan_core.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Where compiled SPIR-V is cached, the build points this at the build directory
+#ifndef BAAL_SHADER_CACHE_DIR
+#define BAAL_SHADER_CACHE_DIR "cache/shaders/"
+#endif // !BAAL_SHADER_CACHE_DIR
+
+// Bump whenever the compile options in GLSLCompiler change, invalidates every cached SPIR-V file
+#ifndef BAAL_SHADER_CACHE_VERSION
+#define BAAL_SHADER_CACHE_VERSION 1
+#endif // !BAAL_SHADER_CACHE_VERSION
+
+namespace Baal
+{
+	namespace VK
+	{
+		struct ShaderCacheKey
+		{
+			uint64_t sourceHash = 0;
+			VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+			std::string entryPoint;
+			std::string compilerVersion;
+
+			static ShaderCacheKey Create(VkShaderStageFlagBits stage, const std::vector<char>& sourceCode, const std::string& entryPoint);
+
+			// Content addressed, every field of the key goes into the file name
+			std::string GetFileName() const;
+		};
+
+		// Content addressed on-disk cache of compiled SPIR-V
+		// Files store their full key, so a hash collision or a stale file is treated as a miss and recompiled
+		class ShaderCache
+		{
+		public:
+			explicit ShaderCache(const std::string& _cacheDirectory);
+			ShaderCache(const ShaderCache&) = delete;
+			ShaderCache(ShaderCache&&) = delete;
+
+			~ShaderCache() = default;
+
+			ShaderCache& operator=(const ShaderCache&) = delete;
+			ShaderCache& operator = (ShaderCache&&) = delete;
+
+			bool TryLoad(const ShaderCacheKey& key, std::vector<uint32_t>& outSpirv) const;
+			bool Store(const ShaderCacheKey& key, const std::vector<uint32_t>& spirv) const;
+
+			const std::string& GetCacheDirectory() const { return cacheDirectory; }
+
+		private:
+			std::string cacheDirectory;
+		};
+	}
+}
+
+#endif // !BAAL_SHADER_CACHE_H
@@ -3,12 +3,44 @@
 #include "../src/utility/DebugLog.h"
 #include <GLFW/glfw3.h>
 
+#include <cstdlib>
+#include <cstring>
+
 using namespace Baal;
 
-int main()
+// Renders a fixed number of frames without a window or swap chain, e.g. on CI machines running a software driver such as lavapipe
+int RunHeadless(const uint32_t frameCount)
+{
+	VK::RendererSettings settings;
+	settings.bEnableReadback = true;
+
+	VK::TestRenderer renderer;
+
+	renderer.Startup("Test Flight", settings);
+
+	for (uint32_t i = 0; i < frameCount; ++i)
+	{
+		renderer.Render();
+	}
+
+	std::vector<uint8_t> pixels;
+	const bool bReadbackSuccess = renderer.ReadbackFrame(pixels);
+
+	renderer.Shutdown();
+
+	return bReadbackSuccess ? 0 : 1;
+}
+
+int main(int argc, char** argv)
 {
 	DEBUG_INIT();
 
+	if (argc > 1 && std::strcmp(argv[1], "--headless") == 0)
+	{
+		const uint32_t frameCount = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 500;
+		return RunHeadless(frameCount);
+	}
+
 	GLFWwindow* window;
 	
 	glfwInit();
@@ -48,4 +80,4 @@ int main()
 	glfwTerminate();
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -35,7 +35,7 @@ struct Material
 };
 
 layout(push_constant) uniform constants {
-    layout(offset = 64) Material material;
+    Material material;
 } fragConsts;
 
 layout(location = 0) in vec3 fragColor;
@@ -0,0 +1,65 @@
+#version 450
+
+layout(binding = 0) buffer CameraMatrix {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec4 pos;
+} camera;
+
+struct Material
+{
+	vec4 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	float shininess;
+};
+
+struct ObjectData
+{
+    mat4 model;
+    Material material;
+    vec4 boundingSphere;
+    uint firstIndex;
+    uint indexCount;
+    int vertexOffset;
+    uint bucket;
+};
+
+// Written by IndirectDrawPass, each draw's first instance is its object index
+layout(binding = 5) readonly buffer Objects {
+    ObjectData objects[];
+};
+
+struct TestLight
+{
+	vec4 pos;
+	vec4 color;
+};
+
+layout(binding = 1) uniform TestLights {
+    TestLight lights;
+};
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inNorm;
+layout(location = 2) in vec2 inTexCoords;
+layout(location = 3) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragPos;
+layout(location = 3) out vec3 outNorm;
+layout(location = 4) out vec3 eyePos;
+layout(location = 5) flat out uint objectIndex;
+
+void main() {
+    mat4 model = objects[gl_InstanceIndex].model;
+    gl_Position = camera.proj * camera.view * model * vec4(inPos, 1.0);
+    fragColor = inColor;
+    fragTexCoord = inTexCoords;
+    fragPos = vec3(model * vec4(inPos, 1.0));
+    outNorm = mat3(transpose(inverse(model))) * inNorm;  // In order to apply any tranformation applied to the model, to its normals as well
+    eyePos = vec3(camera.pos);
+    objectIndex = gl_InstanceIndex;
+}
\ No newline at end of file
@@ -0,0 +1,542 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Baal
+{
+	namespace
+	{
+		constexpr uint32_t TEXELS_PER_BLOCK = 16;
+
+		// Interpolation weights of BC7's 4 bit indices, out of 64
+		constexpr uint32_t BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		// Writes bit fields least significant bit first, the order every BC format packs its fields in
+		class BitWriter
+		{
+		public:
+			explicit BitWriter(uint8_t* _output, const uint32_t byteCount):
+				output(_output)
+			{
+				std::memset(output, 0, byteCount);
+			}
+
+			void Write(const uint32_t value, const uint32_t bitCount)
+			{
+				for (uint32_t i = 0; i < bitCount; ++i, ++bitOffset)
+				{
+					if ((value >> i) & 1)
+					{
+						output[bitOffset / 8] |= static_cast<uint8_t>(1 << (bitOffset % 8));
+					}
+				}
+			}
+
+		private:
+			uint8_t* output;
+			uint32_t bitOffset = 0;
+		};
+
+		// Mean and principal axis of the first channelCount channels, found with a few rounds of power iteration on the covariance matrix
+		void FitPrincipalAxis(const float (*texels)[4], const uint32_t channelCount, float mean[4], float axis[4])
+		{
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				mean[c] = 0.0f;
+				axis[c] = c < channelCount ? 1.0f : 0.0f;
+			}
+
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				for (uint32_t c = 0; c < channelCount; ++c)
+				{
+					mean[c] += texels[i][c] / TEXELS_PER_BLOCK;
+				}
+			}
+
+			float covariance[4][4] = {};
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				for (uint32_t a = 0; a < channelCount; ++a)
+				{
+					for (uint32_t b = 0; b < channelCount; ++b)
+					{
+						covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+					}
+				}
+			}
+
+			for (uint32_t iteration = 0; iteration < 8; ++iteration)
+			{
+				float next[4] = {};
+				float largest = 0.0f;
+				for (uint32_t a = 0; a < channelCount; ++a)
+				{
+					for (uint32_t b = 0; b < channelCount; ++b)
+					{
+						next[a] += covariance[a][b] * axis[b];
+					}
+					largest = std::max(largest, std::abs(next[a]));
+				}
+
+				// A flat block has no principal axis, any axis through the mean reproduces it
+				if (largest <= 0.0f)
+				{
+					break;
+				}
+
+				for (uint32_t c = 0; c < channelCount; ++c)
+				{
+					axis[c] = next[c] / largest;
+				}
+			}
+
+			float length = 0.0f;
+			for (uint32_t c = 0; c < channelCount; ++c)
+			{
+				length += axis[c] * axis[c];
+			}
+			length = std::sqrt(length);
+			for (uint32_t c = 0; c < channelCount; ++c)
+			{
+				axis[c] = length > 0.0f ? axis[c] / length : 0.0f;
+			}
+		}
+
+		// Endpoints at the extent of the texels along the principal axis
+		void FitEndpoints(const float (*texels)[4], const uint32_t channelCount, float endpoint0[4], float endpoint1[4])
+		{
+			float mean[4];
+			float axis[4];
+			FitPrincipalAxis(texels, channelCount, mean, axis);
+
+			float minProjection = 0.0f;
+			float maxProjection = 0.0f;
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				float projection = 0.0f;
+				for (uint32_t c = 0; c < channelCount; ++c)
+				{
+					projection += (texels[i][c] - mean[c]) * axis[c];
+				}
+				minProjection = std::min(minProjection, projection);
+				maxProjection = std::max(maxProjection, projection);
+			}
+
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				endpoint0[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+				endpoint1[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+			}
+		}
+
+		// Least squares endpoints for the chosen indices, weights[i] is how far texel i lies from endpoint0 towards endpoint1
+		// Returns false when every texel uses the same weight, the fit is then undetermined
+		bool RefitEndpoints(const float (*texels)[4], const float* weights, const uint32_t channelCount, float endpoint0[4], float endpoint1[4])
+		{
+			float a = 0.0f;
+			float b = 0.0f;
+			float c = 0.0f;
+			float x0[4] = {};
+			float x1[4] = {};
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				const float w = weights[i];
+				a += (1.0f - w) * (1.0f - w);
+				b += (1.0f - w) * w;
+				c += w * w;
+				for (uint32_t channel = 0; channel < channelCount; ++channel)
+				{
+					x0[channel] += (1.0f - w) * texels[i][channel];
+					x1[channel] += w * texels[i][channel];
+				}
+			}
+
+			const float determinant = a * c - b * b;
+			if (std::abs(determinant) < 1e-6f)
+			{
+				return false;
+			}
+
+			for (uint32_t channel = 0; channel < channelCount; ++channel)
+			{
+				endpoint0[channel] = std::clamp((c * x0[channel] - b * x1[channel]) / determinant, 0.0f, 255.0f);
+				endpoint1[channel] = std::clamp((a * x1[channel] - b * x0[channel]) / determinant, 0.0f, 255.0f);
+			}
+			return true;
+		}
+
+		void LoadTexels(const uint8_t* rgba, float texels[TEXELS_PER_BLOCK][4])
+		{
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					texels[i][c] = static_cast<float>(rgba[i * 4 + c]);
+				}
+			}
+		}
+
+		// BC1
+
+		uint16_t QuantizeRGB565(const float color[4])
+		{
+			const uint32_t r = static_cast<uint32_t>(std::lround(color[0] * 31.0f / 255.0f));
+			const uint32_t g = static_cast<uint32_t>(std::lround(color[1] * 63.0f / 255.0f));
+			const uint32_t b = static_cast<uint32_t>(std::lround(color[2] * 31.0f / 255.0f));
+			return static_cast<uint16_t>((std::min(r, 31u) << 11) | (std::min(g, 63u) << 5) | std::min(b, 31u));
+		}
+
+		void ExpandRGB565(const uint16_t color, int32_t out[3])
+		{
+			const int32_t r = (color >> 11) & 31;
+			const int32_t g = (color >> 5) & 63;
+			const int32_t b = color & 31;
+			out[0] = (r << 3) | (r >> 2);
+			out[1] = (g << 2) | (g >> 4);
+			out[2] = (b << 3) | (b >> 2);
+		}
+
+		// Picks the closest of the four palette colors for every texel, returns the total squared error
+		uint32_t SelectBC1Indices(const float (*texels)[4], const uint16_t color0, const uint16_t color1, uint8_t indices[TEXELS_PER_BLOCK])
+		{
+			int32_t palette[4][3];
+			ExpandRGB565(color0, palette[0]);
+			ExpandRGB565(color1, palette[1]);
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			uint32_t totalError = 0;
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				uint32_t bestError = UINT32_MAX;
+				for (uint8_t entry = 0; entry < 4; ++entry)
+				{
+					uint32_t error = 0;
+					for (uint32_t c = 0; c < 3; ++c)
+					{
+						const int32_t difference = static_cast<int32_t>(texels[i][c]) - palette[entry][c];
+						error += static_cast<uint32_t>(difference * difference);
+					}
+					if (error < bestError)
+					{
+						bestError = error;
+						indices[i] = entry;
+					}
+				}
+				totalError += bestError;
+			}
+			return totalError;
+		}
+
+		void CompressBC1(const float (*texels)[4], uint8_t* outBlock)
+		{
+			float endpoint0[4];
+			float endpoint1[4];
+			FitEndpoints(texels, 3, endpoint0, endpoint1);
+
+			// Pull the endpoints in by half a palette step, the extremes are rarely worth an exact match at the cost of every texel between them
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				const float inset = (endpoint0[c] - endpoint1[c]) / 16.0f;
+				endpoint0[c] -= inset;
+				endpoint1[c] += inset;
+			}
+
+			uint16_t color0 = QuantizeRGB565(endpoint0);
+			uint16_t color1 = QuantizeRGB565(endpoint1);
+			uint8_t indices[TEXELS_PER_BLOCK];
+			uint32_t error = SelectBC1Indices(texels, color0, color1, indices);
+
+			constexpr float BC1_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			float weights[TEXELS_PER_BLOCK];
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				weights[i] = BC1_WEIGHTS[indices[i]];
+			}
+
+			if (RefitEndpoints(texels, weights, 3, endpoint0, endpoint1))
+			{
+				const uint16_t refitColor0 = QuantizeRGB565(endpoint0);
+				const uint16_t refitColor1 = QuantizeRGB565(endpoint1);
+				uint8_t refitIndices[TEXELS_PER_BLOCK];
+				const uint32_t refitError = SelectBC1Indices(texels, refitColor0, refitColor1, refitIndices);
+				if (refitError < error)
+				{
+					color0 = refitColor0;
+					color1 = refitColor1;
+					std::memcpy(indices, refitIndices, sizeof(indices));
+					error = refitError;
+				}
+			}
+
+			// color0 > color1 selects the four color palette, swapping the endpoints swaps indices 0 and 1, and 2 and 3
+			if (color0 < color1)
+			{
+				std::swap(color0, color1);
+				for (uint8_t& index : indices)
+				{
+					index ^= 1;
+				}
+			}
+			else if (color0 == color1)
+			{
+				std::memset(indices, 0, sizeof(indices));
+			}
+
+			BitWriter writer(outBlock, 8);
+			writer.Write(color0, 16);
+			writer.Write(color1, 16);
+			for (const uint8_t index : indices)
+			{
+				writer.Write(index, 2);
+			}
+		}
+
+		// BC4, one channel. Alpha of BC3 and each channel of BC5
+
+		void CompressBC4(const float (*texels)[4], const uint32_t channel, uint8_t* outBlock)
+		{
+			uint32_t minValue = 255;
+			uint32_t maxValue = 0;
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				const uint32_t value = static_cast<uint32_t>(texels[i][channel]);
+				minValue = std::min(minValue, value);
+				maxValue = std::max(maxValue, value);
+			}
+
+			// value0 > value1 selects the eight value palette
+			int32_t palette[8];
+			palette[0] = static_cast<int32_t>(maxValue);
+			palette[1] = static_cast<int32_t>(minValue);
+			for (int32_t i = 2; i < 8; ++i)
+			{
+				palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1]) / 7;
+			}
+
+			BitWriter writer(outBlock, 8);
+			writer.Write(maxValue, 8);
+			writer.Write(minValue, 8);
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				uint32_t bestIndex = 0;
+				if (maxValue != minValue)
+				{
+					int32_t bestError = INT32_MAX;
+					for (uint32_t entry = 0; entry < 8; ++entry)
+					{
+						const int32_t error = std::abs(static_cast<int32_t>(texels[i][channel]) - palette[entry]);
+						if (error < bestError)
+						{
+							bestError = error;
+							bestIndex = entry;
+						}
+					}
+				}
+				writer.Write(bestIndex, 3);
+			}
+		}
+
+		// BC7 mode 6, a single subset with 7 bit RGBA endpoints, a p-bit per endpoint and 4 bit indices
+
+		// Finds the 7 bit endpoint and p-bit closest to the color, the p-bit is the shared lowest bit of every channel
+		void QuantizeBC7Endpoint(const float color[4], uint32_t outEndpoint[4], uint32_t& outPBit)
+		{
+			float bestError = -1.0f;
+			for (uint32_t pBit = 0; pBit < 2; ++pBit)
+			{
+				uint32_t endpoint[4];
+				float error = 0.0f;
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					const long quantized = std::lround((color[c] - static_cast<float>(pBit)) / 2.0f);
+					endpoint[c] = static_cast<uint32_t>(std::clamp(quantized, 0L, 127L));
+					const float difference = static_cast<float>((endpoint[c] << 1) | pBit) - color[c];
+					error += difference * difference;
+				}
+
+				if (bestError < 0.0f || error < bestError)
+				{
+					bestError = error;
+					outPBit = pBit;
+					std::memcpy(outEndpoint, endpoint, sizeof(endpoint));
+				}
+			}
+		}
+
+		struct BC7Mode6Block
+		{
+			uint32_t endpoints[2][4];	// 7 bits per channel
+			uint32_t pBits[2];
+			uint8_t indices[TEXELS_PER_BLOCK];
+		};
+
+		uint32_t SelectBC7Indices(const float (*texels)[4], BC7Mode6Block& block)
+		{
+			int32_t palette[16][4];
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				const int32_t value0 = static_cast<int32_t>((block.endpoints[0][c] << 1) | block.pBits[0]);
+				const int32_t value1 = static_cast<int32_t>((block.endpoints[1][c] << 1) | block.pBits[1]);
+				for (uint32_t entry = 0; entry < 16; ++entry)
+				{
+					const int32_t weight = static_cast<int32_t>(BC7_WEIGHTS[entry]);
+					palette[entry][c] = ((64 - weight) * value0 + weight * value1 + 32) >> 6;
+				}
+			}
+
+			uint32_t totalError = 0;
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				uint32_t bestError = UINT32_MAX;
+				for (uint8_t entry = 0; entry < 16; ++entry)
+				{
+					uint32_t error = 0;
+					for (uint32_t c = 0; c < 4; ++c)
+					{
+						const int32_t difference = static_cast<int32_t>(texels[i][c]) - palette[entry][c];
+						error += static_cast<uint32_t>(difference * difference);
+					}
+					if (error < bestError)
+					{
+						bestError = error;
+						block.indices[i] = entry;
+					}
+				}
+				totalError += bestError;
+			}
+			return totalError;
+		}
+
+		uint32_t EncodeBC7Mode6(const float (*texels)[4], const float endpoint0[4], const float endpoint1[4], BC7Mode6Block& block)
+		{
+			QuantizeBC7Endpoint(endpoint0, block.endpoints[0], block.pBits[0]);
+			QuantizeBC7Endpoint(endpoint1, block.endpoints[1], block.pBits[1]);
+			return SelectBC7Indices(texels, block);
+		}
+
+		void CompressBC7(const float (*texels)[4], uint8_t* outBlock)
+		{
+			float endpoint0[4];
+			float endpoint1[4];
+			FitEndpoints(texels, 4, endpoint0, endpoint1);
+
+			BC7Mode6Block block;
+			const uint32_t error = EncodeBC7Mode6(texels, endpoint0, endpoint1, block);
+
+			float weights[TEXELS_PER_BLOCK];
+			for (uint32_t i = 0; i < TEXELS_PER_BLOCK; ++i)
+			{
+				weights[i] = static_cast<float>(BC7_WEIGHTS[block.indices[i]]) / 64.0f;
+			}
+
+			if (RefitEndpoints(texels, weights, 4, endpoint0, endpoint1))
+			{
+				BC7Mode6Block refitBlock;
+				if (EncodeBC7Mode6(texels, endpoint0, endpoint1, refitBlock) < error)
+				{
+					block = refitBlock;
+				}
+			}
+
+			// The first index is stored without its top bit, which must be zero, swapping the endpoints inverts every index
+			if (block.indices[0] >= 8)
+			{
+				std::swap(block.endpoints[0], block.endpoints[1]);
+				std::swap(block.pBits[0], block.pBits[1]);
+				for (uint8_t& index : block.indices)
+				{
+					index = static_cast<uint8_t>(15 - index);
+				}
+			}
+
+			BitWriter writer(outBlock, 16);
+			writer.Write(1 << 6, 7);	// Mode 6
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				writer.Write(block.endpoints[0][c], 7);
+				writer.Write(block.endpoints[1][c], 7);
+			}
+			writer.Write(block.pBits[0], 1);
+			writer.Write(block.pBits[1], 1);
+			writer.Write(block.indices[0], 3);
+			for (uint32_t i = 1; i < TEXELS_PER_BLOCK; ++i)
+			{
+				writer.Write(block.indices[i], 4);
+			}
+		}
+	}
+
+	BlockCompressor::BlockCompressor(const BlockFormat _format):
+		format(_format)
+	{}
+
+	uint32_t BlockCompressor::GetBlockSize() const
+	{
+		return format == BlockFormat::BC1 ? 8 : 16;
+	}
+
+	size_t BlockCompressor::GetCompressedSize(const uint32_t width, const uint32_t height) const
+	{
+		const size_t blocksX = (std::max(width, 1u) + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+		const size_t blocksY = (std::max(height, 1u) + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+		return blocksX * blocksY * GetBlockSize();
+	}
+
+	void BlockCompressor::CompressBlockRows(const uint8_t* rgba, const uint32_t width, const uint32_t height, const uint32_t firstBlockRow, const uint32_t lastBlockRow, uint8_t* output) const
+	{
+		const uint32_t blocksX = (width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+		const uint32_t blockSize = GetBlockSize();
+
+		uint8_t texels[TEXELS_PER_BLOCK * 4];
+		for (uint32_t blockY = firstBlockRow; blockY < lastBlockRow; ++blockY)
+		{
+			for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+			{
+				for (uint32_t y = 0; y < BLOCK_DIMENSION; ++y)
+				{
+					const uint32_t sourceY = std::min(blockY * BLOCK_DIMENSION + y, height - 1);
+					for (uint32_t x = 0; x < BLOCK_DIMENSION; ++x)
+					{
+						const uint32_t sourceX = std::min(blockX * BLOCK_DIMENSION + x, width - 1);
+						std::memcpy(&texels[(y * BLOCK_DIMENSION + x) * 4], &rgba[(static_cast<size_t>(sourceY) * width + sourceX) * 4], 4);
+					}
+				}
+
+				CompressBlock(texels, output + (static_cast<size_t>(blockY) * blocksX + blockX) * blockSize);
+			}
+		}
+	}
+
+	void BlockCompressor::CompressBlock(const uint8_t* texels, uint8_t* outBlock) const
+	{
+		float block[TEXELS_PER_BLOCK][4];
+		LoadTexels(texels, block);
+
+		switch (format)
+		{
+		case BlockFormat::BC1:
+			CompressBC1(block, outBlock);
+			break;
+		case BlockFormat::BC3:
+			CompressBC4(block, 3, outBlock);
+			CompressBC1(block, outBlock + 8);
+			break;
+		case BlockFormat::BC5:
+			CompressBC4(block, 0, outBlock);
+			CompressBC4(block, 1, outBlock + 8);
+			break;
+		case BlockFormat::BC7:
+			CompressBC7(block, outBlock);
+			break;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_BLOCK_COMPRESSION_H
+#define BAAL_BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Baal
+{
+	// Block compressed formats the encoder can write, every one of them stores 4x4 texel blocks
+	enum class BlockFormat : uint8_t
+	{
+		BC1,	// RGB, 8 bytes per block
+		BC3,	// RGBA, BC1 color with a BC4 alpha block, 16 bytes per block
+		BC5,	// Two independent BC4 channels, e.g. the XY of a tangent space normal map, 16 bytes per block
+		BC7		// RGBA, 16 bytes per block. Written in mode 6 only, which trades a little quality on multi colored blocks for speed
+	};
+
+	// CPU encoder for offline use, see tools/TextureCompressor.cpp
+	// Endpoints are fit along the principal axis of each block and refined once with a least squares fit to the chosen indices
+	class BlockCompressor
+	{
+	public:
+		static constexpr uint32_t BLOCK_DIMENSION = 4;
+
+		explicit BlockCompressor(const BlockFormat _format);
+		BlockCompressor(const BlockCompressor&) = delete;
+		BlockCompressor(BlockCompressor&&) = delete;
+
+		~BlockCompressor() = default;
+
+		BlockCompressor& operator=(const BlockCompressor&) = delete;
+		BlockCompressor& operator = (BlockCompressor&&) = delete;
+
+		uint32_t GetBlockSize() const;	// In bytes
+		size_t GetCompressedSize(const uint32_t width, const uint32_t height) const;
+
+		// Compresses the block rows [firstBlockRow, lastBlockRow) of a tightly packed RGBA8 image into output, which holds the whole compressed image
+		// Blocks past the right or bottom edge repeat the edge texels. Rows are independent, so they can be split across threads
+		void CompressBlockRows(const uint8_t* rgba, const uint32_t width, const uint32_t height, const uint32_t firstBlockRow, const uint32_t lastBlockRow, uint8_t* output) const;
+
+		// 16 RGBA8 texels in row major order
+		void CompressBlock(const uint8_t* texels, uint8_t* outBlock) const;
+
+	private:
+		const BlockFormat format;
+	};
+}
+
+#endif // !BAAL_BLOCK_COMPRESSION_H
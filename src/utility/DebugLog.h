@@ -7,6 +7,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 namespace Baal
 {
@@ -91,9 +92,6 @@ namespace Baal
 			const int line,
 			Args&& ... args )
 		{
-			std::ofstream outputFile;
-			outputFile.open( outputLogFileName, std::ios::app | std::ios::out );
-
 			/*[05/15/22|21:33:51][INFO]:	FunctionName(00):	Message {}*/
 			std::string output;
 			output.append( BuildTimeStamp() );
@@ -105,7 +103,13 @@ namespace Baal
 			output.append( message );
 			output.append( "\n" );
 
-			outputFile << std::vformat( output, std::make_format_args( std::forward<Args>( args )... ) );
+			const std::string formatted = std::vformat( output, std::make_format_args( std::forward<Args>( args )... ) );
+
+			// Jobs log from worker threads, one line at a time
+			std::lock_guard<std::mutex> lock( logMutex );
+			std::ofstream outputFile;
+			outputFile.open( outputLogFileName, std::ios::app | std::ios::out );
+			outputFile << formatted;
 
 			outputFile.flush();
 			outputFile.close();
@@ -131,11 +135,15 @@ namespace Baal
 			output.append( message );
 			output.append( "\n" );
 
-			std::cout << std::vformat( output, std::make_format_args( std::forward<Args>( args )... ) );
+			const std::string formatted = std::vformat( output, std::make_format_args( std::forward<Args>( args )... ) );
+
+			std::lock_guard<std::mutex> lock( logMutex );
+			std::cout << formatted;
 		};
 
 	private:
 		inline static std::string outputLogFileName = "Output-Log.txt";
+		inline static std::mutex logMutex;
 
 		/* Returns a string in the format: [05/15/22|21:33:51]*/
 		static std::string BuildTimeStamp()
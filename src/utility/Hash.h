@@ -0,0 +1,34 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_HASH_H
+#define BAAL_HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace Baal
+{
+	constexpr uint64_t FNV1A_64_OFFSET_BASIS = 14695981039346656037ull;
+	constexpr uint64_t FNV1A_64_PRIME = 1099511628211ull;
+
+	// 64-bit FNV-1a, pass a previous result as the seed to hash several pieces of data together
+	// Stable across platforms and runs, so it is safe to use for on-disk cache keys
+	inline uint64_t HashFNV1a(const void* data, const size_t size, uint64_t seed = FNV1A_64_OFFSET_BASIS)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			seed ^= bytes[i];
+			seed *= FNV1A_64_PRIME;
+		}
+		return seed;
+	}
+
+	inline uint64_t HashFNV1a(const std::string& string, uint64_t seed = FNV1A_64_OFFSET_BASIS)
+	{
+		return HashFNV1a(string.data(), string.size(), seed);
+	}
+}
+
+#endif // !BAAL_HASH_H
@@ -0,0 +1,109 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // !NOMINMAX
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // !WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace Baal
+{
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::string& filePath)
+	{
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+		fileHandle = file;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			return;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			return;
+		}
+		mappingHandle = mapping;
+
+		data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		size = data != nullptr ? static_cast<size_t>(fileSize.QuadPart) : 0;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data != nullptr)
+		{
+			UnmapViewOfFile(data);
+		}
+		if (mappingHandle != nullptr)
+		{
+			CloseHandle(mappingHandle);
+		}
+		if (fileHandle != nullptr)
+		{
+			CloseHandle(fileHandle);
+		}
+	}
+#else
+	MappedFile::MappedFile(const std::string& filePath)
+	{
+		const int file = open(filePath.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			return;
+		}
+
+		struct stat fileStat{};
+		if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+		{
+			void* mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			if (mapping != MAP_FAILED)
+			{
+				// The file is read front to back exactly once, let the OS read ahead aggressively
+				madvise(mapping, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+				data = static_cast<const uint8_t*>(mapping);
+				size = static_cast<size_t>(fileStat.st_size);
+			}
+		}
+
+		// The mapping keeps the file alive on its own
+		close(file);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data != nullptr)
+		{
+			munmap(const_cast<uint8_t*>(data), size);
+		}
+	}
+#endif // _WIN32
+
+	void MappedFile::Prefetch() const
+	{
+		constexpr size_t PREFETCH_STRIDE = 4096;	// Smallest page size in use, touching a larger page more than once is harmless
+
+		volatile uint8_t sink = 0;
+		for (size_t offset = 0; offset < size; offset += PREFETCH_STRIDE)
+		{
+			sink = sink + data[offset];
+		}
+	}
+}
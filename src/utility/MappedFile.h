@@ -0,0 +1,45 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_MAPPED_FILE_H
+#define BAAL_MAPPED_FILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace Baal
+{
+	// Read only memory mapping of a whole file
+	// Pages are faulted in by the OS as they are touched, so reading a mapped file costs no more than the I/O and skips the copy into a heap buffer
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(const std::string& filePath);
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&&) = delete;
+
+		~MappedFile();
+
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator = (MappedFile&&) = delete;
+
+		// False when the file is missing, empty or could not be mapped
+		bool IsValid() const { return data != nullptr; }
+
+		// Touches every page on the calling thread, so later reads of the mapping never wait on the disk
+		void Prefetch() const;
+
+		const uint8_t* GetData() const { return data; }
+		size_t GetSize() const { return size; }
+
+	private:
+		const uint8_t* data{ nullptr };
+		size_t size = 0;
+#ifdef _WIN32
+		void* fileHandle{ nullptr };
+		void* mappingHandle{ nullptr };
+#endif // _WIN32
+	};
+}
+
+#endif // !BAAL_MAPPED_FILE_H
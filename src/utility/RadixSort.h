@@ -0,0 +1,86 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_RADIX_SORT_H
+#define BAAL_RADIX_SORT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace Baal
+{
+	// Stable least significant digit radix sort of 64-bit keys, carrying a 32-bit value along with each key
+	// Every histogram is built in a single read of the keys, and digits that are the same for every key are skipped,
+	// so keys with unused high bits, or a field that never changes, cost nothing to sort by
+	// The scratch vectors are resized to fit and can be kept between calls to avoid reallocating
+	inline void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, std::vector<uint64_t>& scratchKeys, std::vector<uint32_t>& scratchValues)
+	{
+		constexpr size_t DIGIT_BITS = 8;
+		constexpr size_t DIGIT_COUNT = sizeof(uint64_t) * 8 / DIGIT_BITS;
+		constexpr size_t BUCKET_COUNT = size_t(1) << DIGIT_BITS;
+
+		const size_t count = keys.size();
+		if (count < 2)
+		{
+			return;
+		}
+
+		scratchKeys.resize(count);
+		scratchValues.resize(count);
+
+		uint32_t histograms[DIGIT_COUNT][BUCKET_COUNT];
+		std::memset(histograms, 0, sizeof(histograms));
+		for (const uint64_t key : keys)
+		{
+			for (size_t digit = 0; digit < DIGIT_COUNT; ++digit)
+			{
+				++histograms[digit][(key >> (digit * DIGIT_BITS)) & (BUCKET_COUNT - 1)];
+			}
+		}
+
+		uint64_t* sourceKeys = keys.data();
+		uint32_t* sourceValues = values.data();
+		uint64_t* destinationKeys = scratchKeys.data();
+		uint32_t* destinationValues = scratchValues.data();
+
+		for (size_t digit = 0; digit < DIGIT_COUNT; ++digit)
+		{
+			uint32_t* histogram = histograms[digit];
+			const size_t shift = digit * DIGIT_BITS;
+			if (histogram[(sourceKeys[0] >> shift) & (BUCKET_COUNT - 1)] == count)
+			{
+				continue;
+			}
+
+			// Exclusive prefix sum, each bucket becomes the position of its first key
+			uint32_t offset = 0;
+			for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+			{
+				const uint32_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const uint32_t position = histogram[(sourceKeys[i] >> shift) & (BUCKET_COUNT - 1)]++;
+				destinationKeys[position] = sourceKeys[i];
+				destinationValues[position] = sourceValues[i];
+			}
+
+			std::swap(sourceKeys, destinationKeys);
+			std::swap(sourceValues, destinationValues);
+		}
+
+		// An odd number of passes leaves the result in the scratch buffers
+		if (sourceKeys != keys.data())
+		{
+			keys.swap(scratchKeys);
+			values.swap(scratchValues);
+		}
+	}
+}
+
+#endif // !BAAL_RADIX_SORT_H
@@ -0,0 +1,50 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_SLOT_ALLOCATOR_H
+#define BAAL_SLOT_ALLOCATOR_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Baal
+{
+	// Hands out indices into a fixed size table, freed indices are handed out again before new ones
+	class SlotAllocator
+	{
+	public:
+		static constexpr uint32_t INVALID_SLOT = std::numeric_limits<uint32_t>::max();
+
+		explicit SlotAllocator(const uint32_t _capacity) : capacity(_capacity) {}
+
+		// INVALID_SLOT when every slot is in use
+		uint32_t Allocate()
+		{
+			if (!freeSlots.empty())
+			{
+				const uint32_t slot = freeSlots.back();
+				freeSlots.pop_back();
+				return slot;
+			}
+			return nextSlot < capacity ? nextSlot++ : INVALID_SLOT;
+		}
+
+		void Free(const uint32_t slot)
+		{
+			if (slot < nextSlot)
+			{
+				freeSlots.push_back(slot);
+			}
+		}
+
+		uint32_t GetCapacity() const { return capacity; }
+		uint32_t GetAllocatedCount() const { return nextSlot - static_cast<uint32_t>(freeSlots.size()); }
+
+	private:
+		const uint32_t capacity;
+		uint32_t nextSlot = 0;
+		std::vector<uint32_t> freeSlots;
+	};
+}
+
+#endif // !BAAL_SLOT_ALLOCATOR_H
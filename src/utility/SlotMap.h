@@ -0,0 +1,142 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+#ifndef BAAL_SLOT_MAP_H
+#define BAAL_SLOT_MAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Baal
+{
+	// Index into a SlotMap's slots, plus the generation of the slot when the handle was issued
+	// A handle goes stale once its value is removed, even if the slot is later reused
+	template<typename T>
+	struct Handle
+	{
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+		uint32_t index = INVALID_INDEX;
+		uint32_t generation = 0;
+
+		bool IsNull() const { return index == INVALID_INDEX; }
+		bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Handle& other) const { return !(*this == other); }
+	};
+
+	// Values are stored densely and removed by swapping with the last value, so iterating them is a linear walk over one array
+	// Handles go through a slot table to find their value, which keeps them stable while values move around
+	// Lookups, inserts and removes are O(1) and never touch an atomic reference count
+	// Tag is the handle type, so a SlotMap<std::unique_ptr<X>, X> hands out Handle<X>
+	template<typename T, typename Tag = T>
+	class SlotMap
+	{
+		struct Slot
+		{
+			uint32_t denseIndex = 0;
+			uint32_t generation = 1;	// Starts at 1 so a default constructed Handle never validates
+		};
+
+		std::vector<T> values;
+		std::vector<uint32_t> valueSlots;	// Slot of each dense value, to fix up the slot table when a value moves
+		std::vector<Slot> slots;
+		std::vector<uint32_t> freeSlots;
+
+	public:
+		Handle<Tag> Insert(T value)
+		{
+			uint32_t slotIndex;
+			if (!freeSlots.empty())
+			{
+				slotIndex = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else
+			{
+				slotIndex = static_cast<uint32_t>(slots.size());
+				slots.push_back(Slot());
+			}
+
+			Slot& slot = slots[slotIndex];
+			slot.denseIndex = static_cast<uint32_t>(values.size());
+			values.push_back(std::move(value));
+			valueSlots.push_back(slotIndex);
+
+			Handle<Tag> handle;
+			handle.index = slotIndex;
+			handle.generation = slot.generation;
+			return handle;
+		}
+
+		// Returns false if the handle is stale
+		bool Remove(const Handle<Tag> handle)
+		{
+			if (!Contains(handle))
+			{
+				return false;
+			}
+
+			Slot& slot = slots[handle.index];
+			const uint32_t lastIndex = static_cast<uint32_t>(values.size() - 1);
+			if (slot.denseIndex != lastIndex)
+			{
+				values[slot.denseIndex] = std::move(values[lastIndex]);
+				valueSlots[slot.denseIndex] = valueSlots[lastIndex];
+				slots[valueSlots[slot.denseIndex]].denseIndex = slot.denseIndex;
+			}
+			values.pop_back();
+			valueSlots.pop_back();
+
+			++slot.generation;
+			freeSlots.push_back(handle.index);
+			return true;
+		}
+
+		bool Contains(const Handle<Tag> handle) const
+		{
+			return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+		}
+
+		// nullptr if the handle is stale, the pointer is invalidated by the next Insert() or Remove()
+		T* Get(const Handle<Tag> handle) { return Contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr; }
+		const T* Get(const Handle<Tag> handle) const { return Contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr; }
+
+		// Position of the value in GetValues(), only valid until the next Remove()
+		uint32_t GetDenseIndex(const Handle<Tag> handle) const { return slots[handle.index].denseIndex; }
+
+		Handle<Tag> GetHandle(const uint32_t denseIndex) const
+		{
+			Handle<Tag> handle;
+			handle.index = valueSlots[denseIndex];
+			handle.generation = slots[handle.index].generation;
+			return handle;
+		}
+
+		void Reserve(const size_t capacity)
+		{
+			values.reserve(capacity);
+			valueSlots.reserve(capacity);
+			slots.reserve(capacity);
+		}
+
+		void Clear()
+		{
+			for (const uint32_t slotIndex : valueSlots)
+			{
+				++slots[slotIndex].generation;
+				freeSlots.push_back(slotIndex);
+			}
+			values.clear();
+			valueSlots.clear();
+		}
+
+		std::vector<T>& GetValues() { return values; }
+		const std::vector<T>& GetValues() const { return values; }
+		size_t Size() const { return values.size(); }
+		bool IsEmpty() const { return values.empty(); }
+	};
+}
+
+#endif // !BAAL_SLOT_MAP_H
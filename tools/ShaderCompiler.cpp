@@ -0,0 +1,82 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+// Offline shader precompiler, fills the SPIR-V cache so the first run of Baal skips glslang entirely
+// Usage: BaalShaderCompiler <shaderDirectory> <cacheDirectory>
+
+#include "../src/core/vulkan/utility/GLSLCompiler.h"
+#include "../src/core/vulkan/utility/ShaderCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace Baal::VK;
+
+namespace
+{
+	bool TryGetStage(const std::filesystem::path& path, VkShaderStageFlagBits& outStage)
+	{
+		const std::string extension = path.extension().string();
+		if (extension == ".vert") { outStage = VK_SHADER_STAGE_VERTEX_BIT; return true; }
+		if (extension == ".frag") { outStage = VK_SHADER_STAGE_FRAGMENT_BIT; return true; }
+		if (extension == ".comp") { outStage = VK_SHADER_STAGE_COMPUTE_BIT; return true; }
+		if (extension == ".geom") { outStage = VK_SHADER_STAGE_GEOMETRY_BIT; return true; }
+		if (extension == ".tesc") { outStage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT; return true; }
+		if (extension == ".tese") { outStage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT; return true; }
+		return false;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::printf("Usage: BaalShaderCompiler <shaderDirectory> <cacheDirectory>\n");
+		return 1;
+	}
+
+	const ShaderCache shaderCache(argv[2]);
+
+	uint32_t compiledCount = 0;
+	uint32_t cachedCount = 0;
+	uint32_t failedCount = 0;
+
+	for (const auto& entry : std::filesystem::directory_iterator(argv[1]))
+	{
+		VkShaderStageFlagBits stage;
+		if (!entry.is_regular_file() || !TryGetStage(entry.path(), stage))
+		{
+			continue;
+		}
+
+		std::ifstream file(entry.path(), std::ios::binary);
+		const std::vector<char> sourceCode((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		const ShaderCacheKey cacheKey = ShaderCacheKey::Create(stage, sourceCode, "main");
+
+		std::vector<uint32_t> spirv;
+		if (shaderCache.TryLoad(cacheKey, spirv))
+		{
+			++cachedCount;
+			continue;
+		}
+
+		GLSLCompiler glslCompiler;
+		std::string log;
+		if (!glslCompiler.CompileToSPIRV(stage, sourceCode, cacheKey.entryPoint, spirv, log) || !shaderCache.Store(cacheKey, spirv))
+		{
+			std::printf("Failed to compile %s\n%s\n", entry.path().filename().string().c_str(), log.c_str());
+			++failedCount;
+			continue;
+		}
+
+		std::printf("Compiled %s -> %s\n", entry.path().filename().string().c_str(), cacheKey.GetFileName().c_str());
+		++compiledCount;
+	}
+
+	std::printf("Shader cache: %u compiled, %u up to date, %u failed (%s)\n", compiledCount, cachedCount, failedCount, GLSLCompiler::GetVersion().c_str());
+	return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+// MIT License, Copyright (c) 2024 Malik Allen
+
+// Offline texture compressor, encodes images into block compressed KTX2 files with a full mip chain
+// Baal loads them straight into VRAM instead of decoding the source and storing 4 bytes per texel
+//
+// Usage: BaalTextureCompressor <textureDirectory> <cacheDirectory>
+//        BaalTextureCompressor <input> <output.ktx2> [bc1|bc3|bc5|bc7] [--linear]
+//
+// A directory is compressed into the texture cache Baal looks in, see TextureFile::GetCacheFileName(). Color textures become sRGB BC7,
+// textures whose name ends in _normal or _n become BC5 with the X and Y of the normal. Files that are up to date are skipped
+
+#include "../src/core/3d/TextureFile.h"
+#include "../src/core/jobs/JobSystem.h"
+#include "../src/utility/BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../src/utility/stb/stb_image.h"
+
+using namespace Baal;
+using namespace Baal::VK;
+
+namespace
+{
+	constexpr uint32_t MIN_BLOCK_ROWS_PER_JOB = 4;
+
+	struct Encoding
+	{
+		BlockFormat blockFormat;
+		VkFormat format;
+		bool bSRGB;
+	};
+
+	bool TryGetEncoding(const std::string& name, const bool bLinear, Encoding& outEncoding)
+	{
+		if (name == "bc1") { outEncoding = { BlockFormat::BC1, bLinear ? VK_FORMAT_BC1_RGB_UNORM_BLOCK : VK_FORMAT_BC1_RGB_SRGB_BLOCK, !bLinear }; return true; }
+		if (name == "bc3") { outEncoding = { BlockFormat::BC3, bLinear ? VK_FORMAT_BC3_UNORM_BLOCK : VK_FORMAT_BC3_SRGB_BLOCK, !bLinear }; return true; }
+		if (name == "bc5") { outEncoding = { BlockFormat::BC5, VK_FORMAT_BC5_UNORM_BLOCK, false }; return true; }
+		if (name == "bc7") { outEncoding = { BlockFormat::BC7, bLinear ? VK_FORMAT_BC7_UNORM_BLOCK : VK_FORMAT_BC7_SRGB_BLOCK, !bLinear }; return true; }
+		return false;
+	}
+
+	bool IsImage(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+	}
+
+	bool IsNormalMap(const std::filesystem::path& path)
+	{
+		const std::string stem = path.stem().string();
+		const auto EndsWith = [&stem](const std::string& suffix) { return stem.size() >= suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0; };
+		return EndsWith("_normal") || EndsWith("_n");
+	}
+
+	float SRGBToLinear(const float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSRGB(const float value)
+	{
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	// 2x2 box filter, averaged in linear space for sRGB color so darker texels are not over weighted. Alpha is always linear
+	std::vector<uint8_t> Downsample(const std::vector<uint8_t>& rgba, const uint32_t width, const uint32_t height, const bool bSRGB)
+	{
+		static const std::vector<float> srgbToLinear = []()
+		{
+			std::vector<float> table(256);
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				table[i] = SRGBToLinear(static_cast<float>(i) / 255.0f);
+			}
+			return table;
+		}();
+
+		const uint32_t nextWidth = std::max(width / 2, 1u);
+		const uint32_t nextHeight = std::max(height / 2, 1u);
+		std::vector<uint8_t> next(static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+		for (uint32_t y = 0; y < nextHeight; ++y)
+		{
+			const uint32_t y0 = std::min(y * 2, height - 1);
+			const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+			for (uint32_t x = 0; x < nextWidth; ++x)
+			{
+				const uint32_t x0 = std::min(x * 2, width - 1);
+				const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+				const uint8_t* texels[4] = {
+					&rgba[(static_cast<size_t>(y0) * width + x0) * 4],
+					&rgba[(static_cast<size_t>(y0) * width + x1) * 4],
+					&rgba[(static_cast<size_t>(y1) * width + x0) * 4],
+					&rgba[(static_cast<size_t>(y1) * width + x1) * 4] };
+
+				uint8_t* out = &next[(static_cast<size_t>(y) * nextWidth + x) * 4];
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					float sum = 0.0f;
+					for (const uint8_t* texel : texels)
+					{
+						sum += bSRGB && c < 3 ? srgbToLinear[texel[c]] : static_cast<float>(texel[c]) / 255.0f;
+					}
+
+					const float average = sum / 4.0f;
+					const float value = bSRGB && c < 3 ? LinearToSRGB(average) : average;
+					out[c] = static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+				}
+			}
+		}
+		return next;
+	}
+
+	bool Compress(JobSystem& jobSystem, const std::filesystem::path& inputPath, const std::filesystem::path& outputPath, const Encoding& encoding)
+	{
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		stbi_uc* pixels = stbi_load(inputPath.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		if (pixels == nullptr)
+		{
+			std::printf("Failed to load %s: %s\n", inputPath.string().c_str(), stbi_failure_reason());
+			return false;
+		}
+
+		std::vector<uint8_t> level(pixels, pixels + static_cast<size_t>(width) * height * 4);
+		stbi_image_free(pixels);
+
+		const BlockCompressor compressor(encoding.blockFormat);
+		std::vector<std::vector<uint8_t>> levels;
+
+		uint32_t levelWidth = static_cast<uint32_t>(width);
+		uint32_t levelHeight = static_cast<uint32_t>(height);
+		while (true)
+		{
+			std::vector<uint8_t> compressed(compressor.GetCompressedSize(levelWidth, levelHeight));
+			const uint32_t blockRows = (levelHeight + BlockCompressor::BLOCK_DIMENSION - 1) / BlockCompressor::BLOCK_DIMENSION;
+			jobSystem.ParallelFor(blockRows, MIN_BLOCK_ROWS_PER_JOB, [&](const uint32_t begin, const uint32_t end)
+			{
+				compressor.CompressBlockRows(level.data(), levelWidth, levelHeight, begin, end, compressed.data());
+			});
+			levels.push_back(std::move(compressed));
+
+			if (levelWidth == 1 && levelHeight == 1)
+			{
+				break;
+			}
+
+			level = Downsample(level, levelWidth, levelHeight, encoding.bSRGB);
+			levelWidth = std::max(levelWidth / 2, 1u);
+			levelHeight = std::max(levelHeight / 2, 1u);
+		}
+
+		if (!TextureFile::WriteKTX2(outputPath.string(), encoding.format, static_cast<uint32_t>(width), static_cast<uint32_t>(height), levels, inputPath.string()))
+		{
+			std::printf("Failed to write %s\n", outputPath.string().c_str());
+			return false;
+		}
+
+		uint64_t compressedSize = 0;
+		for (const std::vector<uint8_t>& compressedLevel : levels)
+		{
+			compressedSize += compressedLevel.size();
+		}
+
+		std::printf("Compressed %s -> %s | [%dx%d] %u mip level(s), %llu KB\n",
+			inputPath.filename().string().c_str(),
+			outputPath.filename().string().c_str(),
+			width,
+			height,
+			static_cast<uint32_t>(levels.size()),
+			static_cast<unsigned long long>(compressedSize / 1024));
+		return true;
+	}
+
+	bool IsUpToDate(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath)
+	{
+		std::error_code outputError;
+		std::error_code inputError;
+		const auto outputTime = std::filesystem::last_write_time(outputPath, outputError);
+		const auto inputTime = std::filesystem::last_write_time(inputPath, inputError);
+		return !outputError && !inputError && outputTime >= inputTime;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::printf("Usage: BaalTextureCompressor <textureDirectory> <cacheDirectory>\n");
+		std::printf("       BaalTextureCompressor <input> <output.ktx2> [bc1|bc3|bc5|bc7] [--linear]\n");
+		return 1;
+	}
+
+	JobSystem jobSystem;
+
+	const std::filesystem::path inputPath = argv[1];
+	if (!std::filesystem::is_directory(inputPath))
+	{
+		const bool bLinear = argc > 4 && std::strcmp(argv[4], "--linear") == 0;
+		Encoding encoding;
+		if (!TryGetEncoding(argc > 3 ? argv[3] : "bc7", bLinear, encoding))
+		{
+			std::printf("Unknown format %s, expected bc1, bc3, bc5 or bc7\n", argv[3]);
+			return 1;
+		}
+		return Compress(jobSystem, inputPath, argv[2], encoding) ? 0 : 1;
+	}
+
+	uint32_t compressedCount = 0;
+	uint32_t upToDateCount = 0;
+	uint32_t failedCount = 0;
+
+	for (const auto& entry : std::filesystem::directory_iterator(inputPath))
+	{
+		if (!entry.is_regular_file() || !IsImage(entry.path()))
+		{
+			continue;
+		}
+
+		const std::filesystem::path cachePath = std::filesystem::path(argv[2]) / TextureFile::GetCacheFileName(entry.path().string());
+		if (IsUpToDate(entry.path(), cachePath))
+		{
+			++upToDateCount;
+			continue;
+		}
+
+		Encoding encoding;
+		TryGetEncoding(IsNormalMap(entry.path()) ? "bc5" : "bc7", false, encoding);
+		if (Compress(jobSystem, entry.path(), cachePath, encoding))
+		{
+			++compressedCount;
+		}
+		else
+		{
+			++failedCount;
+		}
+	}
+
+	std::printf("Texture cache: %u compressed, %u up to date, %u failed\n", compressedCount, upToDateCount, failedCount);
+	return failedCount == 0 ? 0 : 1;
+}